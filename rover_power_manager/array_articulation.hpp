@@ -0,0 +1,201 @@
+#ifndef ARRAY_ARTICULATION_HPP
+#define ARRAY_ARTICULATION_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "mars_time.hpp"
+#include "solar_forecast.hpp"
+#include "thread_pool.hpp"
+
+namespace rover_energy {
+
+// Skrzydła obracane wokół osi północ-południe; kąt > 0 to pochylenie na wschód.
+struct ArrayConfig {
+    double area_m2 = 2.0;
+    double efficiency = 0.25;
+    double max_tilt_deg = 45.0;
+    double tilt_step_deg = 5.0;
+    double actuator_energy_j_per_deg = 5.0;
+    double optical_depth = 0.5;
+    size_t slots_per_day = 12;
+    size_t samples_per_slot = 10;
+};
+
+struct TiltSchedule {
+    double sunrise_ltst_hours = 12.0;
+    double slot_hours = 0.0;
+    std::vector<float> tilt_deg;    // kąt na slot, w nocy skrzydła płasko
+    double net_energy_wh = 0.0;
+    double flat_energy_wh = 0.0;
+    double actuator_energy_wh = 0.0;
+
+    float setpointAt(double ltst_hours) const {
+        if (tilt_deg.empty() || slot_hours <= 0.0 || ltst_hours < sunrise_ltst_hours) {
+            return 0.0f;
+        }
+        size_t slot = static_cast<size_t>((ltst_hours - sunrise_ltst_hours) / slot_hours);
+        return slot < tilt_deg.size() ? tilt_deg[slot] : 0.0f;
+    }
+};
+
+class ArrayArticulationOptimizer {
+public:
+    ArrayArticulationOptimizer(const ArrayConfig& config, ThreadPool& pool)
+        : config_(config), pool_(pool) {}
+
+    // Kandydat = (liczba ruchów w ciągu dnia, kwant kąta); każdy liczony równolegle,
+    // wygrywa najwyższa energia netto po odjęciu energii napędu.
+    TiltSchedule optimize(double latitude_deg, const MarsTime& mars_time) {
+        SolarDay day = solarDay(latitude_deg, mars_time.declination_deg);
+        TiltSchedule best;
+        best.sunrise_ltst_hours = day.sunrise_ltst_hours;
+        if (day.daylight_fraction <= 0.0) {
+            return best;
+        }
+
+        size_t slots = std::max<size_t>(1, config_.slots_per_day);
+        size_t samples = std::max<size_t>(1, config_.samples_per_slot);
+        best.slot_hours = (day.sunset_ltst_hours - day.sunrise_ltst_hours) / slots;
+        sample_hours_ = best.slot_hours / samples;
+        precomputeIrradiance(latitude_deg, mars_time, day.sunrise_ltst_hours, slots * samples);
+        precomputeSlotEnergy(slots, samples);
+
+        candidates_.clear();
+        for (double quantum : {config_.tilt_step_deg, 2.0 * config_.tilt_step_deg, 3.0 * config_.tilt_step_deg}) {
+            for (size_t moves = 0; moves < slots; ++moves) {
+                candidates_.push_back({moves, quantum, {}, 0.0, 0.0});
+            }
+        }
+        pool_.parallelFor(candidates_.size(), [this, slots](size_t i) {
+            evaluateCandidate(candidates_[i], slots);
+        });
+
+        const Candidate* winner = &candidates_.front();
+        for (const auto& candidate : candidates_) {
+            if (candidate.net_energy_wh > winner->net_energy_wh) {
+                winner = &candidate;
+            }
+        }
+        best.tilt_deg = winner->tilt_deg;
+        best.net_energy_wh = winner->net_energy_wh;
+        best.actuator_energy_wh = winner->actuator_energy_wh;
+        best.flat_energy_wh = 0.0;
+        for (size_t s = 0; s < slots; ++s) {
+            best.flat_energy_wh += slotEnergyWh(s, tiltIndex(0.0));
+        }
+        return best;
+    }
+
+private:
+    struct Candidate {
+        size_t moves;
+        double quantum_deg;
+        std::vector<float> tilt_deg;
+        double net_energy_wh;
+        double actuator_energy_wh;
+    };
+
+    void precomputeIrradiance(double latitude_deg, const MarsTime& mars_time,
+                              double start_hours, size_t n) {
+        east_.resize(n);
+        north_.resize(n);
+        up_.resize(n);
+        SolarGeometryBatch geometry(latitude_deg, mars_time.declination_deg);
+        geometry.sunVectors(start_hours + 0.5 * sample_hours_, sample_hours_, n,
+                            east_.data(), north_.data(), up_.data());
+
+        double toa = topOfAtmosphereIrradiance(mars_time.heliocentric_au);
+        beam_.resize(n);
+        diffuse_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            SurfaceIrradiance irradiance = surfaceIrradiance(toa, up_[i], config_.optical_depth);
+            beam_[i] = static_cast<float>(irradiance.beam);
+            diffuse_[i] = static_cast<float>(irradiance.diffuse);
+        }
+    }
+
+    void precomputeSlotEnergy(size_t slots, size_t samples) {
+        tilt_count_ = static_cast<size_t>(2.0 * config_.max_tilt_deg / config_.tilt_step_deg) + 1;
+        slot_energy_.assign(slots * tilt_count_, 0.0);
+        double scale = config_.area_m2 * config_.efficiency * sample_hours_;
+        for (size_t k = 0; k < tilt_count_; ++k) {
+            double tilt = (-config_.max_tilt_deg + k * config_.tilt_step_deg) * kDegToRad;
+            double sin_t = std::sin(tilt);
+            double cos_t = std::cos(tilt);
+            double sky_view = 0.5 * (1.0 + cos_t);
+            for (size_t s = 0; s < slots; ++s) {
+                double energy = 0.0;
+                for (size_t j = s * samples; j < (s + 1) * samples; ++j) {
+                    double cos_incidence = std::max(0.0, east_[j] * sin_t + up_[j] * cos_t);
+                    energy += beam_[j] * cos_incidence + diffuse_[j] * sky_view;
+                }
+                slot_energy_[s * tilt_count_ + k] = energy * scale;
+            }
+        }
+    }
+
+    size_t tiltIndex(double tilt_deg) const {
+        double index = (tilt_deg + config_.max_tilt_deg) / config_.tilt_step_deg;
+        return std::min(tilt_count_ - 1, static_cast<size_t>(std::lround(std::max(0.0, index))));
+    }
+
+    double slotEnergyWh(size_t slot, size_t tilt_index) const {
+        return slot_energy_[slot * tilt_count_ + tilt_index];
+    }
+
+    void evaluateCandidate(Candidate& candidate, size_t slots) const {
+        candidate.tilt_deg.assign(slots, 0.0f);
+        size_t groups = candidate.moves + 1;
+        size_t quantum_steps = std::max<size_t>(1, static_cast<size_t>(
+            std::lround(candidate.quantum_deg / config_.tilt_step_deg)));
+        double energy = 0.0;
+        for (size_t g = 0; g < groups && g < slots; ++g) {
+            size_t begin = g * slots / groups;
+            size_t end = (g + 1) * slots / groups;
+            size_t best_k = tiltIndex(0.0);
+            double best_energy = -1.0;
+            for (size_t k = best_k % quantum_steps; k < tilt_count_; k += quantum_steps) {
+                double group_energy = 0.0;
+                for (size_t s = begin; s < end; ++s) {
+                    group_energy += slotEnergyWh(s, k);
+                }
+                if (group_energy > best_energy) {
+                    best_energy = group_energy;
+                    best_k = k;
+                }
+            }
+            float tilt = static_cast<float>(-config_.max_tilt_deg + best_k * config_.tilt_step_deg);
+            for (size_t s = begin; s < end; ++s) {
+                candidate.tilt_deg[s] = tilt;
+            }
+            energy += best_energy;
+        }
+
+        // Ruchy: z pozycji płaskiej rano, między slotami i powrót na noc
+        double travel_deg = 0.0;
+        float previous = 0.0f;
+        for (float tilt : candidate.tilt_deg) {
+            travel_deg += std::abs(tilt - previous);
+            previous = tilt;
+        }
+        travel_deg += std::abs(previous);
+        candidate.actuator_energy_wh = travel_deg * config_.actuator_energy_j_per_deg / 3600.0;
+        candidate.net_energy_wh = energy - candidate.actuator_energy_wh;
+    }
+
+    ArrayConfig config_;
+    ThreadPool& pool_;
+    double sample_hours_ = 0.0;
+    size_t tilt_count_ = 1;
+    std::vector<float> east_, north_, up_;
+    std::vector<float> beam_, diffuse_;
+    std::vector<double> slot_energy_;
+    std::vector<Candidate> candidates_;
+};
+
+}
+
+#endif // ARRAY_ARTICULATION_HPP
@@ -0,0 +1,543 @@
+#ifndef BATCH_SIMULATOR_HPP
+#define BATCH_SIMULATOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "energy_core.hpp"
+#include "thread_pool.hpp"
+
+namespace rover_energy {
+
+// Widok scenariusza na cudze bufory (np. tablice NumPy) bez kopiowania.
+struct ScenarioView {
+    const float* solar_w;
+    const float* extra_load_w;          // nullptr = brak
+    size_t steps;
+    float initial_soc;
+    float step_s;
+};
+
+// Scenariusz bez ROS: generacja i obciążenie dodatkowe na krok.
+struct Scenario {
+    std::vector<float> solar_w;
+    std::vector<float> extra_load_w;    // puste = brak
+    float initial_soc = 80.0f;
+    float step_s = 10.0f;
+
+    ScenarioView view() const {
+        return {solar_w.data(), extra_load_w.size() >= solar_w.size() ? extra_load_w.data() : nullptr,
+                solar_w.size(), initial_soc, step_s};
+    }
+};
+
+// Polityka = progi trybów + kolejność przydziału (kto jest głodzony pierwszy).
+struct PolicyParameters {
+    ModeThresholds thresholds;
+    std::array<uint8_t, kMaxComponents> allocation_order{};
+    bool custom_order = false;
+};
+
+struct SimulationMetrics {
+    float min_soc;
+    float final_soc;
+    float science_hours;    // czas w ACTIVE komponentu naukowego
+    float emergency_hours;
+    uint32_t transitions;
+};
+
+// Ślad przebiegu zapisywany co krok; nullptr pomija dany bufor.
+struct TraceBuffers {
+    float* soc = nullptr;
+    float* consumption = nullptr;
+    uint8_t* mode = nullptr;
+    float* grants = nullptr;        // [krok][komponent], component_count na krok
+};
+
+// Układ pamięci wsadu: PER_ROVER to osobny CoreState na łazik (stepCore), LANES to
+// blok kLaneWidth łazików w SoA [komponent][łazik], w którym każda linia SIMD to inny łazik.
+enum class BatchLayout {
+    PER_ROVER,
+    LANES
+};
+
+static constexpr size_t kLaneWidth = 16;
+
+// Blok łazików o wspólnej tabeli komponentów, kolejności przydziału, kroku i długości
+// scenariusza. Krok odtwarza stepCore() bez planu MPC (stan burzy pyłowej i jej budżet
+// są wspólne dla bloku); rozgałęzienia zastąpione są wyborami na liniach, żeby pętle
+// po łazikach wektoryzowały się bez maskowania.
+template <size_t L>
+class LaneBlock {
+public:
+    LaneBlock(const CoreState& initial, const uint8_t* allocation_order)
+        : count_(initial.component_count),
+          dust_storm_(initial.mode.dust_storm),
+          storm_budget_w_(initial.mode.flexible_budget_w) {
+        for (size_t c = 0; c < count_; ++c) {
+            const CoreComponent& comp = initial.components[c];
+            order_[c] = allocation_order[c];
+            nominal_[c] = comp.nominal_power;
+            boot_time_[c] = comp.transition.boot_time_s;
+            boot_power_[c] = comp.nominal_power * comp.transition.boot_power_factor;
+            warm_power_[c] = comp.transition.warm_power;
+            warmup_time_[c] = comp.transition.warmup_time_s;
+            break_even_[c] = breakEvenSeconds(comp);
+            flexible_[c] = comp.priority != ComponentPriority::CRITICAL && !comp.is_essential;
+            dependency_mask_[c] = comp.dependency_mask;
+            for (size_t m = 0; m < kPowerModeCount; ++m) {
+                allowed_[m][c] = initial.mode_masks.allows(static_cast<PowerMode>(m), c);
+            }
+            for (size_t l = 0; l < L; ++l) {
+                state_[c][l] = static_cast<int32_t>(comp.power_state);
+                state_time_[c][l] = comp.state_time_s;
+                enabled_[c][l] = comp.is_enabled;
+                requested_[c][l] = comp.mode_enabled;
+                duty_[c][l] = comp.duty_cycle;
+                current_[c][l] = comp.current_power;
+            }
+        }
+        for (size_t l = 0; l < L; ++l) {
+            mode_[l] = static_cast<int32_t>(initial.mode.mode);
+            time_in_mode_[l] = initial.mode.time_in_mode_s;
+            capacity_wh_[l] = initial.battery.capacity_wh;
+        }
+    }
+
+    // Jednorazowe: stan komponentów pochodzi z konstruktora. lanes <= L; puste linie powielają linię 0, a ich wyniki są pomijane.
+    void run(const PolicyParameters* const* policies, const ScenarioView* const* scenarios, size_t lanes,
+             size_t science_index, SimulationMetrics* const* out) {
+        const ScenarioView* view[L];
+        for (size_t l = 0; l < L; ++l) {
+            size_t src = l < lanes ? l : 0;
+            view[l] = scenarios[src];
+            const ModeThresholds& t = policies[src]->thresholds;
+            emergency_soc_[l] = t.emergency_soc;
+            hibernation_solar_w_[l] = t.hibernation_solar_w;
+            hibernation_soc_[l] = t.hibernation_soc;
+            low_power_soc_[l] = t.low_power_soc;
+            low_power_balance_w_[l] = t.low_power_balance_w;
+            normal_soc_[l] = t.normal_soc;
+            normal_balance_w_[l] = t.normal_balance_w;
+            min_dwell_s_[l] = t.min_dwell_s;
+            soc_[l] = view[l]->initial_soc;
+            min_soc_[l] = soc_[l];
+            science_hours_[l] = 0.0f;
+            emergency_hours_[l] = 0.0f;
+            transitions_[l] = 0;
+        }
+
+        float dt = view[0]->step_s;
+        float hours = dt / 3600.0f;
+        for (size_t k = 0; k < view[0]->steps; ++k) {
+            for (size_t l = 0; l < L; ++l) {
+                solar_[l] = view[l]->solar_w[k];
+                extra_[l] = view[l]->extra_load_w ? view[l]->extra_load_w[k] : 0.0f;
+            }
+            step(dt);
+            for (size_t l = 0; l < L; ++l) {
+                min_soc_[l] = std::min(min_soc_[l], soc_[l]);
+                emergency_hours_[l] += mode_[l] == kEmergency ? hours : 0.0f;
+            }
+            if (science_index < count_) {
+                for (size_t l = 0; l < L; ++l) {
+                    science_hours_[l] += state_[science_index][l] == kActive ? hours : 0.0f;
+                }
+            }
+        }
+
+        for (size_t l = 0; l < lanes; ++l) {
+            *out[l] = {min_soc_[l], soc_[l], science_hours_[l], emergency_hours_[l], transitions_[l]};
+        }
+    }
+
+private:
+    static constexpr int32_t kOff = static_cast<int32_t>(ComponentPowerState::OFF);
+    static constexpr int32_t kBooting = static_cast<int32_t>(ComponentPowerState::BOOTING);
+    static constexpr int32_t kWarm = static_cast<int32_t>(ComponentPowerState::WARM);
+    static constexpr int32_t kActive = static_cast<int32_t>(ComponentPowerState::ACTIVE);
+    static constexpr int32_t kNormal = static_cast<int32_t>(PowerMode::NORMAL);
+    static constexpr int32_t kLowPower = static_cast<int32_t>(PowerMode::LOW_POWER);
+    static constexpr int32_t kHibernation = static_cast<int32_t>(PowerMode::HIBERNATION);
+    static constexpr int32_t kEmergency = static_cast<int32_t>(PowerMode::EMERGENCY);
+    static constexpr int32_t kDustStorm = static_cast<int32_t>(PowerMode::DUST_STORM);
+
+    // Wybór bez skoku; mask to 0 albo 1.
+    static int32_t select(int32_t mask, int32_t a, int32_t b) {
+        return b ^ ((a ^ b) & -mask);
+    }
+
+    // Warunki łączone są bitowo (& |), a nie logicznie, żeby kompilator nie wstawiał skoków.
+    void step(float dt) {
+        // advancePowerStates(): rozruchy po jednym na łazik
+        int32_t boot_in_progress[L] = {};
+        int32_t allow_warm[L];
+        for (size_t c = 0; c < count_; ++c) {
+            for (size_t l = 0; l < L; ++l) {
+                boot_in_progress[l] |= state_[c][l] == kBooting;
+            }
+        }
+        for (size_t l = 0; l < L; ++l) {
+            allow_warm[l] = (mode_[l] != kEmergency) & (mode_[l] != kDustStorm);
+        }
+        for (size_t c = 0; c < count_; ++c) {
+            float boot_time = boot_time_[c];
+            float warmup_time = warmup_time_[c];
+            float break_even = break_even_[c];
+            int32_t off_target = boot_time <= 0.0f ? (warmup_time > 0.0f ? kWarm : kActive) : kBooting;
+            int32_t off_waits = off_target == kBooting;
+            int32_t warm_hold = break_even > 0.0f;
+            for (size_t l = 0; l < L; ++l) {
+                int32_t s = state_[c][l];
+                float t = state_time_[c][l] + dt;
+                int32_t from_off = select(off_waits & boot_in_progress[l], kOff, off_target);
+                int32_t from_booting = select(t >= boot_time, kWarm, kBooting);
+                int32_t from_warm = select(t >= warmup_time, kActive, kWarm);
+                int32_t enabled_next = select(s == kOff, from_off,
+                                       select(s == kBooting, from_booting,
+                                       select(s == kWarm, from_warm, kActive)));
+                int32_t active_off = select(allow_warm[l] & warm_hold, kWarm, kOff);
+                int32_t warm_off = select((allow_warm[l] ^ 1) | (t >= break_even), kOff, kWarm);
+                int32_t disabled_next = select(s == kActive, active_off, select(s == kWarm, warm_off, kOff));
+                int32_t next = select(enabled_[c][l], enabled_next, disabled_next);
+                boot_in_progress[l] |= (s == kOff) & (next == kBooting);
+                state_time_[c][l] = next != s ? 0.0f : t;
+                state_[c][l] = next;
+            }
+        }
+
+        // updatePowerConsumption(): przydział z poprzedniego kroku
+        float consumption[L] = {};
+        for (size_t c = 0; c < count_; ++c) {
+            for (size_t l = 0; l < L; ++l) {
+                consumption[l] += state_[c][l] != kOff ? current_[c][l] : 0.0f;
+            }
+        }
+
+        // selectMode() bez planu + histereza
+        int32_t changed[L];
+        int32_t from[L];
+        for (size_t l = 0; l < L; ++l) {
+            float soc = soc_[l];
+            float solar = solar_[l];
+            float balance = solar - (consumption[l] + extra_[l]);
+            int32_t emergency = soc < emergency_soc_[l];
+            int32_t hibernation = (solar < hibernation_solar_w_[l]) & (soc < hibernation_soc_[l]);
+            int32_t low_power = (soc < low_power_soc_[l]) | (balance < low_power_balance_w_[l]);
+            int32_t normal = (soc > normal_soc_[l]) & (balance > normal_balance_w_[l]);
+            int32_t target = select(emergency, kEmergency,
+                             select(dust_storm_, kDustStorm,
+                             select(hibernation, kHibernation,
+                             select(low_power, kLowPower,
+                             select(normal, kNormal, mode_[l])))));
+            float in_mode = time_in_mode_[l] + dt;
+            int32_t go = (target != mode_[l]) & ((target == kEmergency) | (in_mode >= min_dwell_s_[l]));
+            changed[l] = go;
+            from[l] = mode_[l];
+            mode_[l] = select(go, target, mode_[l]);
+            time_in_mode_[l] = go ? 0.0f : in_mode;
+            transitions_[l] += static_cast<uint32_t>(go);
+        }
+
+        // applyModeMask(): NORMAL, EMERGENCY i DUST_STORM ustawiają skład, pozostałe tylko wyłączają,
+        // chyba że linia wychodzi z EMERGENCY albo DUST_STORM
+        for (size_t c = 0; c < count_; ++c) {
+            int32_t in_normal = allowed_[kNormal][c];
+            int32_t in_low_power = allowed_[kLowPower][c];
+            int32_t in_hibernation = allowed_[kHibernation][c];
+            int32_t in_emergency = allowed_[kEmergency][c];
+            int32_t in_dust_storm = allowed_[kDustStorm][c];
+            for (size_t l = 0; l < L; ++l) {
+                int32_t m = mode_[l];
+                int32_t allowed = select(m == kNormal, in_normal,
+                                  select(m == kLowPower, in_low_power,
+                                  select(m == kHibernation, in_hibernation,
+                                  select(m == kEmergency, in_emergency, in_dust_storm))));
+                int32_t set = (m == kNormal) | (m == kEmergency) | (m == kDustStorm) |
+                              (from[l] == kEmergency) | (from[l] == kDustStorm);
+                int32_t next = select(set, allowed, requested_[c][l] & allowed);
+                requested_[c][l] = select(changed[l], next, requested_[c][l]);
+            }
+        }
+        applyDependencies(changed);
+
+        // allocateComponentPower() z budżetem elastycznym równym generacji (w burzy budżet przetrwania)
+        float available[L];
+        float flexible_budget[L];
+        for (size_t l = 0; l < L; ++l) {
+            available[l] = solar_[l];
+            flexible_budget[l] = dust_storm_ ? storm_budget_w_ : solar_[l];
+        }
+        for (size_t k = 0; k < count_; ++k) {
+            size_t c = order_[k];
+            float nominal = nominal_[c];
+            float warm_power = warm_power_[c];
+            float boot_power = boot_power_[c];
+            float cap_floor = flexible_[c] ? -INFINITY : INFINITY;
+            float charge = flexible_[c] ? 1.0f : 0.0f;
+            for (size_t l = 0; l < L; ++l) {
+                int32_t s = state_[c][l];
+                float demand = s == kActive ? nominal * duty_[c][l]
+                             : s == kWarm ? warm_power
+                             : s == kBooting ? boot_power : 0.0f;
+                float limit = std::min(available[l], std::max(flexible_budget[l], cap_floor));
+                float grant = s == kOff ? 0.0f : std::min(limit, demand);
+                current_[c][l] = grant;
+                available[l] -= grant;
+                flexible_budget[l] -= charge * grant;
+            }
+        }
+
+        // hardwareDraw() i całkowanie baterii jak w stepCore()
+        float draw[L] = {};
+        for (size_t c = 0; c < count_; ++c) {
+            float nominal = nominal_[c];
+            float warm_power = warm_power_[c];
+            float boot_power = boot_power_[c];
+            for (size_t l = 0; l < L; ++l) {
+                int32_t s = state_[c][l];
+                draw[l] += s == kActive ? nominal * duty_[c][l]
+                         : s == kWarm ? warm_power
+                         : s == kBooting ? boot_power : 0.0f;
+            }
+        }
+        double step_hours = dt / 3600.0;
+        for (size_t l = 0; l < L; ++l) {
+            float total = draw[l] + extra_[l];
+            float soc = soc_[l] + static_cast<float>((solar_[l] - total) * step_hours * 100.0 / capacity_wh_[l]);
+            soc_[l] = std::min(std::max(soc, 0.0f), 100.0f);
+        }
+    }
+
+    // applyDependencyMasks() na liniach, które zmieniły tryb: od żądań, potem zawężanie
+    void applyDependencies(const int32_t* changed) {
+        int32_t any = 0;
+        for (size_t l = 0; l < L; ++l) {
+            any |= changed[l];
+        }
+        if (!any) {
+            return;
+        }
+        for (size_t c = 0; c < count_; ++c) {
+            for (size_t l = 0; l < L; ++l) {
+                enabled_[c][l] = select(changed[l], requested_[c][l], enabled_[c][l]);
+            }
+        }
+        for (size_t pass = 0; pass < count_; ++pass) {
+            uint32_t enabled[L] = {};
+            for (size_t c = 0; c < count_; ++c) {
+                for (size_t l = 0; l < L; ++l) {
+                    enabled[l] |= static_cast<uint32_t>(enabled_[c][l]) << c;
+                }
+            }
+            int32_t any_off = 0;
+            for (size_t c = 0; c < count_; ++c) {
+                for (size_t l = 0; l < L; ++l) {
+                    int32_t off = changed[l] & enabled_[c][l] & ((dependency_mask_[c] & ~enabled[l]) != 0);
+                    enabled_[c][l] &= off ^ 1;
+                    any_off |= off;
+                }
+            }
+            if (!any_off) {
+                return;
+            }
+        }
+    }
+
+    size_t count_;
+    int32_t dust_storm_;
+    float storm_budget_w_;
+
+    // Metadane wspólne dla bloku
+    std::array<uint8_t, kMaxComponents> order_{};
+    float nominal_[kMaxComponents];
+    float boot_time_[kMaxComponents];
+    float boot_power_[kMaxComponents];
+    float warm_power_[kMaxComponents];
+    float warmup_time_[kMaxComponents];
+    float break_even_[kMaxComponents];
+    bool flexible_[kMaxComponents];
+    uint32_t dependency_mask_[kMaxComponents];
+    int32_t allowed_[kPowerModeCount][kMaxComponents];
+
+    // Stan [komponent][łazik]
+    alignas(64) int32_t state_[kMaxComponents][L];
+    alignas(64) float state_time_[kMaxComponents][L];
+    alignas(64) int32_t enabled_[kMaxComponents][L];
+    alignas(64) int32_t requested_[kMaxComponents][L];
+    alignas(64) float duty_[kMaxComponents][L];
+    alignas(64) float current_[kMaxComponents][L];
+
+    // Stan i progi [łazik]
+    alignas(64) float soc_[L];
+    alignas(64) int32_t mode_[L];
+    alignas(64) float time_in_mode_[L];
+    alignas(64) float capacity_wh_[L];
+    alignas(64) float solar_[L];
+    alignas(64) float extra_[L];
+    alignas(64) float emergency_soc_[L];
+    alignas(64) float hibernation_solar_w_[L];
+    alignas(64) float hibernation_soc_[L];
+    alignas(64) float low_power_soc_[L];
+    alignas(64) float low_power_balance_w_[L];
+    alignas(64) float normal_soc_[L];
+    alignas(64) float normal_balance_w_[L];
+    alignas(64) float min_dwell_s_[L];
+    alignas(64) float min_soc_[L];
+    alignas(64) float science_hours_[L];
+    alignas(64) float emergency_hours_[L];
+    alignas(64) uint32_t transitions_[L];
+};
+
+// Symulator wsadowy: każda para (polityka, scenariusz) to niezależny CoreState
+// kopiowany z punktu startowego, liczony równolegle na puli.
+class BatchSimulator {
+public:
+    explicit BatchSimulator(ThreadPool& pool, BatchLayout layout = BatchLayout::PER_ROVER)
+        : pool_(pool), layout_(layout) {}
+
+    void setLayout(BatchLayout layout) { layout_ = layout; }
+    BatchLayout layout() const { return layout_; }
+
+    // out[p * scenarios.size() + s]
+    void run(const CoreState& initial, const std::vector<PolicyParameters>& policies,
+             const std::vector<Scenario>& scenarios, size_t science_index,
+             std::vector<SimulationMetrics>& out) {
+        views_.clear();
+        for (const auto& scenario : scenarios) {
+            views_.push_back(scenario.view());
+        }
+        out.resize(policies.size() * views_.size());
+        run(initial, policies.data(), policies.size(), views_.data(), views_.size(), science_index, out.data());
+    }
+
+    void run(const CoreState& initial, const PolicyParameters* policies, size_t policy_count,
+             const ScenarioView* scenarios, size_t scenario_count, size_t science_index,
+             SimulationMetrics* out) {
+        if (layout_ == BatchLayout::LANES) {
+            runLanes(initial, policies, policy_count, scenarios, scenario_count, science_index, out);
+            return;
+        }
+        pool_.parallelFor(policy_count * scenario_count, [&](size_t i) {
+            out[i] = simulate(initial, policies[i / scenario_count], scenarios[i % scenario_count],
+                              science_index);
+        });
+    }
+
+    static SimulationMetrics simulate(const CoreState& initial, const PolicyParameters& policy,
+                                      const ScenarioView& scenario, size_t science_index,
+                                      const TraceBuffers& trace = TraceBuffers()) {
+        CoreState s = initial;
+        s.mode.thresholds = policy.thresholds;
+        s.mode.plan_valid = false;
+        s.mode.transitions = 0;
+        s.energy.battery_soc = scenario.initial_soc;
+        if (policy.custom_order) {
+            s.allocation_order = policy.allocation_order;
+        }
+
+        SimulationMetrics metrics{s.energy.battery_soc, 0.0f, 0.0f, 0.0f, 0};
+        float hours = scenario.step_s / 3600.0f;
+        size_t count = s.component_count;
+        for (size_t k = 0; k < scenario.steps; ++k) {
+            StepInputs inputs{scenario.solar_w[k], scenario.extra_load_w ? scenario.extra_load_w[k] : 0.0f};
+            stepCore(s, inputs, scenario.step_s);
+            metrics.min_soc = std::min(metrics.min_soc, s.energy.battery_soc);
+            if (science_index < count && s.components[science_index].power_state == ComponentPowerState::ACTIVE) {
+                metrics.science_hours += hours;
+            }
+            if (s.mode.mode == PowerMode::EMERGENCY) {
+                metrics.emergency_hours += hours;
+            }
+            if (trace.soc) {
+                trace.soc[k] = s.energy.battery_soc;
+            }
+            if (trace.consumption) {
+                trace.consumption[k] = s.energy.power_consumption;
+            }
+            if (trace.mode) {
+                trace.mode[k] = static_cast<uint8_t>(s.mode.mode);
+            }
+            if (trace.grants) {
+                for (size_t c = 0; c < count; ++c) {
+                    trace.grants[k * count + c] = s.components[c].current_power;
+                }
+            }
+        }
+        metrics.final_soc = s.energy.battery_soc;
+        metrics.transitions = s.mode.transitions;
+        return metrics;
+    }
+
+private:
+    // Pary (polityka, scenariusz) grupowane w bloki o tej samej długości, kroku
+    // i kolejności przydziału; bloki liczone równolegle.
+    void runLanes(const CoreState& initial, const PolicyParameters* policies, size_t policy_count,
+                  const ScenarioView* scenarios, size_t scenario_count, size_t science_index,
+                  SimulationMetrics* out) {
+        size_t total = policy_count * scenario_count;
+        auto order_of = [&](size_t i) -> const uint8_t* {
+            const PolicyParameters& p = policies[i / scenario_count];
+            return p.custom_order ? p.allocation_order.data() : initial.allocation_order.data();
+        };
+        auto same_block = [&](size_t a, size_t b) {
+            const ScenarioView& x = scenarios[a % scenario_count];
+            const ScenarioView& y = scenarios[b % scenario_count];
+            return x.steps == y.steps && x.step_s == y.step_s &&
+                   std::equal(order_of(a), order_of(a) + initial.component_count, order_of(b));
+        };
+        pairs_.resize(total);
+        std::iota(pairs_.begin(), pairs_.end(), 0);
+        std::stable_sort(pairs_.begin(), pairs_.end(), [&](size_t a, size_t b) {
+            const ScenarioView& x = scenarios[a % scenario_count];
+            const ScenarioView& y = scenarios[b % scenario_count];
+            if (x.steps != y.steps) {
+                return x.steps < y.steps;
+            }
+            if (x.step_s != y.step_s) {
+                return x.step_s < y.step_s;
+            }
+            return std::lexicographical_compare(order_of(a), order_of(a) + initial.component_count,
+                                                order_of(b), order_of(b) + initial.component_count);
+        });
+        blocks_.clear();
+        for (size_t k = 0; k < total;) {
+            size_t end = k + 1;
+            while (end < total && end - k < kLaneWidth && same_block(pairs_[k], pairs_[end])) {
+                ++end;
+            }
+            blocks_.push_back({k, end});
+            k = end;
+        }
+
+        pool_.parallelFor(blocks_.size(), [&](size_t b) {
+            const PolicyParameters* lane_policies[kLaneWidth];
+            const ScenarioView* lane_scenarios[kLaneWidth];
+            SimulationMetrics* lane_out[kLaneWidth];
+            size_t lanes = blocks_[b].second - blocks_[b].first;
+            for (size_t l = 0; l < lanes; ++l) {
+                size_t i = pairs_[blocks_[b].first + l];
+                lane_policies[l] = &policies[i / scenario_count];
+                lane_scenarios[l] = &scenarios[i % scenario_count];
+                lane_out[l] = &out[i];
+            }
+            LaneBlock<kLaneWidth> block(initial, order_of(pairs_[blocks_[b].first]));
+            block.run(lane_policies, lane_scenarios, lanes, science_index, lane_out);
+        });
+    }
+
+    ThreadPool& pool_;
+    BatchLayout layout_;
+    std::vector<ScenarioView> views_;
+    std::vector<size_t> pairs_;
+    std::vector<std::pair<size_t, size_t>> blocks_;
+};
+
+}
+
+#endif // BATCH_SIMULATOR_HPP
@@ -0,0 +1,109 @@
+#ifndef BUDGET_CURVE_HPP
+#define BUDGET_CURVE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "mars_time.hpp"
+#include "solar_forecast.hpp"
+
+namespace rover_energy {
+
+// Przedziały to godziny marsjańskie (1/24 sola) wyrównane do pełnych godzin LTST;
+// pierwszy trwa od teraz do końca bieżącej godziny, więc 25 przedziałów pokrywa cały sol.
+static constexpr size_t kBudgetSteps = 25;
+static constexpr double kBudgetConfidenceDecayHours = 48.0;
+
+struct BudgetPoint {
+    float energy_wh;    // generacja minus obciążenie niezrzucalne i rezerwacje [Wh]
+    float soc;          // oczekiwany SOC na końcu przedziału przy obciążeniu bieżącego trybu [%]
+    float confidence;   // [0, 1]
+};
+
+struct BudgetInputs {
+    double ltst_hours;
+    int64_t local_sol;
+    float soc;
+    double battery_capacity_wh;
+    float committed_load_w;     // obciążenie, którego nie da się zrzucić
+    float mode_load_w;          // obciążenie bieżącego trybu
+    const float* reserved_w;    // kBudgetSteps rezerwacji mocy (grzałki)
+};
+
+// Energia bezchmurnego nieba na przedział zależy tylko od geometrii, więc jest
+// trzymana w buforze przesuwanym o pełne godziny; co cykl liczony jest od nowa tylko
+// skrócony bieżący przedział oraz tanie skalowanie kalibracją i suma SOC.
+class BudgetCurve {
+public:
+    const std::array<BudgetPoint, kBudgetSteps>& points() const { return points_; }
+
+    const std::array<BudgetPoint, kBudgetSteps>& update(const SolarForecaster& forecaster,
+                                                         double latitude_deg, const MarsTime& mars_time,
+                                                         const BudgetInputs& inputs) {
+        double hour = std::floor(inputs.ltst_hours);
+        int64_t origin = inputs.local_sol * 24 + static_cast<int64_t>(hour);
+        int64_t shift = origin - origin_;
+        if (!valid_ || latitude_deg != latitude_deg_ || shift < 0 ||
+            shift >= static_cast<int64_t>(kBudgetSteps)) {
+            fill(forecaster, latitude_deg, mars_time, hour, 1);
+        } else if (shift > 0) {
+            std::rotate(clear_wh_.begin() + 1, clear_wh_.begin() + 1 + shift, clear_wh_.end());
+            fill(forecaster, latitude_deg, mars_time, hour, kBudgetSteps - shift);
+        }
+        origin_ = origin;
+        latitude_deg_ = latitude_deg;
+        valid_ = true;
+
+        double remaining = hour + 1.0 - inputs.ltst_hours;
+        float partial_w = 0.0f;
+        forecaster.clearSkyForecast(latitude_deg, mars_time, inputs.ltst_hours, remaining, 1, &partial_w);
+        clear_wh_[0] = partial_w * remaining * kMarsHourHours;
+
+        double calibration = forecaster.calibration();
+        double solar_confidence = std::clamp(1.0 - forecaster.calibrationSpread(), 0.1, 1.0);
+        double soc_per_wh = 100.0 / inputs.battery_capacity_wh;
+        double soc = inputs.soc;
+        double lead_hours = 0.0;
+        for (size_t k = 0; k < kBudgetSteps; ++k) {
+            double hours = (k == 0 ? remaining : 1.0) * kMarsHourHours;
+            double solar_wh = calibration * clear_wh_[k];
+            double reserved_wh = inputs.reserved_w[k] * hours;
+            points_[k].energy_wh = static_cast<float>(
+                solar_wh - inputs.committed_load_w * hours - reserved_wh);
+            soc = std::clamp(soc + soc_per_wh * (solar_wh - inputs.mode_load_w * hours - reserved_wh),
+                             0.0, 100.0);
+            points_[k].soc = static_cast<float>(soc);
+            lead_hours += 0.5 * hours;
+            double confidence = std::exp(-lead_hours / kBudgetConfidenceDecayHours);
+            points_[k].confidence = static_cast<float>(
+                solar_wh > 0.0 ? confidence * solar_confidence : confidence);
+            lead_hours += 0.5 * hours;
+        }
+        return points_;
+    }
+
+private:
+    // Przelicza przedziały [first, kBudgetSteps) od pełnej godziny hour_start.
+    void fill(const SolarForecaster& forecaster, double latitude_deg, const MarsTime& mars_time,
+              double hour_start, size_t first) {
+        std::array<float, kBudgetSteps> power_w;
+        size_t count = kBudgetSteps - first;
+        forecaster.clearSkyForecast(latitude_deg, mars_time, hour_start + first, 1.0, count, power_w.data());
+        for (size_t k = 0; k < count; ++k) {
+            clear_wh_[first + k] = power_w[k] * kMarsHourHours;
+        }
+    }
+
+    std::array<BudgetPoint, kBudgetSteps> points_{};
+    std::array<double, kBudgetSteps> clear_wh_{};   // [0] to bieżący, skrócony przedział
+    int64_t origin_ = 0;
+    double latitude_deg_ = 0.0;
+    bool valid_ = false;
+};
+
+}
+
+#endif // BUDGET_CURVE_HPP
@@ -0,0 +1,268 @@
+#ifndef COMPACT_STATE_HPP
+#define COMPACT_STATE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "batch_simulator.hpp"
+#include "energy_core.hpp"
+
+namespace rover_energy {
+
+// Zwarty stan do dużych przeglądów: jedna linia pamięci podręcznej na łazik.
+// Wszystko, co nie zmienia się w trakcie symulacji (parametry komponentów, kolejność
+// przydziału, progi polityk, pojemność baterii), jest w CompactTable wspólnej dla areny.
+static constexpr size_t kCompactMaxComponents = 8;
+static constexpr float kCompactSocScale = 1e7f;         // [1e-7 %]
+static constexpr float kCompactTimeScale = 10.0f;       // [0.1 s]
+static constexpr float kCompactPowerScale = 100.0f;     // [0.01 W]
+static constexpr float kCompactMaxTimeS = 65535.0f / kCompactTimeScale;
+
+struct alignas(64) CompactRoverState {
+    uint32_t soc;                   // [1e-7 %]
+    uint32_t min_soc;               // [1e-7 %]
+    uint32_t ticks;
+    uint32_t science_ticks;         // ticki z komponentem naukowym w ACTIVE
+    uint32_t emergency_ticks;
+    uint16_t time_in_mode;          // [0.1 s], nasycane
+    uint16_t transitions;
+    uint16_t policy;                // indeks progów w CompactTable::policies
+    uint16_t power_states;          // 2 bity ComponentPowerState na komponent
+    uint8_t enabled;                // bit is_enabled na komponent
+    uint8_t mode;
+    uint8_t dust_storm;             // ModeMachineState::dust_storm
+    uint8_t requested;              // bit mode_enabled na komponent
+    uint16_t state_time[kCompactMaxComponents];     // [0.1 s], nasycane
+    uint16_t grant[kCompactMaxComponents];          // [0.01 W]
+};
+
+static_assert(sizeof(CompactRoverState) == 64, "CompactRoverState must fit one cache line");
+
+struct CompactTable {
+    std::array<CoreComponent, kCompactMaxComponents> components;   // część statyczna; stan w łaziku
+    std::array<uint8_t, kCompactMaxComponents> allocation_order;
+    uint8_t component_count;
+    ModeEnableMasks mode_masks;
+    size_t science_index;
+    float battery_capacity_wh;
+    float storm_budget_w;           // budżet elastyczny łazików w burzy pyłowej
+    std::vector<ModeThresholds> policies;
+};
+
+// Tabela wspólna z prototypu. Czasy przejść i histerezy muszą zmieścić się
+// w nasyconym liczniku [0.1 s], inaczej porównania „czas >= próg” byłyby fałszywe.
+inline bool buildCompactTable(const CoreState& prototype, const std::vector<ModeThresholds>& policies,
+                              size_t science_index, CompactTable& table, std::string& error) {
+    if (prototype.component_count > kCompactMaxComponents) {
+        error = "compact state holds at most 8 components";
+        return false;
+    }
+    if (policies.empty() || policies.size() > UINT16_MAX) {
+        error = "policy count out of range";
+        return false;
+    }
+    table.component_count = prototype.component_count;
+    for (size_t c = 0; c < prototype.component_count; ++c) {
+        const CoreComponent& comp = prototype.components[c];
+        float break_even = breakEvenSeconds(comp);
+        if (comp.transition.boot_time_s >= kCompactMaxTimeS || comp.transition.warmup_time_s >= kCompactMaxTimeS ||
+            (std::isfinite(break_even) && break_even >= kCompactMaxTimeS)) {
+            error = "transition times exceed the compact time range";
+            return false;
+        }
+        if (comp.nominal_power * std::max(1.0f, comp.transition.boot_power_factor) * kCompactPowerScale > UINT16_MAX) {
+            error = "component power exceeds the compact grant range";
+            return false;
+        }
+        table.components[c] = comp;
+        table.allocation_order[c] = prototype.allocation_order[c];
+    }
+    for (const auto& policy : policies) {
+        if (policy.min_dwell_s >= kCompactMaxTimeS) {
+            error = "dwell time exceeds the compact time range";
+            return false;
+        }
+    }
+    table.mode_masks = prototype.mode_masks;
+    table.science_index = science_index;
+    table.battery_capacity_wh = prototype.battery.capacity_wh;
+    table.storm_budget_w = prototype.mode.dust_storm ? prototype.mode.flexible_budget_w : INFINITY;
+    table.policies = policies;
+    return true;
+}
+
+// Zaokrąglenie wartości nieujemnych bez wywołania lround() (gorąca pętla przeglądu)
+inline uint32_t roundCompact(float value) {
+    return static_cast<uint32_t>(value + 0.5f);
+}
+
+inline uint16_t compactTime(float seconds) {
+    return static_cast<uint16_t>(roundCompact(std::min(std::max(seconds, 0.0f), kCompactMaxTimeS) * kCompactTimeScale));
+}
+
+inline uint32_t compactSoc(float soc) {
+    return static_cast<uint32_t>(std::llround(std::min(std::max(soc, 0.0f), 100.0f) * static_cast<double>(kCompactSocScale)));
+}
+
+// Stan dynamiczny komponentów: bity stanu i włączenia, czasy i przydziały.
+inline void encodeComponents(const CoreComponent* components, size_t count, CompactRoverState& r) {
+    uint16_t states = 0;
+    uint8_t enabled = 0;
+    uint8_t requested = 0;
+    for (size_t c = 0; c < count; ++c) {
+        const CoreComponent& comp = components[c];
+        states |= static_cast<uint16_t>(static_cast<uint16_t>(comp.power_state) << (2 * c));
+        enabled |= static_cast<uint8_t>(comp.is_enabled ? 1u << c : 0u);
+        requested |= static_cast<uint8_t>(comp.mode_enabled ? 1u << c : 0u);
+        r.state_time[c] = compactTime(comp.state_time_s);
+        r.grant[c] = static_cast<uint16_t>(roundCompact(std::max(comp.current_power, 0.0f) * kCompactPowerScale));
+    }
+    r.power_states = states;
+    r.enabled = enabled;
+    r.requested = requested;
+}
+
+// Nadpisuje tylko pola dynamiczne; pola statyczne components muszą już pochodzić z tabeli.
+inline void decodeComponents(const CompactRoverState& r, size_t count, CoreComponent* components) {
+    for (size_t c = 0; c < count; ++c) {
+        CoreComponent& comp = components[c];
+        comp.power_state = static_cast<ComponentPowerState>((r.power_states >> (2 * c)) & 3u);
+        comp.is_enabled = (r.enabled >> c) & 1u;
+        comp.mode_enabled = (r.requested >> c) & 1u;
+        comp.state_time_s = r.state_time[c] * (1.0f / kCompactTimeScale);
+        comp.current_power = r.grant[c] * (1.0f / kCompactPowerScale);
+    }
+}
+
+inline CompactRoverState compactFromCore(const CoreState& s, uint16_t policy) {
+    CompactRoverState r{};
+    r.soc = compactSoc(s.energy.battery_soc);
+    r.min_soc = r.soc;
+    r.time_in_mode = compactTime(s.mode.time_in_mode_s);
+    r.policy = policy;
+    r.mode = static_cast<uint8_t>(s.mode.mode);
+    r.dust_storm = s.mode.dust_storm;
+    encodeComponents(s.components.data(), std::min<size_t>(s.component_count, kCompactMaxComponents), r);
+    return r;
+}
+
+// Rozwinięcie do pełnego stanu (np. do rozwidlenia albo dalszej symulacji stepCore()).
+inline void expandToCore(const CompactRoverState& r, const CompactTable& table, CoreState& s) {
+    s.component_count = table.component_count;
+    s.mode_masks = table.mode_masks;
+    std::copy(table.components.begin(), table.components.begin() + table.component_count, s.components.begin());
+    decodeComponents(r, table.component_count, s.components.data());
+    std::copy(table.allocation_order.begin(), table.allocation_order.begin() + table.component_count,
+              s.allocation_order.begin());
+    s.energy.battery_soc = r.soc / kCompactSocScale;
+    s.energy.mode = static_cast<PowerMode>(r.mode);
+    s.mode.mode = static_cast<PowerMode>(r.mode);
+    s.mode.plan_valid = false;
+    s.mode.dust_storm = r.dust_storm != 0;
+    if (s.mode.dust_storm) {
+        s.mode.flexible_budget_w = table.storm_budget_w;
+    }
+    s.mode.thresholds = table.policies[r.policy];
+    s.mode.time_in_mode_s = r.time_in_mode / kCompactTimeScale;
+    s.mode.transitions = r.transitions;
+    s.battery.capacity_wh = table.battery_capacity_wh;
+}
+
+// Krok stepCore() bez planu MPC na stanie zwartym: dekodowanie do komponentów roboczych,
+// te same funkcje rdzenia, kodowanie z powrotem. scratch to kopia table.components
+// wypełniona raz na przegląd. Pobór baterii liczony jest z nominałów, więc przydziały
+// [0.01 W] i czasy [0.1 s] nie zmieniają całkowania. SOC jest tu w stałym przecinku [1e-7 %],
+// a stepCore() sumuje go we float (ulp ~4e-6 % przy 50 %): po 1000 tickach SOC różnią się
+// o ~1e-3 %, a gdy to przesunie przekroczenie progu trybu o tick, końcowy SOC różni się
+// o ~0.01-0.02 % (batch_layout_bench: 0.0139 dla 16384 łazików x 1000 ticków po 10 s).
+inline void stepCompact(CompactRoverState& r, const CompactTable& table, const StepInputs& inputs, float dt,
+                        CoreComponent* scratch) {
+    size_t count = table.component_count;
+    CoreComponent* components = scratch;
+    decodeComponents(r, count, components);
+    PowerMode mode = static_cast<PowerMode>(r.mode);
+    const ModeThresholds& thresholds = table.policies[r.policy];
+    float soc = r.soc / kCompactSocScale;
+
+    advancePowerStates(components, count, dt, modeAllowsWarmHold(mode));
+    float consumption = totalPowerConsumption(components, count) + inputs.extra_load_w;
+    float time_in_mode = r.time_in_mode / kCompactTimeScale + dt;
+    ModeRule rule;
+    float threshold;
+    PowerMode target = selectMode(thresholds, mode, r.dust_storm != 0, false, mode, soc,
+                                  inputs.solar_w - consumption, inputs.solar_w, rule, threshold);
+    if (target != mode && modeChangeAllowed(thresholds, target, time_in_mode)) {
+        applyModeMask(components, count, table.mode_masks, mode, target);
+        mode = target;
+        time_in_mode = 0.0f;
+        ++r.transitions;
+        applyDependencyMasks(components, count);
+    }
+    allocateComponentPower(components, table.allocation_order.data(), count, inputs.solar_w,
+                           r.dust_storm ? table.storm_budget_w : inputs.solar_w);
+
+    float draw = hardwareDraw(components, count) + inputs.extra_load_w;
+    double change = (inputs.solar_w - draw) * (dt / 3600.0) * 100.0 / table.battery_capacity_wh * kCompactSocScale;
+    int64_t delta = static_cast<int64_t>(change + (change >= 0.0 ? 0.5 : -0.5));
+    r.soc = static_cast<uint32_t>(std::clamp<int64_t>(static_cast<int64_t>(r.soc) + delta, 0,
+                                                      static_cast<int64_t>(100.0f * kCompactSocScale)));
+    r.min_soc = std::min(r.min_soc, r.soc);
+    r.mode = static_cast<uint8_t>(mode);
+    r.time_in_mode = compactTime(time_in_mode);
+    ++r.ticks;
+    r.emergency_ticks += mode == PowerMode::EMERGENCY;
+
+    encodeComponents(components, count, r);
+    r.science_ticks += table.science_index < count &&
+                       components[table.science_index].power_state == ComponentPowerState::ACTIVE;
+}
+
+// Arena: wszystkie łaziki w jednym ciągłym buforze wyrównanym do linii pamięci podręcznej.
+class CompactArena {
+public:
+    explicit CompactArena(CompactTable table)
+        : table_(std::move(table)) {}
+
+    const CompactTable& table() const { return table_; }
+
+    void reserve(size_t rovers) { rovers_.reserve(rovers); }
+    size_t size() const { return rovers_.size(); }
+    size_t bytes() const { return rovers_.size() * sizeof(CompactRoverState); }
+
+    size_t add(const CoreState& state, uint16_t policy) {
+        rovers_.push_back(compactFromCore(state, policy));
+        return rovers_.size() - 1;
+    }
+
+    CompactRoverState& operator[](size_t i) { return rovers_[i]; }
+    const CompactRoverState& operator[](size_t i) const { return rovers_[i]; }
+
+    // Jeden krok dla łazików [begin, end); inputs[i - begin] należy do łazika i.
+    void step(size_t begin, size_t end, const StepInputs* inputs, float dt) {
+        std::array<CoreComponent, kCompactMaxComponents> scratch = table_.components;
+        for (size_t i = begin; i < end; ++i) {
+            stepCompact(rovers_[i], table_, inputs[i - begin], dt, scratch.data());
+        }
+    }
+
+    SimulationMetrics metrics(size_t i, float dt) const {
+        const CompactRoverState& r = rovers_[i];
+        float hours = dt / 3600.0f;
+        return {r.min_soc / kCompactSocScale, r.soc / kCompactSocScale, r.science_ticks * hours,
+                r.emergency_ticks * hours, r.transitions};
+    }
+
+private:
+    CompactTable table_;
+    std::vector<CompactRoverState> rovers_;
+};
+
+}
+
+#endif // COMPACT_STATE_HPP
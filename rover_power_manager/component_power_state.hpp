@@ -0,0 +1,130 @@
+#ifndef COMPONENT_POWER_STATE_HPP
+#define COMPONENT_POWER_STATE_HPP
+
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "power_types.hpp"
+
+namespace rover_energy {
+
+// Funkcje są szablonami po typie komponentu, żeby ten sam model działał na tabeli
+// węzła (PowerComponent) i na stanie symulacji (CoreComponent z energy_core.hpp).
+// Moce i energie mają typ pola nominal_power (float albo Dual w analizie wrażliwości).
+template <typename Component>
+using PowerScalar = std::decay_t<decltype(std::declval<const Component&>().nominal_power)>;
+
+// Energia ponownego uruchomienia: rozruch z nadmiarowym poborem + dojście do ACTIVE.
+template <typename Component>
+inline PowerScalar<Component> restartEnergyJ(const Component& comp) {
+    const auto& t = comp.transition;
+    return t.boot_time_s * comp.nominal_power * t.boot_power_factor +
+           t.warmup_time_s * t.warm_power;
+}
+
+// Przerwa, po której wyłączenie zaczyna się opłacać (strategia ski-rental:
+// trzymamy WARM dokładnie tyle, ile kosztowałby restart, co daje co najwyżej 2x optimum).
+template <typename Component>
+inline PowerScalar<Component> breakEvenSeconds(const Component& comp) {
+    PowerScalar<Component> restart = restartEnergyJ(comp);
+    if (restart <= 0.0f) {
+        return 0.0f;
+    }
+    if (comp.transition.warm_power <= 0.0f) {
+        return std::numeric_limits<float>::infinity();
+    }
+    return restart / comp.transition.warm_power;
+}
+
+template <typename Component>
+inline bool shortGapWorthKeepingWarm(const Component& comp, float expected_gap_s) {
+    return expected_gap_s < breakEvenSeconds(comp);
+}
+
+// Pobór wynikający ze stanu; ACTIVE to zapotrzebowanie przed przydziałem.
+template <typename Component>
+inline PowerScalar<Component> powerStateDemand(const Component& comp) {
+    switch (comp.power_state) {
+        case ComponentPowerState::OFF: return 0.0f;
+        case ComponentPowerState::BOOTING: return comp.nominal_power * comp.transition.boot_power_factor;
+        case ComponentPowerState::WARM: return comp.transition.warm_power;
+        case ComponentPowerState::ACTIVE: return comp.nominal_power * comp.duty_cycle;
+    }
+    return 0.0f;
+}
+
+template <typename Component>
+inline void enterPowerState(Component& comp, ComponentPowerState state) {
+    comp.power_state = state;
+    comp.state_time_s = 0.0f;
+}
+
+// Krok maszyny stanów dla wszystkich komponentów. is_enabled to żądanie trybu;
+// rozruchy są sekwencjonowane po jednym, żeby nie sumować prądów rozruchowych.
+// Przy allow_warm_hold == false (EMERGENCY, DUST_STORM) zrzucane komponenty gasną od razu.
+template <typename Component>
+inline void advancePowerStates(Component* components, size_t count, float dt, bool allow_warm_hold) {
+    bool boot_in_progress = false;
+    for (size_t i = 0; i < count; ++i) {
+        boot_in_progress = boot_in_progress || components[i].power_state == ComponentPowerState::BOOTING;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        Component& comp = components[i];
+        comp.state_time_s += dt;
+        const auto& t = comp.transition;
+        if (comp.is_enabled) {
+            switch (comp.power_state) {
+                case ComponentPowerState::OFF:
+                    if (t.boot_time_s <= 0.0f) {
+                        enterPowerState(comp, t.warmup_time_s > 0.0f
+                            ? ComponentPowerState::WARM : ComponentPowerState::ACTIVE);
+                    } else if (!boot_in_progress) {
+                        enterPowerState(comp, ComponentPowerState::BOOTING);
+                        boot_in_progress = true;
+                    }
+                    break;
+                case ComponentPowerState::BOOTING:
+                    if (comp.state_time_s >= t.boot_time_s) {
+                        enterPowerState(comp, ComponentPowerState::WARM);
+                    }
+                    break;
+                case ComponentPowerState::WARM:
+                    if (comp.state_time_s >= t.warmup_time_s) {
+                        enterPowerState(comp, ComponentPowerState::ACTIVE);
+                    }
+                    break;
+                case ComponentPowerState::ACTIVE:
+                    break;
+            }
+        } else {
+            switch (comp.power_state) {
+                case ComponentPowerState::OFF:
+                    break;
+                case ComponentPowerState::BOOTING:
+                    enterPowerState(comp, ComponentPowerState::OFF);
+                    break;
+                case ComponentPowerState::ACTIVE:
+                    enterPowerState(comp, allow_warm_hold && breakEvenSeconds(comp) > 0.0f
+                        ? ComponentPowerState::WARM : ComponentPowerState::OFF);
+                    break;
+                case ComponentPowerState::WARM:
+                    if (!allow_warm_hold || comp.state_time_s >= breakEvenSeconds(comp)) {
+                        enterPowerState(comp, ComponentPowerState::OFF);
+                    }
+                    break;
+            }
+        }
+    }
+}
+
+inline void advancePowerStates(std::vector<PowerComponent>& components, float dt, bool allow_warm_hold) {
+    advancePowerStates(components.data(), components.size(), dt, allow_warm_hold);
+}
+
+}
+
+#endif // COMPONENT_POWER_STATE_HPP
@@ -0,0 +1,323 @@
+#ifndef COMPONENT_REGISTRY_HPP
+#define COMPONENT_REGISTRY_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "power_types.hpp"
+
+namespace rover_energy {
+
+// Bit 31 maski zależności oznacza zależność jeszcze niezarejestrowaną.
+static constexpr size_t kMaxComponents = 31;
+static constexpr uint32_t kUnresolvedDependency = 1u << 31;
+
+struct ComponentRegistration {
+    PowerComponent component;
+    std::string owner;                      // pełna nazwa węzła ładunku
+    std::vector<std::string> dependencies;
+    std::vector<float> power_levels;        // dopuszczalne poziomy poboru [W]
+};
+
+// Włączenie efektywne od nowa z żądań trybu: komponent jest włączony, gdy tryb go żąda
+// i wszystkie jego zależności są (efektywnie) włączone; zawężanie do punktu stałego.
+// Liczone zawsze od mode_enabled, więc komponent wraca sam, gdy zależność się zarejestruje
+// albo znów włączy.
+template <typename Component>
+inline void applyDependencyMasks(Component* components, size_t count) {
+    uint32_t enabled = 0;
+    for (size_t i = 0; i < count; ++i) {
+        enabled |= static_cast<uint32_t>(components[i].mode_enabled) << i;
+    }
+    for (size_t pass = 0; pass < count; ++pass) {
+        uint32_t next = enabled;
+        for (uint32_t bits = enabled; bits != 0; bits &= bits - 1) {
+            size_t i = static_cast<size_t>(__builtin_ctz(bits));
+            if ((components[i].dependency_mask & ~enabled) != 0) {
+                next &= ~(1u << i);
+            }
+        }
+        if (next == enabled) {
+            break;
+        }
+        enabled = next;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        components[i].is_enabled = (enabled >> i) & 1u;
+    }
+}
+
+// Skład trybu wynikający z priorytetu dla komponentów bez jawnej maski trybów
+// (ładunki rejestrowane w trakcie pracy): LOW_POWER zrzuca LOW i shed_in_low_power,
+// HIBERNATION zostawia krytyczne i niezbędne, EMERGENCY i DUST_STORM tylko krytyczne.
+template <typename Component>
+inline uint8_t priorityModeMask(const Component& comp) {
+    bool critical = comp.priority == ComponentPriority::CRITICAL;
+    uint8_t mask = modeBit(PowerMode::NORMAL);
+    if (comp.priority != ComponentPriority::LOW && !comp.shed_in_low_power) {
+        mask |= modeBit(PowerMode::LOW_POWER);
+    }
+    if (critical || comp.is_essential) {
+        mask |= modeBit(PowerMode::HIBERNATION);
+    }
+    if (critical) {
+        mask |= modeBit(PowerMode::EMERGENCY) | modeBit(PowerMode::DUST_STORM);
+    }
+    return mask;
+}
+
+template <typename Component>
+inline uint8_t componentModeMask(const Component& comp) {
+    return comp.mode_mask != 0 ? comp.mode_mask : priorityModeMask(comp);
+}
+
+// Skład trybów po bitach komponentów: bit i maski trybu = komponent i włączony w trybie.
+struct ModeEnableMasks {
+    std::array<uint32_t, kPowerModeCount> enabled{};
+
+    uint32_t of(PowerMode mode) const { return enabled[static_cast<size_t>(mode)]; }
+    bool allows(PowerMode mode, size_t index) const { return (of(mode) >> index) & 1u; }
+};
+
+template <typename Component>
+inline ModeEnableMasks buildModeMasks(const Component* components, size_t count) {
+    ModeEnableMasks masks;
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t modes = componentModeMask(components[i]);
+        for (size_t m = 0; m < kPowerModeCount; ++m) {
+            if (modes & modeBit(static_cast<PowerMode>(m))) {
+                masks.enabled[m] |= 1u << i;
+            }
+        }
+    }
+    return masks;
+}
+
+template <typename Component>
+inline uint32_t enabledMask(const Component* components, size_t count) {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < count; ++i) {
+        mask |= static_cast<uint32_t>(components[i].is_enabled) << i;
+    }
+    return mask;
+}
+
+template <typename Component>
+inline uint32_t requestedMask(const Component* components, size_t count) {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < count; ++i) {
+        mask |= static_cast<uint32_t>(components[i].mode_enabled) << i;
+    }
+    return mask;
+}
+
+// Skład po przejściu from -> mode: NORMAL, EMERGENCY i DUST_STORM go ustawiają (profil
+// przetrwania włącza też grzanie), LOW_POWER i HIBERNATION tylko wyłączają (komponenty
+// wyłączone wcześniej zostają wyłączone). Wyjście z EMERGENCY albo DUST_STORM też ustawia
+// skład: ich profil wyłączył jazdę, a zawężenie zostawiłoby łazik unieruchomiony do NORMAL.
+inline uint32_t modeTargetMask(const ModeEnableMasks& masks, PowerMode from, PowerMode mode, uint32_t current) {
+    bool from_survival = from == PowerMode::EMERGENCY || from == PowerMode::DUST_STORM;
+    switch (mode) {
+        case PowerMode::NORMAL:
+        case PowerMode::EMERGENCY:
+        case PowerMode::DUST_STORM:
+            return masks.of(mode);
+        case PowerMode::LOW_POWER:
+        case PowerMode::HIBERNATION:
+            return from_survival ? masks.of(mode) : current & masks.of(mode);
+    }
+    return current;
+}
+
+// Zmiana trybu jako różnica XOR z żądaniami bieżącymi: zapisywane są tylko komponenty,
+// których żądanie się zmienia. Zwraca maskę zmian żądań; włączenie efektywne ustala
+// potem applyDependencyMasks().
+template <typename Component>
+inline uint32_t applyModeMask(Component* components, size_t count, const ModeEnableMasks& masks,
+                              PowerMode from, PowerMode mode) {
+    uint32_t current = requestedMask(components, count);
+    uint32_t target = modeTargetMask(masks, from, mode, current);
+    uint32_t changed = current ^ target;
+    for (uint32_t bits = changed; bits != 0; bits &= bits - 1) {
+        size_t i = static_cast<size_t>(__builtin_ctz(bits));
+        components[i].mode_enabled = (target >> i) & 1u;
+    }
+    return changed;
+}
+
+// Rejestr komponentów dodawanych w trakcie pracy. Wbudowane komponenty mają
+// handle == 0. Każda zmiana rejestru przelicza maski zależności, włączenie efektywne
+// i kolejność przydziału, więc pętla zarządzania nie alokuje ani nie sortuje.
+class ComponentRegistry {
+public:
+    explicit ComponentRegistry(std::vector<PowerComponent>& components)
+        : components_(components) {
+        components_.reserve(kMaxComponents);
+        rebuild();
+    }
+
+    // Zwraca handle > 0 albo 0 z opisem błędu.
+    uint32_t add(ComponentRegistration registration, std::string& error) {
+        const std::string& name = registration.component.name;
+        if (name.empty()) {
+            error = "empty component name";
+            return 0;
+        }
+        for (const auto& comp : components_) {
+            if (comp.name == name) {
+                error = "component '" + name + "' already registered";
+                return 0;
+            }
+        }
+        if (components_.size() >= kMaxComponents) {
+            error = "component table full";
+            return 0;
+        }
+        for (const auto& dependency : registration.dependencies) {
+            if (dependency == name) {
+                error = "component depends on itself";
+                return 0;
+            }
+        }
+
+        uint32_t handle = next_handle_++;
+        registration.component.handle = handle;
+        if (!registration.power_levels.empty()) {
+            registration.component.nominal_power = registration.power_levels.front();
+        }
+        components_.push_back(registration.component);
+        registrations_.push_back({handle, std::move(registration.owner),
+                                  std::move(registration.dependencies),
+                                  std::move(registration.power_levels)});
+        rebuild();
+        return handle;
+    }
+
+    bool remove(uint32_t handle) {
+        auto entry = std::find_if(registrations_.begin(), registrations_.end(),
+            [handle](const Entry& e) { return e.handle == handle; });
+        if (entry == registrations_.end()) {
+            return false;
+        }
+        registrations_.erase(entry);
+        components_.erase(std::remove_if(components_.begin(), components_.end(),
+            [handle](const PowerComponent& c) { return c.handle == handle; }), components_.end());
+        rebuild();
+        return true;
+    }
+
+    // Wyrejestrowuje komponenty węzłów, których nie ma w grafie; zwraca ich liczbę.
+    size_t removeOrphans(const std::vector<std::string>& live_nodes) {
+        std::vector<uint32_t> orphans;
+        for (const auto& entry : registrations_) {
+            if (std::find(live_nodes.begin(), live_nodes.end(), entry.owner) == live_nodes.end()) {
+                orphans.push_back(entry.handle);
+            }
+        }
+        for (uint32_t handle : orphans) {
+            remove(handle);
+        }
+        return orphans.size();
+    }
+
+    bool hasRuntimeComponents() const { return !registrations_.empty(); }
+
+    PowerComponent* find(uint32_t handle) {
+        if (handle == 0) {
+            return nullptr;
+        }
+        for (auto& comp : components_) {
+            if (comp.handle == handle) {
+                return &comp;
+            }
+        }
+        return nullptr;
+    }
+
+    bool selectPowerLevel(uint32_t handle, size_t level) {
+        PowerComponent* comp = find(handle);
+        const Entry* entry = findEntry(handle);
+        if (!comp || !entry || level >= entry->power_levels.size()) {
+            return false;
+        }
+        comp->nominal_power = entry->power_levels[level];
+        return true;
+    }
+
+    // Komponenty posortowane wg priorytetu (stabilnie), gotowe dla allocatePower().
+    const std::vector<size_t>& allocationOrder() const { return allocation_order_; }
+
+    // Maski trybów przeliczane przy każdej zmianie składu tabeli
+    const ModeEnableMasks& modeMasks() const { return mode_masks_; }
+
+    // Rośnie przy każdej zmianie składu tabeli (indeksy komponentów mogły się przesunąć).
+    uint32_t generation() const { return generation_; }
+
+    void applyDependencies() {
+        applyDependencyMasks(components_.data(), components_.size());
+    }
+
+private:
+    struct Entry {
+        uint32_t handle;
+        std::string owner;
+        std::vector<std::string> dependencies;
+        std::vector<float> power_levels;
+    };
+
+    const Entry* findEntry(uint32_t handle) const {
+        for (const auto& entry : registrations_) {
+            if (entry.handle == handle) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    // Nieznana zależność blokuje komponent, dopóki jej dostawca się nie zarejestruje;
+    // po rejestracji dostawcy włączenie efektywne wraca do żądania trybu.
+    void rebuild() {
+        for (auto& comp : components_) {
+            comp.dependency_mask = 0;
+            const Entry* entry = findEntry(comp.handle);
+            if (!entry) {
+                continue;
+            }
+            for (const auto& dependency : entry->dependencies) {
+                size_t index = components_.size();
+                for (size_t i = 0; i < components_.size(); ++i) {
+                    if (components_[i].name == dependency) {
+                        index = i;
+                        break;
+                    }
+                }
+                comp.dependency_mask |= index < components_.size() ? 1u << index : kUnresolvedDependency;
+            }
+        }
+
+        allocation_order_.resize(components_.size());
+        for (size_t i = 0; i < allocation_order_.size(); ++i) {
+            allocation_order_[i] = i;
+        }
+        std::stable_sort(allocation_order_.begin(), allocation_order_.end(),
+            [this](size_t a, size_t b) { return components_[a].priority < components_[b].priority; });
+        mode_masks_ = buildModeMasks(components_.data(), components_.size());
+        applyDependencies();
+        ++generation_;
+    }
+
+    std::vector<PowerComponent>& components_;
+    std::vector<Entry> registrations_;
+    std::vector<size_t> allocation_order_;
+    ModeEnableMasks mode_masks_;
+    uint32_t next_handle_ = 1;
+    uint32_t generation_ = 0;
+};
+
+}
+
+#endif // COMPONENT_REGISTRY_HPP
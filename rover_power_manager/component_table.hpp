@@ -0,0 +1,164 @@
+#ifndef COMPONENT_TABLE_HPP
+#define COMPONENT_TABLE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "component_registry.hpp"
+#include "power_types.hpp"
+
+namespace rover_energy {
+
+// Tabela wbudowanych komponentów generowana w czasie kompilacji z components.def.
+// Komponenty ładunków dochodzą w trakcie pracy przez ComponentRegistry::add()
+// i zajmują indeksy za tabelą wbudowaną.
+
+static constexpr uint8_t MODE_N = modeBit(PowerMode::NORMAL);
+static constexpr uint8_t MODE_L = modeBit(PowerMode::LOW_POWER);
+static constexpr uint8_t MODE_H = modeBit(PowerMode::HIBERNATION);
+static constexpr uint8_t MODE_E = modeBit(PowerMode::EMERGENCY);
+static constexpr uint8_t MODE_D = modeBit(PowerMode::DUST_STORM);
+
+struct ComponentSpec {
+    const char* name;
+    ComponentPriority priority;
+    float nominal_power;
+    float initial_power;
+    bool is_essential;
+    ComponentTransitionModel transition;
+    uint8_t mode_mask;      // bit modeBit(tryb) = komponent włączony w trybie
+};
+
+enum class ComponentId : size_t {
+#define ROVER_COMPONENT(name, ...) name,
+#include "components.def"
+#undef ROVER_COMPONENT
+};
+
+static constexpr size_t kBuiltinComponentCount = 0
+#define ROVER_COMPONENT(...) + 1
+#include "components.def"
+#undef ROVER_COMPONENT
+    ;
+
+static constexpr std::array<ComponentSpec, kBuiltinComponentCount> kComponentSpecs = {{
+#define ROVER_COMPONENT(name, priority, nominal, initial, essential, boot_s, boot_factor, warm_w, warmup_s, modes) \
+    {#name, ComponentPriority::priority, nominal, initial, essential, {boot_s, boot_factor, warm_w, warmup_s}, modes},
+#include "components.def"
+#undef ROVER_COMPONENT
+}};
+
+constexpr size_t componentIndex(ComponentId id) {
+    return static_cast<size_t>(id);
+}
+
+// Zrzut w LOW_POWER mimo priorytetu innego niż LOW (dawniej porównanie nazwy „cameras”)
+constexpr bool specShedInLowPower(const ComponentSpec& spec) {
+    return spec.priority != ComponentPriority::LOW && (spec.mode_mask & MODE_L) == 0;
+}
+
+// Maska włączenia trybu po bitach komponentów wbudowanych
+constexpr uint32_t specModeEnableMask(PowerMode mode) {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kBuiltinComponentCount; ++i) {
+        if (kComponentSpecs[i].mode_mask & modeBit(mode)) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+// Kolejność przydziału: stabilnie wg priorytetu, jak ComponentRegistry::rebuild()
+constexpr std::array<uint8_t, kBuiltinComponentCount> specAllocationOrder() {
+    std::array<uint8_t, kBuiltinComponentCount> order{};
+    for (size_t i = 0; i < kBuiltinComponentCount; ++i) {
+        size_t k = i;
+        while (k > 0 && kComponentSpecs[order[k - 1]].priority > kComponentSpecs[i].priority) {
+            order[k] = order[k - 1];
+            --k;
+        }
+        order[k] = static_cast<uint8_t>(i);
+    }
+    return order;
+}
+
+static constexpr std::array<uint32_t, kPowerModeCount> kBuiltinModeMasks = {
+    specModeEnableMask(PowerMode::NORMAL), specModeEnableMask(PowerMode::LOW_POWER),
+    specModeEnableMask(PowerMode::HIBERNATION), specModeEnableMask(PowerMode::EMERGENCY),
+    specModeEnableMask(PowerMode::DUST_STORM)};
+
+static constexpr std::array<uint8_t, kBuiltinComponentCount> kBuiltinAllocationOrder = specAllocationOrder();
+
+// Sprawdzenia spójności specyfikacji
+constexpr bool specNamesEqual(const char* a, const char* b) {
+    while (*a && *a == *b) {
+        ++a;
+        ++b;
+    }
+    return *a == *b;
+}
+
+constexpr bool specNamesUnique() {
+    for (size_t i = 0; i < kBuiltinComponentCount; ++i) {
+        for (size_t j = i + 1; j < kBuiltinComponentCount; ++j) {
+            if (specNamesEqual(kComponentSpecs[i].name, kComponentSpecs[j].name)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+constexpr bool specPowersValid() {
+    for (const auto& spec : kComponentSpecs) {
+        if (!(spec.nominal_power > 0.0f) || spec.initial_power < 0.0f || spec.initial_power > spec.nominal_power ||
+            spec.transition.boot_power_factor < 1.0f || spec.transition.boot_time_s < 0.0f ||
+            spec.transition.warm_power < 0.0f || spec.transition.warmup_time_s < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Tryby zagnieżdżone: EMERGENCY ⊆ HIBERNATION ⊆ LOW_POWER ⊆ NORMAL = wszystkie
+// oraz EMERGENCY ⊆ DUST_STORM ⊆ LOW_POWER (burza zamienia jazdę na grzanie).
+constexpr bool specModesNested() {
+    uint32_t all = (1u << kBuiltinComponentCount) - 1;
+    const auto& m = kBuiltinModeMasks;
+    return m[0] == all && (m[1] & ~m[0]) == 0 && (m[2] & ~m[1]) == 0 && (m[3] & ~m[2]) == 0 &&
+           (m[3] & ~m[4]) == 0 && (m[4] & ~m[1]) == 0;
+}
+
+// Reguły priorytetów: CRITICAL zawsze włączony, w HIBERNATION tylko krytyczne i niezbędne,
+// w EMERGENCY tylko krytyczne, komponenty LOW poza NORMAL wyłączone.
+constexpr bool specModesMatchPriorities() {
+    for (const auto& spec : kComponentSpecs) {
+        bool critical = spec.priority == ComponentPriority::CRITICAL;
+        if (critical && spec.mode_mask != (MODE_N | MODE_L | MODE_H | MODE_E | MODE_D)) {
+            return false;
+        }
+        if (((spec.mode_mask & MODE_H) != 0) != (critical || spec.is_essential)) {
+            return false;
+        }
+        if (((spec.mode_mask & MODE_E) != 0) != critical) {
+            return false;
+        }
+        if (spec.priority == ComponentPriority::LOW && (spec.mode_mask & MODE_L) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(kBuiltinComponentCount > 0, "components.def declares no components");
+static_assert(kBuiltinComponentCount <= kMaxComponents, "components.def exceeds kMaxComponents");
+static_assert(specNamesUnique(), "duplicate component name in components.def");
+static_assert(specPowersValid(), "invalid power or transition values in components.def");
+static_assert(specModesNested(), "mode masks in components.def must be nested NORMAL > LOW_POWER > HIBERNATION > EMERGENCY "
+                                "and LOW_POWER > DUST_STORM > EMERGENCY");
+static_assert(specModesMatchPriorities(), "mode masks in components.def contradict component priorities");
+
+}
+
+#endif // COMPONENT_TABLE_HPP
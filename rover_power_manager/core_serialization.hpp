@@ -0,0 +1,248 @@
+#ifndef CORE_SERIALIZATION_HPP
+#define CORE_SERIALIZATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "energy_core.hpp"
+#include "telemetry_codec.hpp"
+
+namespace rover_energy {
+
+// Zapis CoreState pole po polu (little-endian, bez bajtów wyrównania), więc ten sam
+// stan daje zawsze te same bajty i ten sam skrót. Zapisywane są tylko aktywne komponenty.
+static constexpr uint8_t kCoreStateFormat = 4;
+
+class CoreStateWriter {
+public:
+    explicit CoreStateWriter(std::vector<uint8_t>& out)
+        : out_(out) {}
+
+    void u8(uint8_t v) { out_.push_back(v); }
+
+    void u32(uint32_t v) {
+        size_t at = out_.size();
+        out_.resize(at + 4);
+        writeU32(out_.data() + at, v);
+    }
+
+    void f32(float v) {
+        uint32_t bits;
+        std::memcpy(&bits, &v, 4);
+        u32(bits);
+    }
+
+    void f64(double v) {
+        uint64_t bits;
+        std::memcpy(&bits, &v, 8);
+        u32(static_cast<uint32_t>(bits));
+        u32(static_cast<uint32_t>(bits >> 32));
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+};
+
+class CoreStateReader {
+public:
+    CoreStateReader(const uint8_t* data, size_t len)
+        : p_(data), end_(data + len) {}
+
+    bool ok() const { return ok_; }
+    bool atEnd() const { return p_ == end_; }
+
+    uint8_t u8() { return need(1) ? *p_++ : 0; }
+
+    uint32_t u32() {
+        if (!need(4)) {
+            return 0;
+        }
+        uint32_t v = readU32(p_);
+        p_ += 4;
+        return v;
+    }
+
+    float f32() {
+        uint32_t bits = u32();
+        float v;
+        std::memcpy(&v, &bits, 4);
+        return v;
+    }
+
+    double f64() {
+        uint64_t bits = u32();
+        bits |= static_cast<uint64_t>(u32()) << 32;
+        double v;
+        std::memcpy(&v, &bits, 8);
+        return v;
+    }
+
+private:
+    bool need(size_t n) {
+        ok_ = ok_ && static_cast<size_t>(end_ - p_) >= n;
+        return ok_;
+    }
+
+    const uint8_t* p_;
+    const uint8_t* end_;
+    bool ok_ = true;
+};
+
+inline void serializeThresholds(CoreStateWriter& w, const ModeThresholds& t) {
+    w.f32(t.emergency_soc);
+    w.f32(t.hibernation_solar_w);
+    w.f32(t.hibernation_soc);
+    w.f32(t.low_power_soc);
+    w.f32(t.low_power_balance_w);
+    w.f32(t.normal_soc);
+    w.f32(t.normal_balance_w);
+    w.f32(t.min_dwell_s);
+}
+
+inline void deserializeThresholds(CoreStateReader& r, ModeThresholds& t) {
+    t.emergency_soc = r.f32();
+    t.hibernation_solar_w = r.f32();
+    t.hibernation_soc = r.f32();
+    t.low_power_soc = r.f32();
+    t.low_power_balance_w = r.f32();
+    t.normal_soc = r.f32();
+    t.normal_balance_w = r.f32();
+    t.min_dwell_s = r.f32();
+}
+
+inline void serializeCoreState(const CoreState& s, std::vector<uint8_t>& out) {
+    out.clear();
+    CoreStateWriter w(out);
+    w.u8(kCoreStateFormat);
+    w.f64(s.time_s);
+
+    const EnergyState& e = s.energy;
+    w.f32(e.battery_soc);
+    w.f32(e.voltage);
+    w.f32(e.current);
+    w.f32(e.power_consumption);
+    w.f32(e.solar_generation);
+    w.f32(e.temperature);
+    w.u8(static_cast<uint8_t>(e.mode));
+
+    w.u8(s.component_count);
+    for (size_t i = 0; i < s.component_count; ++i) {
+        const CoreComponent& c = s.components[i];
+        w.u8(static_cast<uint8_t>(c.priority));
+        w.f32(c.nominal_power);
+        w.f32(c.current_power);
+        w.u8(static_cast<uint8_t>(c.is_enabled | c.is_essential << 1 | c.shed_in_low_power << 2 |
+                                  c.mode_enabled << 3));
+        w.f32(c.duty_cycle);
+        w.u8(static_cast<uint8_t>(c.power_state));
+        w.f32(c.state_time_s);
+        w.f32(c.transition.boot_time_s);
+        w.f32(c.transition.boot_power_factor);
+        w.f32(c.transition.warm_power);
+        w.f32(c.transition.warmup_time_s);
+        w.u32(c.dependency_mask);
+        w.u8(c.mode_mask);
+        w.u8(s.allocation_order[i]);
+    }
+
+    const ModeMachineState& m = s.mode;
+    w.u8(static_cast<uint8_t>(m.mode));
+    w.u8(static_cast<uint8_t>(m.planned_mode));
+    w.u8(m.plan_valid);
+    w.f32(m.plan_age_s);
+    w.f32(m.flexible_budget_w);
+    serializeThresholds(w, m.thresholds);
+    w.f32(m.time_in_mode_s);
+    w.u32(m.transitions);
+    w.u8(m.dust_storm);
+
+    w.f32(s.battery.capacity_wh);
+    w.f32(s.battery.solar_calibration);
+    w.f32(s.battery.energy_in_wh);
+    w.f32(s.battery.energy_out_wh);
+}
+
+inline bool deserializeCoreState(const uint8_t* data, size_t len, CoreState& s) {
+    CoreStateReader r(data, len);
+    if (r.u8() != kCoreStateFormat) {
+        return false;
+    }
+    s = CoreState{};
+    s.time_s = r.f64();
+
+    EnergyState& e = s.energy;
+    e.battery_soc = r.f32();
+    e.voltage = r.f32();
+    e.current = r.f32();
+    e.power_consumption = r.f32();
+    e.solar_generation = r.f32();
+    e.temperature = r.f32();
+    e.mode = static_cast<PowerMode>(r.u8());
+
+    s.component_count = r.u8();
+    if (s.component_count > kMaxComponents) {
+        return false;
+    }
+    for (size_t i = 0; i < s.component_count; ++i) {
+        CoreComponent& c = s.components[i];
+        c.priority = static_cast<ComponentPriority>(r.u8());
+        c.nominal_power = r.f32();
+        c.current_power = r.f32();
+        uint8_t flags = r.u8();
+        c.is_enabled = flags & 1;
+        c.is_essential = flags & 2;
+        c.shed_in_low_power = flags & 4;
+        c.mode_enabled = flags & 8;
+        c.duty_cycle = r.f32();
+        c.power_state = static_cast<ComponentPowerState>(r.u8());
+        c.state_time_s = r.f32();
+        c.transition.boot_time_s = r.f32();
+        c.transition.boot_power_factor = r.f32();
+        c.transition.warm_power = r.f32();
+        c.transition.warmup_time_s = r.f32();
+        c.dependency_mask = r.u32();
+        c.mode_mask = r.u8();
+        s.allocation_order[i] = r.u8();
+    }
+    s.mode_masks = buildModeMasks(s.components.data(), s.component_count);
+
+    ModeMachineState& m = s.mode;
+    m.mode = static_cast<PowerMode>(r.u8());
+    m.planned_mode = static_cast<PowerMode>(r.u8());
+    m.plan_valid = r.u8() != 0;
+    m.plan_age_s = r.f32();
+    m.flexible_budget_w = r.f32();
+    deserializeThresholds(r, m.thresholds);
+    m.time_in_mode_s = r.f32();
+    m.transitions = r.u32();
+    m.dust_storm = r.u8() != 0;
+
+    s.battery.capacity_wh = r.f32();
+    s.battery.solar_calibration = r.f32();
+    s.battery.energy_in_wh = r.f32();
+    s.battery.energy_out_wh = r.f32();
+    return r.ok() && r.atEnd();
+}
+
+// FNV-1a 64; bajty z serializeCoreState() albo surowe próbki wejść.
+static constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+static constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+inline uint64_t fnv1a64(const void* data, size_t len, uint64_t hash = kFnvOffset) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ p[i]) * kFnvPrime;
+    }
+    return hash;
+}
+
+inline uint64_t hashCoreState(const CoreState& s, std::vector<uint8_t>& scratch) {
+    serializeCoreState(s, scratch);
+    return fnv1a64(scratch.data(), scratch.size());
+}
+
+}
+
+#endif // CORE_SERIALIZATION_HPP
@@ -0,0 +1,34 @@
+#ifndef DEFAULT_COMPONENTS_HPP
+#define DEFAULT_COMPONENTS_HPP
+
+#include <vector>
+
+#include "component_table.hpp"
+#include "power_types.hpp"
+
+namespace rover_energy {
+
+// Wbudowana tabela komponentów; wspólna dla węzła i narzędzi offline. Dane pochodzą
+// z tabel constexpr (components.def), tu tylko kopiowane do tabeli roboczej z nazwami.
+inline std::vector<PowerComponent> defaultComponents() {
+    std::vector<PowerComponent> components(kBuiltinComponentCount);
+    for (size_t i = 0; i < kBuiltinComponentCount; ++i) {
+        const ComponentSpec& spec = kComponentSpecs[i];
+        PowerComponent& comp = components[i];
+        comp.name = spec.name;
+        comp.priority = spec.priority;
+        comp.nominal_power = spec.nominal_power;
+        comp.current_power = spec.initial_power;
+        comp.is_enabled = true;
+        comp.mode_enabled = true;
+        comp.is_essential = spec.is_essential;
+        comp.transition = spec.transition;
+        comp.shed_in_low_power = specShedInLowPower(spec);
+        comp.mode_mask = spec.mode_mask;
+    }
+    return components;
+}
+
+}
+
+#endif // DEFAULT_COMPONENTS_HPP
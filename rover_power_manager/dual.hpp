@@ -0,0 +1,172 @@
+#ifndef DUAL_HPP
+#define DUAL_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+namespace rover_energy {
+
+// Liczba dualna do różniczkowania w przód: wartość + N pochodnych cząstkowych.
+// Jeden przebieg symulacji na Dual<double, N> daje gradient względem N parametrów
+// (zamiast 2N przebiegów różnic skończonych). Porównania patrzą tylko na wartość,
+// więc gałęzie (zmiany trybu, stany komponentów) mają pochodną zero po ścieżce.
+template <typename T, size_t N>
+struct Dual {
+    T value{};
+    std::array<T, N> d{};
+
+    Dual() = default;
+
+    // Stała: pochodne zero. Niejawna, żeby literały i pola float mieszały się z Dual.
+    template <typename U, typename = std::enable_if_t<std::is_arithmetic<U>::value>>
+    Dual(U v)
+        : value(static_cast<T>(v)) {}
+
+    // Zmienna niezależna o indeksie i
+    static Dual variable(T v, size_t i) {
+        Dual x(v);
+        x.d[i] = T(1);
+        return x;
+    }
+
+    Dual& operator+=(const Dual& o) {
+        value += o.value;
+        for (size_t i = 0; i < N; ++i) d[i] += o.d[i];
+        return *this;
+    }
+
+    Dual& operator-=(const Dual& o) {
+        value -= o.value;
+        for (size_t i = 0; i < N; ++i) d[i] -= o.d[i];
+        return *this;
+    }
+
+    Dual& operator*=(const Dual& o) {
+        for (size_t i = 0; i < N; ++i) d[i] = d[i] * o.value + value * o.d[i];
+        value *= o.value;
+        return *this;
+    }
+
+    Dual& operator/=(const Dual& o) {
+        T inv = T(1) / o.value;
+        for (size_t i = 0; i < N; ++i) d[i] = (d[i] - value * inv * o.d[i]) * inv;
+        value *= inv;
+        return *this;
+    }
+
+    // Jawna konwersja do skalara gubi pochodne (np. zapis do pola float).
+    template <typename U, typename = std::enable_if_t<std::is_arithmetic<U>::value>>
+    explicit operator U() const { return static_cast<U>(value); }
+};
+
+template <typename T>
+struct IsDual : std::false_type {};
+
+template <typename T, size_t N>
+struct IsDual<Dual<T, N>> : std::true_type {};
+
+template <typename T, size_t N>
+inline Dual<T, N> operator-(Dual<T, N> a) {
+    a.value = -a.value;
+    for (auto& x : a.d) x = -x;
+    return a;
+}
+
+template <typename T, size_t N> inline Dual<T, N> operator+(Dual<T, N> a, const Dual<T, N>& b) { return a += b; }
+template <typename T, size_t N> inline Dual<T, N> operator-(Dual<T, N> a, const Dual<T, N>& b) { return a -= b; }
+template <typename T, size_t N> inline Dual<T, N> operator*(Dual<T, N> a, const Dual<T, N>& b) { return a *= b; }
+template <typename T, size_t N> inline Dual<T, N> operator/(Dual<T, N> a, const Dual<T, N>& b) { return a /= b; }
+
+// Operacje ze skalarem bez rozwijania skalara do pełnej liczby dualnej.
+template <typename T, size_t N, typename U, typename = std::enable_if_t<std::is_arithmetic<U>::value>>
+inline Dual<T, N> operator+(Dual<T, N> a, U b) { a.value += static_cast<T>(b); return a; }
+template <typename T, size_t N, typename U, typename = std::enable_if_t<std::is_arithmetic<U>::value>>
+inline Dual<T, N> operator+(U a, Dual<T, N> b) { b.value += static_cast<T>(a); return b; }
+template <typename T, size_t N, typename U, typename = std::enable_if_t<std::is_arithmetic<U>::value>>
+inline Dual<T, N> operator-(Dual<T, N> a, U b) { a.value -= static_cast<T>(b); return a; }
+template <typename T, size_t N, typename U, typename = std::enable_if_t<std::is_arithmetic<U>::value>>
+inline Dual<T, N> operator-(U a, const Dual<T, N>& b) { return -b + a; }
+
+template <typename T, size_t N, typename U, typename = std::enable_if_t<std::is_arithmetic<U>::value>>
+inline Dual<T, N> operator*(Dual<T, N> a, U b) {
+    T s = static_cast<T>(b);
+    a.value *= s;
+    for (auto& x : a.d) x *= s;
+    return a;
+}
+
+template <typename T, size_t N, typename U, typename = std::enable_if_t<std::is_arithmetic<U>::value>>
+inline Dual<T, N> operator*(U a, const Dual<T, N>& b) { return b * a; }
+
+template <typename T, size_t N, typename U, typename = std::enable_if_t<std::is_arithmetic<U>::value>>
+inline Dual<T, N> operator/(const Dual<T, N>& a, U b) { return a * (T(1) / static_cast<T>(b)); }
+
+template <typename T, size_t N, typename U, typename = std::enable_if_t<std::is_arithmetic<U>::value>>
+inline Dual<T, N> operator/(U a, const Dual<T, N>& b) { return Dual<T, N>(a) / b; }
+
+template <typename T, size_t N, typename U, typename = std::enable_if_t<std::is_arithmetic<U>::value>>
+inline Dual<T, N>& operator+=(Dual<T, N>& a, U b) { a.value += static_cast<T>(b); return a; }
+template <typename T, size_t N, typename U, typename = std::enable_if_t<std::is_arithmetic<U>::value>>
+inline Dual<T, N>& operator-=(Dual<T, N>& a, U b) { a.value -= static_cast<T>(b); return a; }
+
+template <typename T>
+inline auto primalValue(const T& x) -> std::enable_if_t<std::is_arithmetic<T>::value, T> { return x; }
+
+template <typename T, size_t N>
+inline T primalValue(const Dual<T, N>& x) { return x.value; }
+
+#define ROVER_ENERGY_DUAL_COMPARE(op)                                                                    \
+    template <typename A, typename B,                                                                    \
+              typename = std::enable_if_t<IsDual<A>::value || IsDual<B>::value>>                         \
+    inline bool operator op(const A& a, const B& b) { return primalValue(a) op primalValue(b); }
+
+ROVER_ENERGY_DUAL_COMPARE(<)
+ROVER_ENERGY_DUAL_COMPARE(<=)
+ROVER_ENERGY_DUAL_COMPARE(>)
+ROVER_ENERGY_DUAL_COMPARE(>=)
+ROVER_ENERGY_DUAL_COMPARE(==)
+ROVER_ENERGY_DUAL_COMPARE(!=)
+
+#undef ROVER_ENERGY_DUAL_COMPARE
+
+// Funkcje elementarne: f(a + b·ε) = f(a) + f'(a)·b·ε
+template <typename T, size_t N>
+inline Dual<T, N> chain(const Dual<T, N>& a, T value, T derivative) {
+    Dual<T, N> r(value);
+    for (size_t i = 0; i < N; ++i) r.d[i] = derivative * a.d[i];
+    return r;
+}
+
+template <typename T, size_t N>
+inline Dual<T, N> exp(const Dual<T, N>& a) {
+    T e = std::exp(a.value);
+    return chain(a, e, e);
+}
+
+template <typename T, size_t N>
+inline Dual<T, N> log(const Dual<T, N>& a) { return chain(a, std::log(a.value), T(1) / a.value); }
+
+template <typename T, size_t N>
+inline Dual<T, N> sqrt(const Dual<T, N>& a) {
+    T s = std::sqrt(a.value);
+    return chain(a, s, s > T(0) ? T(0.5) / s : T(0));
+}
+
+template <typename T, size_t N>
+inline Dual<T, N> sin(const Dual<T, N>& a) { return chain(a, std::sin(a.value), std::cos(a.value)); }
+
+template <typename T, size_t N>
+inline Dual<T, N> cos(const Dual<T, N>& a) { return chain(a, std::cos(a.value), -std::sin(a.value)); }
+
+template <typename T, size_t N>
+inline Dual<T, N> abs(const Dual<T, N>& a) { return a.value < T(0) ? -a : a; }
+
+template <typename T, size_t N>
+inline bool isfinite(const Dual<T, N>& a) { return std::isfinite(a.value); }
+
+}
+
+#endif // DUAL_HPP
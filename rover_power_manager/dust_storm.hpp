@@ -0,0 +1,282 @@
+#ifndef DUST_STORM_HPP
+#define DUST_STORM_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "budget_curve.hpp"
+#include "mars_time.hpp"
+#include "solar_forecast.hpp"
+
+namespace rover_energy {
+
+// Regionalna burza pyłowa: nieprzezroczystość narasta przez kilka soli i opada tygodniami.
+// Chwilowe SOC i generacja tego nie widzą, więc tryb DUST_STORM wynika z trendu
+// dziennych estymat τ z historii generacji, a profil obciążenia z symulacji wielotygodniowej.
+// Estymata jest „efektywna”: zawiera też kurz na panelach i zysk z pochylenia paneli.
+
+static constexpr size_t kOpacityHistorySols = 16;
+static constexpr size_t kStormStepsPerSol = 24;     // godziny marsjańskie
+
+struct DustStormConfig {
+    double entry_opacity = 1.5;         // wejście przy τ >= progu
+    double exit_opacity = 1.0;          // wyjście przy τ <= progu i trendzie nierosnącym
+    double rise_rate = 0.15;            // [τ/sol] trend uznany za narastającą burzę
+    double lookahead_sols = 3.0;        // wejście z wyprzedzeniem, gdy trend doprowadzi τ do progu
+    size_t trend_sols = 5;              // okno regresji [sol]
+    size_t min_trend_sols = 3;
+    double min_sin_elevation = 0.2;     // przy niskim Słońcu pomiar zdominowany przez poświatę
+    size_t min_samples_per_sol = 1800;  // próbek dziennych, żeby sol wszedł do trendu
+    double max_opacity = 6.0;
+    size_t horizon_sols = 42;           // horyzont symulacji przetrwania
+    double max_rise_sols = 10.0;        // najdłuższe narastanie po trendzie przed szczytem [sol]
+    double decay_sols = 30.0;           // zanik burzy po szczycie (e-krotny) [sol]
+    float reserve_soc = 25.0f;          // [%] SOC, poniżej którego profil jest odrzucany
+};
+
+struct OpacityTrend {
+    double opacity = 0.0;       // τ w ostatnim zamkniętym solu (z regresji)
+    double slope = 0.0;         // [τ/sol]
+    size_t sols = 0;            // soli w regresji
+    int64_t last_sol = 0;
+};
+
+// Dzienne estymaty τ z odwrócenia modelu panelu (ważone wysokością Słońca)
+// i regresja liniowa z ostatnich trend_sols soli z histerezą wejścia i wyjścia.
+class DustStormMonitor {
+public:
+    DustStormMonitor(const DustStormConfig& config, const SolarArrayModel& model)
+        : config_(config), model_(model) {}
+
+    const DustStormConfig& config() const { return config_; }
+    const OpacityTrend& trend() const { return trend_; }
+    bool active() const { return active_; }
+    double baselineOpacity() const { return model_.optical_depth; }
+
+    // Zwraca true, gdy zamknięto sol i trend lub stan burzy mogły się zmienić.
+    bool addSample(int64_t local_sol, float measured_w, double toa, double sin_elevation) {
+        bool closed = false;
+        if (local_sol != sol_) {
+            closed = closeSol();
+            sol_ = local_sol;
+        }
+        if (sin_elevation >= config_.min_sin_elevation) {
+            double tau = opacityFromPower(model_, toa, sin_elevation, measured_w, config_.max_opacity);
+            if (std::isfinite(tau)) {
+                weighted_sum_ += sin_elevation * tau;
+                weight_ += sin_elevation;
+                ++samples_;
+            }
+        }
+        return closed;
+    }
+
+    // τ za sols_ahead soli: narastanie po trendzie najwyżej max_rise_sols soli (i do max_opacity),
+    // potem szczyt i zanik e-krotny z decay_sols do τ modelu. Bez ograniczenia narastania
+    // rosnący trend trzymałby τ na max_opacity przez cały horyzont.
+    double projectedOpacity(double sols_ahead) const {
+        if (trend_.sols == 0) {
+            return model_.optical_depth;
+        }
+        double baseline = model_.optical_depth;
+        double peak = trend_.opacity;
+        double peak_sols = 0.0;
+        if (trend_.slope > 0.0) {
+            peak_sols = std::clamp((config_.max_opacity - trend_.opacity) / trend_.slope, 0.0, config_.max_rise_sols);
+            if (sols_ahead < peak_sols) {
+                return std::clamp(trend_.opacity + trend_.slope * sols_ahead, baseline, config_.max_opacity);
+            }
+            peak = std::min(trend_.opacity + trend_.slope * peak_sols, config_.max_opacity);
+        }
+        double excess = std::max(0.0, peak - baseline);
+        return baseline + excess * std::exp(-(sols_ahead - peak_sols) / config_.decay_sols);
+    }
+
+private:
+    bool closeSol() {
+        bool complete = samples_ >= config_.min_samples_per_sol && weight_ > 0.0;
+        if (complete) {
+            history_[head_] = {sol_, weighted_sum_ / weight_};
+            head_ = (head_ + 1) % kOpacityHistorySols;
+            count_ = std::min(count_ + 1, kOpacityHistorySols);
+            updateTrend();
+            updateState();
+        }
+        weighted_sum_ = 0.0;
+        weight_ = 0.0;
+        samples_ = 0;
+        return complete;
+    }
+
+    // Najmniejsze kwadraty τ(sol) na ostatnich punktach; x względem ostatniego sola,
+    // więc wyraz wolny to τ „teraz”. Luki w solach nie przeszkadzają.
+    void updateTrend() {
+        size_t n = std::min(count_, config_.trend_sols);
+        const SolOpacity& last = history_[(head_ + kOpacityHistorySols - 1) % kOpacityHistorySols];
+        trend_.last_sol = last.sol;
+        trend_.sols = n;
+        if (n < std::max<size_t>(config_.min_trend_sols, 2)) {
+            trend_.opacity = last.opacity;
+            trend_.slope = 0.0;
+            return;
+        }
+        double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+        for (size_t k = 0; k < n; ++k) {
+            const SolOpacity& p = history_[(head_ + kOpacityHistorySols - 1 - k) % kOpacityHistorySols];
+            double x = static_cast<double>(p.sol - last.sol);
+            sx += x;
+            sy += p.opacity;
+            sxx += x * x;
+            sxy += x * p.opacity;
+        }
+        double denom = n * sxx - sx * sx;
+        trend_.slope = denom > 0.0 ? (n * sxy - sx * sy) / denom : 0.0;
+        trend_.opacity = std::clamp((sy - trend_.slope * sx) / n, 0.0, config_.max_opacity);
+    }
+
+    void updateState() {
+        const OpacityTrend& t = trend_;
+        if (!active_) {
+            bool high = t.opacity >= config_.entry_opacity;
+            bool rising = t.sols >= config_.min_trend_sols && t.slope >= config_.rise_rate &&
+                          t.opacity + t.slope * config_.lookahead_sols >= config_.entry_opacity;
+            active_ = high || rising;
+        } else if (t.opacity <= config_.exit_opacity && t.slope <= 0.0) {
+            active_ = false;
+        }
+    }
+
+    struct SolOpacity {
+        int64_t sol;
+        double opacity;
+    };
+
+    DustStormConfig config_;
+    SolarArrayModel model_;
+    std::array<SolOpacity, kOpacityHistorySols> history_{};
+    size_t head_ = 0;
+    size_t count_ = 0;
+    int64_t sol_ = INT64_MIN;
+    double weighted_sum_ = 0.0;
+    double weight_ = 0.0;
+    size_t samples_ = 0;
+    OpacityTrend trend_;
+    bool active_ = false;
+};
+
+struct StormPlanInputs {
+    double unix_seconds;
+    double latitude_deg;
+    double east_longitude_deg;
+    float soc;
+    double battery_capacity_wh;
+    float committed_load_w;     // niezrzucalne obciążenie trybu DUST_STORM
+    float flexible_load_w;      // elastyczne obciążenie trybu DUST_STORM (grzanie)
+    float thermal_floor_w = 0.0f;   // grzanie przetrwania: części elastycznej poniżej tego nie zrzucamy
+};
+
+struct StormPlan {
+    float flexible_fraction = 1.0f;     // wybrany profil: część obciążenia elastycznego
+    float flexible_budget_w = 0.0f;
+    float min_soc = 100.0f;             // [%] przy wybranym profilu
+    float min_soc_sols = 0.0f;          // kiedy [sol od teraz]
+    float final_opacity = 0.0f;         // τ na końcu horyzontu
+    bool survives = true;               // rezerwa utrzymana przy obciążeniu elastycznym = progu cieplnym
+    double solve_us = 0.0;
+};
+
+// Bilans energii co godzinę marsjańską przez horizon_sols soli przy τ z projekcji trendu.
+// Generacja liczona raz na plan; profil (część obciążenia elastycznego) wybierany
+// bisekcją, bo minimum SOC maleje monotonicznie z obciążeniem. Budżet nie schodzi poniżej
+// progu cieplnego: bez grzania przetrwania elektronika i tak by nie przetrwała.
+class StormSurvivalPlanner {
+public:
+    static constexpr size_t kBisectionSteps = 20;
+
+    StormSurvivalPlanner(const DustStormConfig& config, const SolarArrayModel& model)
+        : config_(config), model_(model), solar_wh_(config.horizon_sols * kStormStepsPerSol, 0.0f) {}
+
+    const StormPlan& plan() const { return plan_; }
+
+    const StormPlan& update(const DustStormMonitor& monitor, const StormPlanInputs& inputs) {
+        auto start = std::chrono::steady_clock::now();
+        fillSolar(monitor, inputs);
+
+        size_t min_step = 0;
+        float floor = inputs.flexible_load_w > 0.0f
+                    ? std::clamp(inputs.thermal_floor_w / inputs.flexible_load_w, 0.0f, 1.0f) : 0.0f;
+        plan_.survives = simulate(inputs, floor * inputs.flexible_load_w, min_step) >= config_.reserve_soc;
+        float fraction = floor;
+        if (simulate(inputs, inputs.flexible_load_w, min_step) >= config_.reserve_soc) {
+            fraction = 1.0f;
+        } else if (plan_.survives) {
+            float low = floor;
+            float high = 1.0f;
+            for (size_t k = 0; k < kBisectionSteps; ++k) {
+                float mid = 0.5f * (low + high);
+                if (simulate(inputs, mid * inputs.flexible_load_w, min_step) >= config_.reserve_soc) {
+                    low = mid;
+                } else {
+                    high = mid;
+                }
+            }
+            fraction = low;
+        }
+        plan_.flexible_fraction = fraction;
+        plan_.flexible_budget_w = fraction * inputs.flexible_load_w;
+        plan_.min_soc = simulate(inputs, plan_.flexible_budget_w, min_step);
+        plan_.min_soc_sols = static_cast<float>(min_step / static_cast<double>(kStormStepsPerSol));
+        plan_.final_opacity = static_cast<float>(monitor.projectedOpacity(static_cast<double>(config_.horizon_sols)));
+        plan_.solve_us = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - start).count();
+        return plan_;
+    }
+
+private:
+    // Sol k: geometria z czasu start + k soli, τ z projekcji w połowie sola.
+    void fillSolar(const DustStormMonitor& monitor, const StormPlanInputs& inputs) {
+        SolarArrayModel model = model_;
+        for (size_t k = 0; k < config_.horizon_sols; ++k) {
+            MarsTime mars_time = marsTimeFromUnix(inputs.unix_seconds + k * kSolSeconds);
+            double ltst = localTrueSolarTime(mars_time, inputs.east_longitude_deg);
+            model.optical_depth = monitor.projectedOpacity(k + 0.5);
+            float* out = solar_wh_.data() + k * kStormStepsPerSol;
+            clearSkyPowerSeries(model, inputs.latitude_deg, mars_time, ltst, 1.0, kStormStepsPerSol, out);
+            for (size_t h = 0; h < kStormStepsPerSol; ++h) {
+                out[h] *= static_cast<float>(kMarsHourHours);
+            }
+        }
+    }
+
+    // Minimalny SOC [%] przy stałym obciążeniu elastycznym flexible_w; min_step to koniec
+    // godziny z minimum (0 = teraz).
+    float simulate(const StormPlanInputs& inputs, float flexible_w, size_t& min_step) const {
+        double load_wh = (inputs.committed_load_w + flexible_w) * kMarsHourHours;
+        double soc_per_wh = 100.0 / inputs.battery_capacity_wh;
+        double soc = inputs.soc;
+        double min_soc = soc;
+        min_step = 0;
+        for (size_t k = 0; k < solar_wh_.size(); ++k) {
+            soc = std::clamp(soc + soc_per_wh * (solar_wh_[k] - load_wh), 0.0, 100.0);
+            if (soc < min_soc) {
+                min_soc = soc;
+                min_step = k + 1;
+            }
+        }
+        return static_cast<float>(min_soc);
+    }
+
+    DustStormConfig config_;
+    SolarArrayModel model_;
+    std::vector<float> solar_wh_;
+    StormPlan plan_;
+};
+
+}
+
+#endif // DUST_STORM_HPP
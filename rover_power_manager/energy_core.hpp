@@ -0,0 +1,490 @@
+#ifndef ENERGY_CORE_HPP
+#define ENERGY_CORE_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "component_power_state.hpp"
+#include "component_registry.hpp"
+#include "power_types.hpp"
+
+namespace rover_energy {
+
+// Plan MPC steruje trybem tylko przez tyle sekund od ostatniego rozwiązania.
+static constexpr float kPlanFreshnessS = 3.0f;
+
+// Logika trybów i przydziału wspólna dla węzła i symulacji bezgłowej.
+
+// rule i threshold opisują regułę, która zadziałała (dla śladu decyzji).
+// dust_storm to stan z DustStormMonitor; burza wyprzedza plan MPC, bo jego horyzont
+// jest krótszy niż burza.
+template <typename Scalar>
+inline PowerMode selectMode(const ModeThresholds& t, PowerMode current_mode, bool dust_storm, bool plan_fresh,
+                            PowerMode planned_mode, const Scalar& soc, const Scalar& power_balance,
+                            const Scalar& solar_generation, ModeRule& rule, float& threshold) {
+    threshold = NAN;
+    if (soc < t.emergency_soc) {
+        rule = ModeRule::CRITICAL_SOC;
+        threshold = t.emergency_soc;
+        return PowerMode::EMERGENCY;
+    }
+    if (dust_storm) {
+        rule = ModeRule::DUST_STORM;
+        return PowerMode::DUST_STORM;
+    }
+    if (plan_fresh) {
+        rule = ModeRule::MPC_PLAN;
+        return planned_mode;
+    }
+    if (solar_generation < t.hibernation_solar_w && soc < t.hibernation_soc) {
+        rule = ModeRule::NIGHT_LOW_SOC;
+        threshold = t.hibernation_soc;
+        return PowerMode::HIBERNATION;
+    }
+    if (soc < t.low_power_soc) {
+        rule = ModeRule::LOW_SOC;
+        threshold = t.low_power_soc;
+        return PowerMode::LOW_POWER;
+    }
+    if (power_balance < t.low_power_balance_w) {
+        rule = ModeRule::POWER_DEFICIT;
+        threshold = t.low_power_balance_w;
+        return PowerMode::LOW_POWER;
+    }
+    if (soc > t.normal_soc && power_balance > t.normal_balance_w) {
+        rule = ModeRule::RECOVERED;
+        threshold = t.normal_soc;
+        return PowerMode::NORMAL;
+    }
+    rule = ModeRule::HOLD;
+    return current_mode;
+}
+
+inline bool modeChangeAllowed(const ModeThresholds& t, PowerMode target, float time_in_mode_s) {
+    return target == PowerMode::EMERGENCY || time_in_mode_s >= t.min_dwell_s;
+}
+
+// W EMERGENCY i DUST_STORM zrzucane komponenty gasną od razu (bez podtrzymania WARM).
+inline bool modeAllowsWarmHold(PowerMode mode) {
+    return mode != PowerMode::EMERGENCY && mode != PowerMode::DUST_STORM;
+}
+
+// Przydział wg priorytetu; elastyczne komponenty ogranicza dodatkowo budżet planu.
+template <typename Component, typename Index>
+inline void allocateComponentPower(Component* components, const Index* order, size_t count,
+                                   PowerScalar<Component> available_power,
+                                   PowerScalar<Component> flexible_budget) {
+    for (size_t k = 0; k < count; ++k) {
+        Component& comp = components[order[k]];
+        if (comp.power_state == ComponentPowerState::OFF) {
+            comp.current_power = 0.0f;
+            continue;
+        }
+        bool flexible = comp.priority != ComponentPriority::CRITICAL && !comp.is_essential;
+        PowerScalar<Component> limit = flexible ? std::min(available_power, flexible_budget) : available_power;
+        comp.current_power = std::min(limit, powerStateDemand(comp));
+        available_power -= comp.current_power;
+        if (flexible) {
+            flexible_budget -= comp.current_power;
+        }
+    }
+}
+
+// Rzeczywisty pobór sprzętu niezależnie od przydziału (model instalacji dla symulacji).
+template <typename Component>
+inline PowerScalar<Component> hardwareDraw(const Component* components, size_t count) {
+    PowerScalar<Component> total = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        total += powerStateDemand(components[i]);
+    }
+    return total;
+}
+
+template <typename Component>
+inline PowerScalar<Component> totalPowerConsumption(const Component* components, size_t count) {
+    PowerScalar<Component> total = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        if (components[i].power_state != ComponentPowerState::OFF) {
+            total += components[i].current_power;
+        }
+    }
+    return total;
+}
+
+// Stan komponentu bez nazwy; nazwy i inne metadane są w CoreMetadata.
+// T to typ mocy i energii: float w węźle i symulacji, Dual w analizie wrażliwości.
+template <typename T>
+struct BasicCoreComponent {
+    ComponentPriority priority;
+    T nominal_power;
+    T current_power;
+    bool is_enabled;
+    bool mode_enabled;
+    bool is_essential;
+    bool shed_in_low_power;
+    T duty_cycle;
+    ComponentPowerState power_state;
+    float state_time_s;
+    ComponentTransitionModel transition;
+    uint32_t dependency_mask;
+    uint8_t mode_mask;
+};
+
+using CoreComponent = BasicCoreComponent<float>;
+
+struct ModeMachineState {
+    PowerMode mode;
+    PowerMode planned_mode;
+    bool plan_valid;
+    float plan_age_s;
+    float flexible_budget_w;
+    ModeThresholds thresholds;
+    float time_in_mode_s;
+    uint32_t transitions;
+    bool dust_storm;                // stały w symulacji; w burzy flexible_budget_w to budżet przetrwania
+};
+
+// Estymator baterii symulacji: całkowanie bilansu mocy (w węźle SOC pochodzi z napięcia).
+template <typename T>
+struct BasicBatteryEstimator {
+    T capacity_wh;
+    T solar_calibration;        // współczynnik SolarForecaster w chwili zrzutu
+    T energy_in_wh;
+    T energy_out_wh;
+};
+
+using BatteryEstimator = BasicBatteryEstimator<float>;
+
+template <typename T>
+struct BasicCoreState {
+    double time_s;
+    BasicEnergyState<T> energy;
+    std::array<BasicCoreComponent<T>, kMaxComponents> components;
+    std::array<uint8_t, kMaxComponents> allocation_order;
+    uint8_t component_count;
+    ModeEnableMasks mode_masks;         // z masek trybów komponentów, liczone przy zrzucie
+    ModeMachineState mode;
+    BasicBatteryEstimator<T> battery;
+};
+
+using CoreState = BasicCoreState<float>;
+
+// Zmiana typu liczbowego stanu (np. float -> Dual przed analizą wrażliwości).
+template <typename To, typename From>
+inline BasicCoreState<To> castCoreState(const BasicCoreState<From>& s) {
+    BasicCoreState<To> r{};
+    r.time_s = s.time_s;
+    r.energy = {static_cast<To>(s.energy.battery_soc), static_cast<To>(s.energy.voltage),
+                static_cast<To>(s.energy.current), static_cast<To>(s.energy.power_consumption),
+                static_cast<To>(s.energy.solar_generation), static_cast<To>(s.energy.temperature), s.energy.mode};
+    for (size_t i = 0; i < kMaxComponents; ++i) {
+        const BasicCoreComponent<From>& c = s.components[i];
+        r.components[i] = {c.priority, static_cast<To>(c.nominal_power), static_cast<To>(c.current_power),
+                           c.is_enabled, c.mode_enabled, c.is_essential, c.shed_in_low_power,
+                           static_cast<To>(c.duty_cycle),
+                           c.power_state, c.state_time_s, c.transition, c.dependency_mask, c.mode_mask};
+    }
+    r.allocation_order = s.allocation_order;
+    r.component_count = s.component_count;
+    r.mode_masks = s.mode_masks;
+    r.mode = s.mode;
+    r.battery = {static_cast<To>(s.battery.capacity_wh), static_cast<To>(s.battery.solar_calibration),
+                 static_cast<To>(s.battery.energy_in_wh), static_cast<To>(s.battery.energy_out_wh)};
+    return r;
+}
+
+static_assert(std::is_trivially_copyable<CoreState>::value, "CoreState must be memcpy-able");
+
+struct CoreMetadata {
+    std::vector<std::string> names;
+    size_t heating_index = SIZE_MAX;
+
+    size_t find(const std::string& name) const {
+        auto it = std::find(names.begin(), names.end(), name);
+        return it == names.end() ? SIZE_MAX : static_cast<size_t>(it - names.begin());
+    }
+};
+
+struct HistorySample {
+    double time_s;          // [s] czas Unix; float miałby tu rozdzielczość 128 s
+    float soc;
+    float power_consumption;
+    float solar_generation;
+    PowerMode mode;
+};
+
+static constexpr size_t kHistoryChunkSamples = 256;
+
+struct HistoryChunk {
+    std::array<HistorySample, kHistoryChunkSamples> samples;
+    size_t count = 0;
+};
+
+static constexpr uint32_t kNoHistoryChunk = UINT32_MAX;
+static constexpr size_t kHistorySpareChunks = 8;       // ogony po rozwidleniu i fragmenty trzymane przez kopie
+static constexpr size_t kDefaultHistoryChunks = 64;    // gdy History() dostaje pierwszą próbkę
+
+// Pula fragmentów alokowana raz; fragmenty adresowane indeksem z licznikiem referencji.
+// Liczniki są atomowe, bo kopie historii (punkty kontrolne) bywają zwalniane poza wątkiem,
+// który dopisuje; fragment z licznikiem 0 jest wolny.
+class HistoryChunkPool {
+public:
+    explicit HistoryChunkPool(size_t chunks)
+        : chunks_(new HistoryChunk[chunks]), refs_(new std::atomic<uint32_t>[chunks]), size_(chunks) {
+        for (size_t i = 0; i < size_; ++i) {
+            refs_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Wolny fragment z licznikiem 1 albo kNoHistoryChunk, gdy wszystkie są w użyciu.
+    uint32_t acquire() {
+        size_t start = hint_.load(std::memory_order_relaxed);
+        for (size_t n = 0; n < size_; ++n) {
+            size_t i = (start + n) % size_;
+            uint32_t expected = 0;
+            if (refs_[i].compare_exchange_strong(expected, 1, std::memory_order_acquire)) {
+                hint_.store((i + 1) % size_, std::memory_order_relaxed);
+                chunks_[i].count = 0;
+                return static_cast<uint32_t>(i);
+            }
+        }
+        return kNoHistoryChunk;
+    }
+
+    void retain(uint32_t i) { refs_[i].fetch_add(1, std::memory_order_relaxed); }
+    void release(uint32_t i) { refs_[i].fetch_sub(1, std::memory_order_acq_rel); }
+    bool shared(uint32_t i) const { return refs_[i].load(std::memory_order_acquire) > 1; }
+
+    HistoryChunk& operator[](uint32_t i) { return chunks_[i]; }
+    const HistoryChunk& operator[](uint32_t i) const { return chunks_[i]; }
+
+private:
+    std::unique_ptr<HistoryChunk[]> chunks_;
+    std::unique_ptr<std::atomic<uint32_t>[]> refs_;
+    size_t size_;
+    std::atomic<size_t> hint_{0};
+};
+
+// Historia dzielona między gałęziami (copy-on-write) na puli fragmentów: pełne fragmenty
+// są niezmienne i współdzielone, niepełny ogon jest kopiowany do wolnego fragmentu puli
+// przy pierwszym zapisie po rozwidleniu. Pierścień indeksów ma stałą pojemność, więc
+// append() nie alokuje; kopia History kopiuje pierścień i podbija liczniki fragmentów.
+class History {
+public:
+    History() = default;
+
+    explicit History(size_t max_chunks)
+        : pool_(std::make_shared<HistoryChunkPool>(max_chunks + 1 + kHistorySpareChunks)),
+          ring_(max_chunks, kNoHistoryChunk) {}
+
+    History(const History& other)
+        : pool_(other.pool_), ring_(other.ring_), head_(other.head_), sealed_(other.sealed_),
+          tail_(other.tail_) {
+        forEachChunk([this](uint32_t i) { pool_->retain(i); });
+    }
+
+    History(History&& other) noexcept { swap(other); }
+
+    History& operator=(History other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~History() {
+        forEachChunk([this](uint32_t i) { pool_->release(i); });
+    }
+
+    void swap(History& other) noexcept {
+        std::swap(pool_, other.pool_);
+        std::swap(ring_, other.ring_);
+        std::swap(head_, other.head_);
+        std::swap(sealed_, other.sealed_);
+        std::swap(tail_, other.tail_);
+    }
+
+    // false, gdy pula jest wyczerpana przez kopie trzymające stare fragmenty (próbka pominięta).
+    bool append(const HistorySample& sample) {
+        if (!pool_) {
+            *this = History(kDefaultHistoryChunks);
+        }
+        if (tail_ == kNoHistoryChunk || (*pool_)[tail_].count == kHistoryChunkSamples) {
+            if (!seal()) {
+                return false;
+            }
+        } else if (pool_->shared(tail_)) {
+            uint32_t copy = pool_->acquire();
+            if (copy == kNoHistoryChunk) {
+                return false;
+            }
+            (*pool_)[copy] = (*pool_)[tail_];
+            pool_->release(tail_);
+            tail_ = copy;
+        }
+        HistoryChunk& tail = (*pool_)[tail_];
+        tail.samples[tail.count++] = sample;
+        return true;
+    }
+
+    size_t size() const {
+        return sealed_ * kHistoryChunkSamples + (tail_ != kNoHistoryChunk ? (*pool_)[tail_].count : 0);
+    }
+
+    const HistorySample& operator[](size_t i) const {
+        size_t chunk = i / kHistoryChunkSamples;
+        if (chunk < sealed_) {
+            return (*pool_)[ring_[(head_ + chunk) % ring_.size()]].samples[i % kHistoryChunkSamples];
+        }
+        return (*pool_)[tail_].samples[i % kHistoryChunkSamples];
+    }
+
+    const HistorySample* latest() const {
+        if (tail_ == kNoHistoryChunk || (*pool_)[tail_].count == 0) {
+            return nullptr;
+        }
+        const HistoryChunk& tail = (*pool_)[tail_];
+        return &tail.samples[tail.count - 1];
+    }
+
+private:
+    // Pełny ogon trafia do pierścienia (najstarszy fragment zwalniany), nowy ogon z puli.
+    bool seal() {
+        uint32_t next = pool_->acquire();
+        if (next == kNoHistoryChunk) {
+            return false;
+        }
+        if (tail_ != kNoHistoryChunk) {
+            if (ring_.empty()) {
+                pool_->release(tail_);
+            } else if (sealed_ == ring_.size()) {
+                pool_->release(ring_[head_]);
+                ring_[head_] = tail_;
+                head_ = (head_ + 1) % ring_.size();
+            } else {
+                ring_[(head_ + sealed_) % ring_.size()] = tail_;
+                ++sealed_;
+            }
+        }
+        tail_ = next;
+        return true;
+    }
+
+    template <typename F>
+    void forEachChunk(F f) const {
+        for (size_t k = 0; k < sealed_; ++k) {
+            f(ring_[(head_ + k) % ring_.size()]);
+        }
+        if (tail_ != kNoHistoryChunk) {
+            f(tail_);
+        }
+    }
+
+    std::shared_ptr<HistoryChunkPool> pool_;
+    std::vector<uint32_t> ring_;        // indeksy pełnych fragmentów, od head_ najstarszy
+    size_t head_ = 0;
+    size_t sealed_ = 0;
+    uint32_t tail_ = kNoHistoryChunk;
+};
+
+// Punkt kontrolny: stan rdzenia kopiowany memcpy plus współdzielona historia i metadane.
+// fork() kosztuje skopiowanie ~1.5 kB, pierścienia indeksów historii i podbicie jej liczników.
+struct Checkpoint {
+    CoreState state;
+    History history;
+    std::shared_ptr<const CoreMetadata> metadata;
+
+    Checkpoint fork() const { return *this; }
+};
+
+template <typename T>
+struct BasicStepInputs {
+    T solar_w;
+    T extra_load_w;         // obciążenie spoza tabeli komponentów (np. jazda)
+};
+
+using StepInputs = BasicStepInputs<float>;
+
+// Krok symulacji w tej samej kolejności co managementLoop() węzła. Tryb i przydział
+// liczone są jak w węźle (bilans z przydziałów), a bateria całkuje rzeczywisty pobór,
+// bo w węźle SOC pochodzi z pomiaru napięcia.
+template <typename T>
+inline void stepCore(BasicCoreState<T>& s, const BasicStepInputs<T>& inputs, float dt) {
+    BasicCoreComponent<T>* components = s.components.data();
+    size_t count = s.component_count;
+    advancePowerStates(components, count, dt, modeAllowsWarmHold(s.mode.mode));
+
+    s.energy.solar_generation = inputs.solar_w;
+    s.energy.power_consumption = totalPowerConsumption(components, count) + inputs.extra_load_w;
+    T power_balance = s.energy.solar_generation - s.energy.power_consumption;
+
+    s.mode.plan_age_s += dt;
+    s.mode.time_in_mode_s += dt;
+    bool plan_fresh = s.mode.plan_valid && s.mode.plan_age_s < kPlanFreshnessS;
+    ModeRule rule;
+    float threshold;
+    PowerMode target = selectMode(s.mode.thresholds, s.mode.mode, s.mode.dust_storm, plan_fresh,
+                                  s.mode.planned_mode, s.energy.battery_soc, power_balance,
+                                  s.energy.solar_generation, rule, threshold);
+    if (target != s.mode.mode && modeChangeAllowed(s.mode.thresholds, target, s.mode.time_in_mode_s)) {
+        PowerMode from = s.mode.mode;
+        s.mode.mode = target;
+        s.mode.time_in_mode_s = 0.0f;
+        s.energy.mode = target;
+        ++s.mode.transitions;
+        applyModeMask(components, count, s.mode_masks, from, target);
+        applyDependencyMasks(components, count);
+    }
+
+    bool budgeted = plan_fresh || s.mode.dust_storm;
+    allocateComponentPower(components, s.allocation_order.data(), count, s.energy.solar_generation,
+                           budgeted ? T(s.mode.flexible_budget_w) : s.energy.solar_generation);
+
+    T draw = hardwareDraw(components, count) + inputs.extra_load_w;
+    double hours = dt / 3600.0;
+    s.battery.energy_in_wh += static_cast<T>(s.energy.solar_generation * hours);
+    s.battery.energy_out_wh += static_cast<T>(draw * hours);
+    s.energy.current = draw > 0.0f && s.energy.voltage > 0.0f ? T(draw / s.energy.voltage) : T(0.0f);
+    s.energy.battery_soc = std::clamp(
+        s.energy.battery_soc + static_cast<T>(
+            (s.energy.solar_generation - draw) * hours * 100.0 / s.battery.capacity_wh),
+        T(0.0f), T(100.0f));
+    s.time_s += dt;
+}
+
+inline bool recordHistory(Checkpoint& checkpoint) {
+    const CoreState& s = checkpoint.state;
+    return checkpoint.history.append({s.time_s, s.energy.battery_soc,
+                               s.energy.power_consumption, s.energy.solar_generation, s.mode.mode});
+}
+
+// Zrzut tabeli węzła do stanu rdzenia (kolejność przydziału z rejestru).
+inline void captureComponents(const std::vector<PowerComponent>& components,
+                              const std::vector<size_t>& allocation_order, CoreState& state) {
+    size_t count = std::min(components.size(), kMaxComponents);
+    state.component_count = static_cast<uint8_t>(count);
+    for (size_t i = 0; i < count; ++i) {
+        const PowerComponent& comp = components[i];
+        state.components[i] = {comp.priority, comp.nominal_power, comp.current_power,
+                               comp.is_enabled, comp.mode_enabled, comp.is_essential, comp.shed_in_low_power,
+                               comp.duty_cycle, comp.power_state, comp.state_time_s,
+                               comp.transition, comp.dependency_mask, componentModeMask(comp)};
+    }
+    state.mode_masks = buildModeMasks(state.components.data(), count);
+    size_t k = 0;
+    for (size_t index : allocation_order) {
+        if (index < count) {
+            state.allocation_order[k++] = static_cast<uint8_t>(index);
+        }
+    }
+}
+
+}
+
+#endif // ENERGY_CORE_HPP
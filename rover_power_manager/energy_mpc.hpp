@@ -0,0 +1,266 @@
+#ifndef ENERGY_MPC_HPP
+#define ENERGY_MPC_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "mars_time.hpp"
+
+namespace rover_energy {
+
+struct MpcConfig {
+    size_t horizon_steps = 25;
+    double step_hours = kMarsHourHours;     // [h] ziemskie; prognoza idzie po step_hours / kMarsHourHours LTST
+    double battery_capacity_wh = 2000.0;
+    double soc_min = 30.0;
+    double soc_max = 100.0;
+    double soc_terminal = 50.0;
+    double service_weight = 1.0;        // nagroda za obsłużone obciążenie elastyczne
+    double spill_weight = 0.01;         // kara za zmarnowaną generację
+    double smoothness_weight = 0.5;     // kara za skoki decyzji między krokami
+    double admm_rho = 0.1;
+    double admm_sigma = 1e-6;
+    double admm_alpha = 1.6;
+    double tolerance = 1e-3;
+    size_t max_iterations = 500;
+    std::chrono::microseconds time_budget{2000};
+};
+
+struct MpcProblem {
+    float soc;                  // [%]
+    const float* solar_w;       // prognoza generacji na krok
+    const float* reserved_w;    // rezerwacje mocy na krok (jazda, zaplanowane aktywności)
+    float base_load_w;          // obciążenie, którego nie da się zrzucić
+    float flexible_load_w;      // obciążenie zrzucane przez tryby
+};
+
+struct MpcSolution {
+    std::vector<float> service;     // u_k: część obciążenia elastycznego [0, 1]
+    std::vector<float> spill_w;
+    std::vector<float> soc;         // N + 1 punktów
+    float first_step_load_w = 0.0f;
+    size_t iterations = 0;
+    bool converged = false;
+    double solve_us = 0.0;
+};
+
+// QP w horyzoncie kroczącym:
+//   min  sum(-w_u u_k + w_v v_k) + rho_s sum (u_k - u_{k-1})^2
+//   s_k = s_0 + c sum_{j<k} (solar_j - base - res_j) - c F sum_{j<k} (u_j + v_j)
+//   soc_min <= s_k <= soc_max,  s_N >= soc_terminal,  0 <= u <= 1,  0 <= v <= solar/F
+// gdzie v to zmarnowana generacja w jednostkach F. Rozwiązywany ADMM (jak OSQP)
+// z gęstym rozkładem Cholesky'ego macierzy KKT, liczonym ponownie tylko gdy zmieni się F.
+class EnergyMpc {
+public:
+    explicit EnergyMpc(const MpcConfig& config = MpcConfig())
+        : config_(config) {
+        size_t n = config_.horizon_steps;
+        x_.assign(2 * n, 0.0);
+        x_tilde_.assign(2 * n, 0.0);
+        rhs_.assign(2 * n, 0.0);
+        q_.assign(2 * n, 0.0);
+        z_.assign(3 * n, 0.0);
+        z_tilde_.assign(3 * n, 0.0);
+        y_.assign(3 * n, 0.0);
+        lower_.assign(3 * n, 0.0);
+        upper_.assign(3 * n, 0.0);
+        solution_.service.assign(n, 0.0f);
+        solution_.spill_w.assign(n, 0.0f);
+        solution_.soc.assign(n + 1, 0.0f);
+    }
+
+    const MpcConfig& config() const { return config_; }
+
+    const MpcSolution& solve(const MpcProblem& problem) {
+        auto start = std::chrono::steady_clock::now();
+        size_t n = config_.horizon_steps;
+        double flex = std::max(1.0f, problem.flexible_load_w);
+        double c = config_.step_hours * 100.0 / config_.battery_capacity_wh;
+        if (flex != factored_flex_) {
+            factor(c * flex);
+            factored_flex_ = flex;
+        }
+        scale_ = c * flex;
+
+        // Ograniczenia: pudełka na u, v oraz okno SOC przesunięte o część stałą trajektorii.
+        // Dolne okno obcinamy do SOC osiągalnego przy u = 0, żeby QP zawsze był dopuszczalny.
+        double drift = problem.soc;
+        double reachable = problem.soc;
+        for (size_t k = 0; k < n; ++k) {
+            q_[k] = -config_.service_weight;
+            q_[n + k] = config_.spill_weight;
+            lower_[k] = 0.0;
+            upper_[k] = 1.0;
+            lower_[n + k] = 0.0;
+            upper_[n + k] = std::max(0.0f, problem.solar_w[k]) / flex;
+            drift += c * (problem.solar_w[k] - problem.base_load_w - problem.reserved_w[k]);
+            reachable = std::min<double>(config_.soc_max,
+                reachable + c * (problem.solar_w[k] - problem.base_load_w - problem.reserved_w[k]));
+            double soc_floor = k + 1 == n ? std::max(config_.soc_min, config_.soc_terminal)
+                                          : config_.soc_min;
+            soc_floor = std::min(soc_floor, reachable);
+            lower_[2 * n + k] = soc_floor - drift;
+            upper_[2 * n + k] = config_.soc_max - drift;
+        }
+
+        double rho = config_.admm_rho;
+        double sigma = config_.admm_sigma;
+        double alpha = config_.admm_alpha;
+        size_t iteration = 0;
+        bool converged = false;
+        for (; iteration < config_.max_iterations; ++iteration) {
+            // rhs = sigma x - q + C^T (rho z - y)
+            for (size_t i = 0; i < 3 * n; ++i) {
+                z_tilde_[i] = rho * z_[i] - y_[i];
+            }
+            applyTranspose(z_tilde_, rhs_);
+            for (size_t i = 0; i < 2 * n; ++i) {
+                rhs_[i] += sigma * x_[i] - q_[i];
+            }
+            choleskySolve(rhs_, x_tilde_);
+            apply(x_tilde_, z_tilde_);
+
+            double primal = 0.0;
+            double dual = 0.0;
+            for (size_t i = 0; i < 2 * n; ++i) {
+                x_[i] = alpha * x_tilde_[i] + (1.0 - alpha) * x_[i];
+            }
+            for (size_t i = 0; i < 3 * n; ++i) {
+                double relaxed = alpha * z_tilde_[i] + (1.0 - alpha) * z_[i];
+                double z_new = std::clamp(relaxed + y_[i] / rho, lower_[i], upper_[i]);
+                y_[i] += rho * (relaxed - z_new);
+                primal = std::max(primal, std::abs(relaxed - z_new));
+                dual = std::max(dual, rho * std::abs(z_new - z_[i]));
+                z_[i] = z_new;
+            }
+
+            if (primal < config_.tolerance && dual < config_.tolerance) {
+                converged = true;
+                ++iteration;
+                break;
+            }
+            if ((iteration & 7) == 7 &&
+                std::chrono::steady_clock::now() - start >= config_.time_budget) {
+                ++iteration;
+                break;
+            }
+        }
+
+        double soc = problem.soc;
+        solution_.soc[0] = problem.soc;
+        for (size_t k = 0; k < n; ++k) {
+            double u = std::clamp(x_[k], lower_[k], upper_[k]);
+            double v = std::clamp(x_[n + k], lower_[n + k], upper_[n + k]);
+            solution_.service[k] = static_cast<float>(u);
+            solution_.spill_w[k] = static_cast<float>(v * flex);
+            soc += c * (problem.solar_w[k] - problem.base_load_w - problem.reserved_w[k] -
+                        flex * (u + v));
+            solution_.soc[k + 1] = static_cast<float>(soc);
+        }
+        solution_.first_step_load_w = static_cast<float>(
+            problem.base_load_w + solution_.service[0] * flex);
+        solution_.iterations = iteration;
+        solution_.converged = converged;
+        solution_.solve_us = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - start).count();
+        return solution_;
+    }
+
+private:
+    // C = [I; M], M = -a [L L], L dolnotrójkątna macierz jedynek (suma kumulacyjna)
+    void apply(const std::vector<double>& x, std::vector<double>& out) const {
+        size_t n = config_.horizon_steps;
+        double cumulative = 0.0;
+        for (size_t k = 0; k < n; ++k) {
+            out[k] = x[k];
+            out[n + k] = x[n + k];
+            cumulative += x[k] + x[n + k];
+            out[2 * n + k] = -scale_ * cumulative;
+        }
+    }
+
+    void applyTranspose(const std::vector<double>& w, std::vector<double>& out) const {
+        size_t n = config_.horizon_steps;
+        double reverse = 0.0;
+        for (size_t k = n; k-- > 0;) {
+            reverse += w[2 * n + k];
+            out[k] = w[k] - scale_ * reverse;
+            out[n + k] = w[n + k] - scale_ * reverse;
+        }
+    }
+
+    // K = P + sigma I + rho C^T C, P = 2 rho_s D^T D na bloku u
+    void factor(double a) {
+        size_t n = config_.horizon_steps;
+        size_t dim = 2 * n;
+        chol_.assign(dim * dim, 0.0);
+        double rho = config_.admm_rho;
+        for (size_t i = 0; i < dim; ++i) {
+            for (size_t j = 0; j <= i; ++j) {
+                size_t bi = i % n;
+                size_t bj = j % n;
+                double value = rho * a * a * static_cast<double>(n - std::max(bi, bj));
+                if (i == j) {
+                    value += config_.admm_sigma + rho;
+                }
+                chol_[i * dim + j] = value;
+            }
+        }
+        double smooth = 2.0 * config_.smoothness_weight;
+        for (size_t k = 0; k + 1 < n; ++k) {
+            chol_[k * dim + k] += smooth;
+            chol_[(k + 1) * dim + (k + 1)] += smooth;
+            chol_[(k + 1) * dim + k] -= smooth;
+        }
+
+        for (size_t j = 0; j < dim; ++j) {
+            double diag = chol_[j * dim + j];
+            for (size_t k = 0; k < j; ++k) {
+                diag -= chol_[j * dim + k] * chol_[j * dim + k];
+            }
+            diag = std::sqrt(diag);
+            chol_[j * dim + j] = diag;
+            for (size_t i = j + 1; i < dim; ++i) {
+                double value = chol_[i * dim + j];
+                for (size_t k = 0; k < j; ++k) {
+                    value -= chol_[i * dim + k] * chol_[j * dim + k];
+                }
+                chol_[i * dim + j] = value / diag;
+            }
+        }
+    }
+
+    void choleskySolve(const std::vector<double>& b, std::vector<double>& x) const {
+        size_t dim = 2 * config_.horizon_steps;
+        for (size_t i = 0; i < dim; ++i) {
+            double value = b[i];
+            for (size_t k = 0; k < i; ++k) {
+                value -= chol_[i * dim + k] * x[k];
+            }
+            x[i] = value / chol_[i * dim + i];
+        }
+        for (size_t i = dim; i-- > 0;) {
+            double value = x[i];
+            for (size_t k = i + 1; k < dim; ++k) {
+                value -= chol_[k * dim + i] * x[k];
+            }
+            x[i] = value / chol_[i * dim + i];
+        }
+    }
+
+    MpcConfig config_;
+    MpcSolution solution_;
+    double factored_flex_ = -1.0;
+    double scale_ = 0.0;
+    std::vector<double> chol_;
+    std::vector<double> x_, x_tilde_, rhs_, q_;
+    std::vector<double> z_, z_tilde_, y_;
+    std::vector<double> lower_, upper_;
+};
+
+}
+
+#endif // ENERGY_MPC_HPP
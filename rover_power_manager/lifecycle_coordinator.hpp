@@ -0,0 +1,240 @@
+#ifndef LIFECYCLE_COORDINATOR_HPP
+#define LIFECYCLE_COORDINATOR_HPP
+
+#include <rclcpp/rclcpp.hpp>
+#include <lifecycle_msgs/msg/state.hpp>
+#include <lifecycle_msgs/msg/transition.hpp>
+#include <lifecycle_msgs/srv/change_state.hpp>
+#include <lifecycle_msgs/srv/get_state.hpp>
+#include <chrono>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "power_types.hpp"
+
+namespace rover_energy {
+
+// Przenosi decyzje trybu na zarządzane węzły odbiorców (lifecycle).
+// Węzeł ma być ACTIVE dokładnie wtedy, gdy jego komponent jest włączony i zasilony;
+// zrzucenie komponentu deaktywuje węzeł, przywrócenie aktywuje go po rozruchu.
+// Żądania są asynchroniczne, więc przejścia wszystkich węzłów biegną równolegle,
+// a pętla zarządzania tylko sprawdza gotowość odpowiedzi i limity czasu.
+class LifecycleCoordinator {
+public:
+    using ChangeState = lifecycle_msgs::srv::ChangeState;
+    using GetState = lifecycle_msgs::srv::GetState;
+    using State = lifecycle_msgs::msg::State;
+    using Transition = lifecycle_msgs::msg::Transition;
+
+    LifecycleCoordinator(rclcpp::Node& node, double timeout_s, double retry_s)
+        : node_(node),
+          timeout_(rclcpp::Duration::from_seconds(timeout_s)),
+          retry_(rclcpp::Duration::from_seconds(retry_s)) {}
+
+    void manage(const std::string& component, const std::string& lifecycle_node) {
+        release(component);
+        ManagedNode entry;
+        entry.component = component;
+        entry.node = lifecycle_node;
+        entry.change_client = node_.create_client<ChangeState>(lifecycle_node + "/change_state");
+        entry.state_client = node_.create_client<GetState>(lifecycle_node + "/get_state");
+        entry.retry_at = node_.now();
+        entries_.push_back(std::move(entry));
+        RCLCPP_INFO(node_.get_logger(), "Component %s drives lifecycle node %s",
+            component.c_str(), lifecycle_node.c_str());
+    }
+
+    void release(const std::string& component) {
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            if (entries_[i].component == component) {
+                cancel(entries_[i]);
+                entries_.erase(entries_.begin() + i);
+                return;
+            }
+        }
+    }
+
+    // Wywoływane co cykl zarządzania; komponenty usunięte z tabeli wypadają z koordynacji.
+    void sync(const std::vector<PowerComponent>& components) {
+        if (entries_.empty()) {
+            return;
+        }
+        rclcpp::Time now = node_.now();
+        for (size_t i = 0; i < entries_.size();) {
+            ManagedNode& entry = entries_[i];
+            const PowerComponent* comp = locate(components, entry);
+            if (!comp) {
+                cancel(entry);
+                entries_.erase(entries_.begin() + i);
+                continue;
+            }
+            ++i;
+
+            if (entry.pending && !poll(entry, now)) {
+                continue;
+            }
+            bool want_active = comp->is_enabled && comp->power_state == ComponentPowerState::ACTIVE;
+            uint8_t wanted = want_active ? State::PRIMARY_STATE_ACTIVE : State::PRIMARY_STATE_INACTIVE;
+            if (entry.state == wanted || now < entry.retry_at) {
+                continue;
+            }
+            request(entry, wanted, now);
+        }
+    }
+
+    // Zmiana trybu: węzły komponentów z maski changed nie czekają na koniec odstępu
+    // ponowień po wcześniejszym błędzie, tylko dostają żądanie w najbliższym sync().
+    void componentsChanged(const std::vector<PowerComponent>& components, uint32_t changed) {
+        if (changed == 0) {
+            return;
+        }
+        rclcpp::Time now = node_.now();
+        for (auto& entry : entries_) {
+            const PowerComponent* comp = locate(components, entry);
+            if (comp && entry.index_hint < 32 && ((changed >> entry.index_hint) & 1u) && !entry.pending) {
+                entry.retry_at = now;
+            }
+        }
+    }
+
+private:
+    struct ManagedNode {
+        std::string component;
+        std::string node;
+        size_t index_hint = 0;
+        rclcpp::Client<ChangeState>::SharedPtr change_client;
+        rclcpp::Client<GetState>::SharedPtr state_client;
+        uint8_t state = State::PRIMARY_STATE_UNKNOWN;  // ostatni potwierdzony stan węzła
+        uint8_t transition = 0;                        // 0 = zapytanie o stan
+        bool pending = false;
+        bool warned = false;
+        int64_t request_id = 0;
+        std::shared_future<ChangeState::Response::SharedPtr> change_future;
+        std::shared_future<GetState::Response::SharedPtr> state_future;
+        rclcpp::Time deadline;
+        rclcpp::Time retry_at;
+    };
+
+    const PowerComponent* locate(const std::vector<PowerComponent>& components, ManagedNode& entry) {
+        if (entry.index_hint < components.size() &&
+            components[entry.index_hint].name == entry.component) {
+            return &components[entry.index_hint];
+        }
+        for (size_t i = 0; i < components.size(); ++i) {
+            if (components[i].name == entry.component) {
+                entry.index_hint = i;
+                return &components[i];
+            }
+        }
+        return nullptr;
+    }
+
+    // Stan nieznany (start, błąd, timeout) najpierw odpytujemy, żeby nie wysyłać
+    // przejścia niedozwolonego z bieżącego stanu węzła.
+    void request(ManagedNode& entry, uint8_t wanted, const rclcpp::Time& now) {
+        bool query = entry.state == State::PRIMARY_STATE_UNKNOWN;
+        bool ready = query ? entry.state_client->service_is_ready()
+                           : entry.change_client->service_is_ready();
+        if (!ready) {
+            if (!entry.warned) {
+                RCLCPP_WARN(node_.get_logger(), "Lifecycle node %s not available for %s",
+                    entry.node.c_str(), entry.component.c_str());
+                entry.warned = true;
+            }
+            entry.retry_at = now + retry_;
+            return;
+        }
+
+        if (query) {
+            auto result = entry.state_client->async_send_request(
+                std::make_shared<GetState::Request>());
+            entry.state_future = result.future.share();
+            entry.request_id = result.request_id;
+            entry.transition = 0;
+        } else if (entry.state == State::PRIMARY_STATE_ACTIVE ||
+                   entry.state == State::PRIMARY_STATE_INACTIVE) {
+            auto change = std::make_shared<ChangeState::Request>();
+            change->transition.id = wanted == State::PRIMARY_STATE_ACTIVE
+                ? Transition::TRANSITION_ACTIVATE : Transition::TRANSITION_DEACTIVATE;
+            auto result = entry.change_client->async_send_request(change);
+            entry.change_future = result.future.share();
+            entry.request_id = result.request_id;
+            entry.transition = change->transition.id;
+        } else {
+            // Konfiguracja i sprzątanie należą do właściciela węzła
+            if (!entry.warned) {
+                RCLCPP_WARN(node_.get_logger(), "Lifecycle node %s is in state %u, cannot %s it",
+                    entry.node.c_str(), entry.state,
+                    wanted == State::PRIMARY_STATE_ACTIVE ? "activate" : "deactivate");
+                entry.warned = true;
+            }
+            entry.state = State::PRIMARY_STATE_UNKNOWN;
+            entry.retry_at = now + retry_;
+            return;
+        }
+        entry.pending = true;
+        entry.deadline = now + timeout_;
+    }
+
+    // Zwraca true, gdy żądanie się zakończyło (odpowiedzią lub przekroczeniem czasu).
+    bool poll(ManagedNode& entry, const rclcpp::Time& now) {
+        bool query = entry.transition == 0;
+        bool ready = query
+            ? entry.state_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready
+            : entry.change_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        if (!ready) {
+            if (now < entry.deadline) {
+                return false;
+            }
+            cancel(entry);
+            RCLCPP_WARN(node_.get_logger(), "Lifecycle %s of %s timed out",
+                query ? "state query" : "transition", entry.node.c_str());
+            entry.state = State::PRIMARY_STATE_UNKNOWN;
+            entry.retry_at = now + retry_;
+            return true;
+        }
+
+        entry.pending = false;
+        if (query) {
+            entry.state = entry.state_future.get()->current_state.id;
+            return true;
+        }
+        if (entry.change_future.get()->success) {
+            entry.state = entry.transition == Transition::TRANSITION_ACTIVATE
+                ? State::PRIMARY_STATE_ACTIVE : State::PRIMARY_STATE_INACTIVE;
+            entry.warned = false;
+            RCLCPP_INFO(node_.get_logger(), "Lifecycle node %s %s",
+                entry.node.c_str(),
+                entry.state == State::PRIMARY_STATE_ACTIVE ? "activated" : "deactivated");
+        } else {
+            RCLCPP_WARN(node_.get_logger(), "Lifecycle node %s rejected %s",
+                entry.node.c_str(),
+                entry.transition == Transition::TRANSITION_ACTIVATE ? "activate" : "deactivate");
+            entry.state = State::PRIMARY_STATE_UNKNOWN;
+            entry.retry_at = now + retry_;
+        }
+        return true;
+    }
+
+    void cancel(ManagedNode& entry) {
+        if (!entry.pending) {
+            return;
+        }
+        if (entry.transition == 0) {
+            entry.state_client->remove_pending_request(entry.request_id);
+        } else {
+            entry.change_client->remove_pending_request(entry.request_id);
+        }
+        entry.pending = false;
+    }
+
+    rclcpp::Node& node_;
+    rclcpp::Duration timeout_;
+    rclcpp::Duration retry_;
+    std::vector<ManagedNode> entries_;
+};
+
+}
+
+#endif // LIFECYCLE_COORDINATOR_HPP
@@ -4,50 +4,50 @@
 #include <rclcpp/rclcpp.hpp>
 #include <std_msgs/msg/float32.hpp>
 #include <std_msgs/msg/string.hpp>
+#include <std_msgs/msg/float32_multi_array.hpp>
+#include <std_msgs/msg/u_int8_multi_array.hpp>
 #include <geometry_msgs/msg/twist.hpp>
+#include <sensor_msgs/msg/battery_state.hpp>
+#include <diagnostic_msgs/msg/diagnostic_status.hpp>
+#include <std_srvs/srv/trigger.hpp>
 #include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
 
-namespace rover_energy {
-enum class PowerMode {
-    NORMAL,         
-    LOW_POWER,      
-    HIBERNATION,      
-    EMERGENCY
-};
+#include "array_articulation.hpp"
+#include "budget_curve.hpp"
+#include "component_power_state.hpp"
+#include "component_registry.hpp"
+#include "component_table.hpp"
+#include "default_components.hpp"
+#include "dust_storm.hpp"
+#include "energy_core.hpp"
+#include "energy_mpc.hpp"
+#include "lifecycle_coordinator.hpp"
+#include "mars_time.hpp"
+#include "mode_trace.hpp"
+#include "power_quality.hpp"
+#include "power_types.hpp"
+#include "sensor_sync.hpp"
+#include "solar_forecast.hpp"
+#include "telemetry_codec.hpp"
+#include "thermal_model.hpp"
+#include "what_if.hpp"
+#include "telemetry_decimator.hpp"
 
-struct EnergyState {
-    float battery_soc;      
-    float voltage;              
-    float current;      
-    float power_consumption;    
-    float solar_generation; 
-    float temperature;      
-    PowerMode mode;
-};
-
-enum class ComponentPriority {
-    CRITICAL = 0,   
-    HIGH = 1,   
-    MEDIUM = 2,
-    LOW = 3 
-};
-
-struct PowerComponent {
-    std::string name;
-    ComponentPriority priority;
-    float nominal_power;
-    float current_power;
-    bool is_enabled;
-    bool is_essential;
-};
+namespace rover_energy {
 
 class PowerManager : public rclcpp::Node {
 public:
     PowerManager() : Node("power_manager"), 
                      current_mode_(PowerMode::NORMAL),
-                     last_prediction_time_(this->now()) {
+                     last_prediction_time_(this->now()),
+                     telemetry_encoder_(100) {
         
         energy_state_.battery_soc = 100.0f;
         energy_state_.voltage = 28.0f;
@@ -56,26 +56,221 @@ public:
         energy_state_.solar_generation = 0.0f;
         energy_state_.temperature = 20.0f;
         energy_state_.mode = PowerMode::NORMAL;
+        mode_entered_time_ = this->now();
+
+        // Progi trybów; wartości z narzędzia tools/policy_tuner
+        mode_thresholds_.emergency_soc = static_cast<float>(
+            this->declare_parameter("mode.emergency_soc", 15.0));
+        mode_thresholds_.hibernation_solar_w = static_cast<float>(
+            this->declare_parameter("mode.hibernation_solar_w", 5.0));
+        mode_thresholds_.hibernation_soc = static_cast<float>(
+            this->declare_parameter("mode.hibernation_soc", 50.0));
+        mode_thresholds_.low_power_soc = static_cast<float>(
+            this->declare_parameter("mode.low_power_soc", 30.0));
+        mode_thresholds_.low_power_balance_w = static_cast<float>(
+            this->declare_parameter("mode.low_power_balance_w", -10.0));
+        mode_thresholds_.normal_soc = static_cast<float>(
+            this->declare_parameter("mode.normal_soc", 40.0));
+        mode_thresholds_.normal_balance_w = static_cast<float>(
+            this->declare_parameter("mode.normal_balance_w", 0.0));
+        mode_thresholds_.min_dwell_s = static_cast<float>(
+            this->declare_parameter("mode.min_dwell_s", 0.0));
+
+        site_latitude_deg_ = this->declare_parameter("site_latitude_deg", 18.4);
+        site_longitude_deg_ = this->declare_parameter("site_longitude_deg", 77.5);
+
+        double optical_depth = this->declare_parameter("atmospheric_opacity", 0.5);
+        ArrayConfig array_config;
+        array_config.optical_depth = optical_depth;
+        array_config.max_tilt_deg = this->declare_parameter("array_max_tilt_deg", 45.0);
+        array_config.actuator_energy_j_per_deg =
+            this->declare_parameter("array_actuator_energy_j_per_deg", 5.0);
+        array_optimizer_ = std::make_unique<ArrayArticulationOptimizer>(array_config, worker_pool_);
+
+        SolarArrayModel array_model;
+        array_model.area_m2 = array_config.area_m2;
+        array_model.efficiency = array_config.efficiency;
+        array_model.optical_depth = optical_depth;
+        solar_forecaster_ = SolarForecaster(array_model);
+
+        DustStormConfig storm_config;
+        storm_config.entry_opacity = this->declare_parameter("dust_storm.entry_opacity", 1.5);
+        storm_config.exit_opacity = this->declare_parameter("dust_storm.exit_opacity", 1.0);
+        storm_config.rise_rate = this->declare_parameter("dust_storm.rise_rate_per_sol", 0.15);
+        storm_config.horizon_sols = static_cast<size_t>(
+            this->declare_parameter("dust_storm.horizon_sols", 42));
+        storm_config.reserve_soc = static_cast<float>(
+            this->declare_parameter("dust_storm.reserve_soc", 25.0));
+        storm_config.max_rise_sols = this->declare_parameter("dust_storm.max_rise_sols", 10.0);
+        storm_config.decay_sols = this->declare_parameter("dust_storm.decay_sols", 30.0);
+        storm_monitor_ = std::make_unique<DustStormMonitor>(storm_config, array_model);
+        storm_planner_ = std::make_unique<StormSurvivalPlanner>(storm_config, array_model);
+
+        PowerQualityConfig quality_config;
+        quality_config.transient_threshold_v = static_cast<float>(
+            this->declare_parameter("power_quality.transient_threshold_v", 0.5));
+        quality_config.baseline_time_s = static_cast<float>(
+            this->declare_parameter("power_quality.baseline_time_s", 0.05));
+        quality_config.max_gap_s = static_cast<float>(
+            this->declare_parameter("power_quality.max_gap_s", 0.01));
+        power_quality_ = std::make_unique<PowerQualityAnalyzer>(quality_config);
+
+        MpcConfig mpc_config;
+        mpc_config.battery_capacity_wh = this->declare_parameter("battery_capacity_wh", 2000.0);
+        mpc_config.soc_min = this->declare_parameter("mpc_soc_min", 30.0);
+        mpc_config.soc_terminal = this->declare_parameter("mpc_soc_terminal", 50.0);
+        mpc_config.time_budget = std::chrono::microseconds(
+            this->declare_parameter("mpc_time_budget_us", 2000));
+        mpc_enabled_ = this->declare_parameter("mpc_enabled", true);
+        mpc_ = std::make_unique<EnergyMpc>(mpc_config);
+        solar_forecast_w_.assign(mpc_config.horizon_steps, 0.0f);
+        reserved_power_w_.assign(mpc_config.horizon_steps, 0.0f);
+
+        ThermalConfig thermal_config;
+        thermal_config.env_mean_temp_c = this->declare_parameter("thermal_env_mean_c", -60.0);
+        thermal_config.env_amplitude_c = this->declare_parameter("thermal_env_amplitude_c", 35.0);
+        thermal_config.survival_temp_c = this->declare_parameter("thermal_survival_c", -40.0);
 
         initializeComponents();
+        registry_ = std::make_unique<ComponentRegistry>(components_);
+
+        heating_index_ = componentIndex(ComponentId::heating);
+        thermal_config.heater_power_w = components_[heating_index_].nominal_power;
+        heater_scheduler_ = std::make_unique<HeaterScheduler>(thermal_config);
+        heater_surplus_w_.assign(kHeaterPlanSteps, 0.0f);
+
+        lifecycle_ = std::make_unique<LifecycleCoordinator>(*this,
+            this->declare_parameter("lifecycle_timeout_s", 2.0),
+            this->declare_parameter("lifecycle_retry_s", 5.0));
+        auto lifecycle_nodes = this->declare_parameter("lifecycle_nodes", std::vector<std::string>{
+            "lidar=lidar_node", "cameras=camera_node", "science_instruments=science_node"});
+        for (const auto& mapping : lifecycle_nodes) {
+            size_t separator = mapping.find('=');
+            if (separator == std::string::npos || separator == 0 || separator + 1 == mapping.size()) {
+                RCLCPP_WARN(this->get_logger(), "Ignoring lifecycle mapping '%s'", mapping.c_str());
+                continue;
+            }
+            lifecycle_->manage(mapping.substr(0, separator), mapping.substr(separator + 1));
+        }
 
         power_mode_pub_ = this->create_publisher<std_msgs::msg::String>(
             "power/mode", 10);
         
         battery_status_pub_ = this->create_publisher<std_msgs::msg::Float32>(
             "power/battery_soc", 10);
+
+        bus_power_pub_ = this->create_publisher<std_msgs::msg::Float32>(
+            "power/bus_power", 10);
         
         power_budget_pub_ = this->create_publisher<std_msgs::msg::Float32>(
             "power/available_power", 10);
 
-        battery_sub_ = this->create_subscription<std_msgs::msg::Float32>(
-            "sensors/battery_voltage", 10,
+        power_grants_pub_ = this->create_publisher<std_msgs::msg::Float32MultiArray>(
+            "power/grants", 10);
+
+        grant_components_pub_ = this->create_publisher<std_msgs::msg::String>(
+            "power/grant_components", rclcpp::QoS(1).transient_local());
+
+        telemetry_pub_ = this->create_publisher<std_msgs::msg::UInt8MultiArray>(
+            "power/telemetry", 10);
+
+        array_tilt_pub_ = this->create_publisher<std_msgs::msg::Float32>(
+            "power/array_tilt_setpoint", 10);
+
+        heater_schedule_pub_ = this->create_publisher<std_msgs::msg::Float32MultiArray>(
+            "power/heater_schedule", 10);
+
+        budget_curve_pub_ = this->create_publisher<std_msgs::msg::Float32MultiArray>(
+            "power/budget_curve", 10);
+        budget_msg_.layout.dim.resize(2);
+        budget_msg_.layout.dim[0].label = "mars_hour";
+        budget_msg_.layout.dim[0].size = static_cast<uint32_t>(kBudgetSteps);
+        budget_msg_.layout.dim[0].stride = static_cast<uint32_t>(kBudgetSteps * 3);
+        budget_msg_.layout.dim[1].label = "energy_wh,soc,confidence";
+        budget_msg_.layout.dim[1].size = 3;
+        budget_msg_.layout.dim[1].stride = 3;
+        budget_msg_.data.assign(kBudgetSteps * 3, 0.0f);
+        budget_reserved_w_.assign(kBudgetSteps, 0.0f);
+
+        dust_storm_pub_ = this->create_publisher<std_msgs::msg::Float32MultiArray>(
+            "power/dust_storm", 10);
+        storm_msg_.layout.dim.resize(1);
+        storm_msg_.layout.dim[0].label = "active,opacity,slope_per_sol,flexible_budget_w,min_soc,min_soc_sols";
+        storm_msg_.layout.dim[0].size = 6;
+        storm_msg_.layout.dim[0].stride = 6;
+        storm_msg_.data.assign(6, 0.0f);
+
+        power_quality_pub_ = this->create_publisher<std_msgs::msg::Float32MultiArray>(
+            "power/quality", 10);
+        quality_msg_.layout.dim.resize(1);
+        quality_msg_.layout.dim[0].label = "mean_voltage,ripple_rms_v,band0_rms_v,band1_rms_v,band2_rms_v,"
+                                           "band3_rms_v,dominant_hz,dominant_rms_v,transients,"
+                                           "peak_deviation_v,sample_rate_hz";
+        quality_msg_.layout.dim[0].size = kQualityFields;
+        quality_msg_.layout.dim[0].stride = kQualityFields;
+        quality_msg_.data.assign(kQualityFields, 0.0f);
+
+        initializeDecimatedOutputs();
+
+        mode_trace_.setTickTraceEnabled(this->declare_parameter("mode_tick_trace", false));
+        mode_history_srv_ = this->create_service<std_srvs::srv::Trigger>(
+            "power/mode_history",
+            std::bind(&PowerManager::modeHistoryCallback, this,
+                      std::placeholders::_1, std::placeholders::_2));
+        mode_trace_export_srv_ = this->create_service<std_srvs::srv::Trigger>(
+            "power/export_mode_trace",
+            std::bind(&PowerManager::exportModeTraceCallback, this,
+                      std::placeholders::_1, std::placeholders::_2));
+
+        bus_sync_ = ApproximateTimeSync<kBusSyncDepth>(static_cast<int64_t>(
+            this->declare_parameter("bus_sync_slop_ms", 2.0) * 1e6));
+        battery_sub_ = this->create_subscription<sensor_msgs::msg::BatteryState>(
+            "sensors/battery_state", rclcpp::SensorDataQoS(),
             std::bind(&PowerManager::batteryCallback, this, std::placeholders::_1));
+
+        bus_current_sub_ = this->create_subscription<sensor_msgs::msg::BatteryState>(
+            "sensors/bus_current", rclcpp::SensorDataQoS(),
+            std::bind(&PowerManager::busCurrentCallback, this, std::placeholders::_1));
         
         solar_sub_ = this->create_subscription<std_msgs::msg::Float32>(
             "sensors/solar_power", 10,
             std::bind(&PowerManager::solarCallback, this, std::placeholders::_1));
         
+        temperature_sub_ = this->create_subscription<std_msgs::msg::Float32>(
+            "sensors/temperature", 10,
+            std::bind(&PowerManager::temperatureCallback, this, std::placeholders::_1));
+        
+        registration_pub_ = this->create_publisher<diagnostic_msgs::msg::DiagnosticStatus>(
+            "power/registration", 10);
+
+        register_sub_ = this->create_subscription<diagnostic_msgs::msg::DiagnosticStatus>(
+            "power/register", 10,
+            std::bind(&PowerManager::registerCallback, this, std::placeholders::_1));
+
+        component_update_sub_ = this->create_subscription<diagnostic_msgs::msg::DiagnosticStatus>(
+            "power/component_update", 10,
+            std::bind(&PowerManager::componentUpdateCallback, this, std::placeholders::_1));
+
+        WhatIfConfig what_if_config;
+        what_if_config.step_s = static_cast<float>(this->declare_parameter("whatif_step_s", 10.0));
+        what_if_config.drive_speed_mps =
+            static_cast<float>(this->declare_parameter("whatif_drive_speed_mps", 0.05));
+        what_if_config.drive_power_w =
+            static_cast<float>(this->declare_parameter("whatif_drive_power_w", 40.0));
+        what_if_config.deadline = std::chrono::milliseconds(
+            this->declare_parameter("whatif_deadline_ms", 200));
+        // Własna pula: partia what-if trzyma pulę do terminu, a worker_pool_ służy pętlom węzła
+        int64_t what_if_threads = this->declare_parameter("whatif_threads", 2);
+        what_if_pool_ = std::make_unique<ThreadPool>(static_cast<size_t>(std::max<int64_t>(what_if_threads, 1) - 1));
+        what_if_ = std::make_unique<WhatIfEvaluator>(what_if_config, *what_if_pool_);
+
+        what_if_result_pub_ = this->create_publisher<diagnostic_msgs::msg::DiagnosticStatus>(
+            "power/whatif/result", 10);
+
+        what_if_sub_ = this->create_subscription<diagnostic_msgs::msg::DiagnosticStatus>(
+            "power/whatif/request", 10,
+            std::bind(&PowerManager::whatIfCallback, this, std::placeholders::_1));
+        
         cmd_vel_sub_ = this->create_subscription<geometry_msgs::msg::Twist>(
             "cmd_vel", 10,
             std::bind(&PowerManager::velocityCallback, this, std::placeholders::_1));
@@ -88,16 +283,30 @@ public:
             std::chrono::seconds(1),
             std::bind(&PowerManager::predictionLoop, this));
 
+        what_if_thread_ = std::thread([this] { whatIfLoop(); });
         RCLCPP_INFO(this->get_logger(), "PowerManager initialized");
     }
 
+    ~PowerManager() {
+        {
+            std::lock_guard<std::mutex> lock(what_if_mutex_);
+            what_if_stopping_ = true;
+        }
+        what_if_wake_.notify_one();
+        what_if_thread_.join();
+    }
+
     PowerMode getCurrentMode() const { return current_mode_; }
     
     EnergyState getEnergyState() const { return energy_state_; }
     
     void setMode(PowerMode mode) {
         if (mode != current_mode_) {
-            switchMode(mode);
+            ModeDecision decision = currentDecisionInputs();
+            decision.to = mode;
+            decision.rule = ModeRule::COMMANDED;
+            mode_trace_.recordTransition(decision);
+            switchMode(mode, ModeRule::COMMANDED);
         }
     }
 
@@ -107,65 +316,658 @@ public:
         return std::max(0.0f, net_power);
     }
 
+    // Punkt kontrolny bieżącego stanu do symulacji gałęzi (what-if); tani do rozwidlenia.
+    Checkpoint checkpoint() {
+        Checkpoint cp;
+        cp.state.time_s = this->now().seconds();
+        cp.state.energy = energy_state_;
+        captureComponents(components_, registry_->allocationOrder(), cp.state);
+        cp.state.mode.mode = current_mode_;
+        cp.state.mode.planned_mode = planned_mode_;
+        cp.state.mode.plan_valid = mpc_enabled_ && plan_valid_;
+        cp.state.mode.plan_age_s = plan_valid_
+            ? static_cast<float>((this->now() - plan_time_).seconds()) : 0.0f;
+        cp.state.mode.flexible_budget_w = storm_monitor_->active()
+            ? storm_planner_->plan().flexible_budget_w : plannedFlexibleBudget();
+        cp.state.mode.thresholds = mode_thresholds_;
+        cp.state.mode.time_in_mode_s = static_cast<float>((this->now() - mode_entered_time_).seconds());
+        cp.state.mode.transitions = 0;
+        cp.state.mode.dust_storm = storm_monitor_->active();
+        cp.state.battery.capacity_wh = static_cast<float>(mpc_->config().battery_capacity_wh);
+        cp.state.battery.solar_calibration = solar_forecaster_.calibration();
+        cp.state.battery.energy_in_wh = 0.0f;
+        cp.state.battery.energy_out_wh = 0.0f;
+        cp.history = live_history_;
+        cp.metadata = coreMetadata();
+        return cp;
+    }
+
 private:
+    // Zapytanie what-if przekazywane do wątku whatIfLoop() razem ze zrzutem stanu.
+    struct WhatIfJob {
+        diagnostic_msgs::msg::DiagnosticStatus::SharedPtr request;
+        Checkpoint origin;
+        std::vector<WhatIfCandidate> candidates;
+        std::vector<float> solar_w;
+        double start_ltst_hours = 0.0;
+        double sunrise_ltst_hours = 0.0;
+    };
+
     void initializeComponents() {
-        components_.push_back({"communication", ComponentPriority::CRITICAL, 15.0f, 15.0f, true, true});
-        components_.push_back({"fdir_watchdog", ComponentPriority::CRITICAL, 5.0f, 5.0f, true, true});
-        components_.push_back({"navigation", ComponentPriority::HIGH, 25.0f, 25.0f, true, true});
-        components_.push_back({"motors", ComponentPriority::HIGH, 50.0f, 0.0f, true, true});
-        components_.push_back({"lidar", ComponentPriority::MEDIUM, 20.0f, 20.0f, true, false});
-        components_.push_back({"cameras", ComponentPriority::MEDIUM, 15.0f, 15.0f, true, false});
-        components_.push_back({"science_instruments", ComponentPriority::LOW, 30.0f, 0.0f, true, false});
-        components_.push_back({"heating", ComponentPriority::MEDIUM, 40.0f, 0.0f, true, false});
-    }
-
-    void batteryCallback(const std_msgs::msg::Float32::SharedPtr msg) {
-        energy_state_.voltage = msg->data;
+        components_ = defaultComponents();
+    }
+
+    // Napięcie i prąd szyny pochodzą z różnych czujników (BatteryState z polami NaN dla
+    // niemierzonych); V×I liczone tylko z par dopasowanych po stemplach. SOC z napięcia
+    // jest publikowany w pętli zarządzania, a nie co próbkę.
+    void batteryCallback(const sensor_msgs::msg::BatteryState::SharedPtr msg) {
+        if (!std::isfinite(msg->voltage)) {
+            return;
+        }
+        energy_state_.voltage = msg->voltage;
         
-        energy_state_.battery_soc = ((msg->data - 24.0f) / 5.4f) * 100.0f;
+        energy_state_.battery_soc = ((msg->voltage - 24.0f) / 5.4f) * 100.0f;
         energy_state_.battery_soc = std::clamp(energy_state_.battery_soc, 0.0f, 100.0f);
-        
+
+        int64_t stamp_ns = stampNs(msg->header);
+        power_quality_->addSample(stamp_ns, msg->voltage);
+        bus_sync_.push(kBusVoltageInput, stamp_ns, msg->voltage,
+                       [this](const MatchedPair& pair) { fuseBusSample(pair); });
+    }
+
+    // Prąd obciążenia szyny [A], dodatni = pobór
+    void busCurrentCallback(const sensor_msgs::msg::BatteryState::SharedPtr msg) {
+        if (!std::isfinite(msg->current)) {
+            return;
+        }
+        bus_sync_.push(kBusCurrentInput, stampNs(msg->header), msg->current,
+                       [this](const MatchedPair& pair) { fuseBusSample(pair); });
+    }
+
+    void fuseBusSample(const MatchedPair& pair) {
+        energy_state_.current = pair.second;
+        bus_power_sum_w_ += static_cast<double>(pair.first) * pair.second;
+        ++bus_power_samples_;
+    }
+
+    // Źródła bez stempla (0) dostają czas odbioru
+    int64_t stampNs(const std_msgs::msg::Header& header) const {
+        int64_t stamp = rclcpp::Time(header.stamp).nanoseconds();
+        return stamp != 0 ? stamp : this->now().nanoseconds();
+    }
+
+    // Średnia V×I par z ostatniego okresu pętli; bez par (brak czujnika prądu) nic nie wychodzi.
+    void publishBusState() {
         auto soc_msg = std_msgs::msg::Float32();
         soc_msg.data = energy_state_.battery_soc;
         battery_status_pub_->publish(soc_msg);
+
+        if (bus_power_samples_ > 0) {
+            auto bus_msg = std_msgs::msg::Float32();
+            bus_msg.data = static_cast<float>(bus_power_sum_w_ / bus_power_samples_);
+            bus_power_pub_->publish(bus_msg);
+            bus_power_sum_w_ = 0.0;
+            bus_power_samples_ = 0;
+        }
+    }
+
+    // Ostrzeżenie, gdy w ostatniej sekundzie więcej próbek V/I przepadło, niż złożyło się w pary
+    void checkBusSync() {
+        const SyncStats& stats = bus_sync_.stats();
+        uint64_t matched = stats.matched - bus_sync_reported_.matched;
+        uint64_t lost = (stats.unmatched - bus_sync_reported_.unmatched) +
+                        (stats.overflowed - bus_sync_reported_.overflowed) +
+                        (stats.out_of_order - bus_sync_reported_.out_of_order);
+        if (lost > matched) {
+            RCLCPP_WARN(this->get_logger(),
+                "Bus V/I alignment: %llu pairs, %llu samples dropped in the last second",
+                static_cast<unsigned long long>(matched), static_cast<unsigned long long>(lost));
+        }
+        bus_sync_reported_ = stats;
+    }
+
+    // Tętnienia i stany nieustalone szyny z ostatniej sekundy (pasma wg PowerQualityConfig)
+    void publishPowerQuality() {
+        PowerQualityMetrics m = power_quality_->report();
+        if (m.samples == 0) {
+            return;
+        }
+        quality_msg_.data = {m.mean_voltage, m.ripple_rms_v,
+                             m.band_rms_v[0], m.band_rms_v[1], m.band_rms_v[2], m.band_rms_v[3],
+                             m.dominant_hz, m.dominant_rms_v, static_cast<float>(m.transients),
+                             m.peak_deviation_v, m.sample_rate_hz};
+        power_quality_pub_->publish(quality_msg_);
+
+        if (m.transients > 0) {
+            RCLCPP_WARN(this->get_logger(),
+                "Bus transients: %u in the last second, peak deviation %.2f V, ripple %.3f V RMS",
+                m.transients, m.peak_deviation_v, m.ripple_rms_v);
+        }
     }
 
     void solarCallback(const std_msgs::msg::Float32::SharedPtr msg) {
         energy_state_.solar_generation = msg->data;
     }
 
+    void temperatureCallback(const std_msgs::msg::Float32::SharedPtr msg) {
+        energy_state_.temperature = msg->data;
+    }
+
     void velocityCallback(const geometry_msgs::msg::Twist::SharedPtr msg) {
         float speed = std::abs(msg->linear.x);
         float angular = std::abs(msg->angular.z);
         
         float motor_power = 10.0f + 40.0f * speed + 20.0f * angular;
         
-        for (auto& comp : components_) {
-            if (comp.name == "motors") {
-                comp.current_power = motor_power;
-                break;
+        // Komponenty wbudowane mają stałe indeksy; rejestr dopisuje za nimi
+        components_[componentIndex(ComponentId::motors)].current_power = motor_power;
+    }
+
+    // Rejestracja ładunku: name = komponent, hardware_id = pełna nazwa węzła właściciela,
+    // values: priority, power_levels ("5,20"), essential, depends_on ("a,b"),
+    // boot_time_s, boot_power_factor, warm_power, warmup_time_s, shed_in_low_power,
+    // lifecycle_node (węzeł zarządzany, deaktywowany przy zrzuceniu komponentu).
+    void registerCallback(const diagnostic_msgs::msg::DiagnosticStatus::SharedPtr msg) {
+        ComponentRegistration registration;
+        registration.component = {msg->name, ComponentPriority::LOW, 0.0f, 0.0f, false, false};
+        registration.owner = msg->hardware_id;
+        std::string lifecycle_node;
+        std::string error;
+        for (const auto& kv : msg->values) {
+            if (kv.key == "priority") {
+                if (!parsePriority(kv.value, registration.component.priority)) {
+                    error = "bad priority '" + kv.value + "'";
+                }
+            } else if (kv.key == "power_levels") {
+                if (!parseFloatList(kv.value, registration.power_levels)) {
+                    error = "bad power_levels '" + kv.value + "'";
+                }
+            } else if (kv.key == "essential") {
+                registration.component.is_essential = kv.value == "true" || kv.value == "1";
+            } else if (kv.key == "depends_on") {
+                registration.dependencies = splitList(kv.value);
+            } else if (kv.key == "boot_time_s") {
+                parseFloat(kv.value, registration.component.transition.boot_time_s, error);
+            } else if (kv.key == "boot_power_factor") {
+                parseFloat(kv.value, registration.component.transition.boot_power_factor, error);
+            } else if (kv.key == "warm_power") {
+                parseFloat(kv.value, registration.component.transition.warm_power, error);
+            } else if (kv.key == "warmup_time_s") {
+                parseFloat(kv.value, registration.component.transition.warmup_time_s, error);
+            } else if (kv.key == "shed_in_low_power") {
+                registration.component.shed_in_low_power = kv.value == "true" || kv.value == "1";
+            } else if (kv.key == "lifecycle_node") {
+                lifecycle_node = kv.value;
+            }
+        }
+        if (registration.power_levels.empty() && error.empty()) {
+            error = "power_levels missing";
+        }
+
+        registration.component.power_state = ComponentPowerState::OFF;
+        registration.component.mode_enabled =
+            (componentModeMask(registration.component) & modeBit(current_mode_)) != 0;
+        registration.component.is_enabled = false;      // ustala rebuild() rejestru z zależności
+        uint32_t handle = error.empty() ? registry_->add(registration, error) : 0;
+
+        auto reply = diagnostic_msgs::msg::DiagnosticStatus();
+        reply.name = msg->name;
+        reply.hardware_id = msg->hardware_id;
+        if (handle != 0) {
+            registry_->applyDependencies();
+            if (!lifecycle_node.empty()) {
+                lifecycle_->manage(msg->name, lifecycle_node);
+            }
+            reply.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+            reply.message = "registered";
+            reply.values.resize(1);
+            reply.values[0].key = "handle";
+            reply.values[0].value = std::to_string(handle);
+            RCLCPP_INFO(this->get_logger(), "Registered component %s (handle %u) for %s",
+                msg->name.c_str(), handle, msg->hardware_id.c_str());
+        } else {
+            reply.level = diagnostic_msgs::msg::DiagnosticStatus::ERROR;
+            reply.message = error;
+            RCLCPP_WARN(this->get_logger(), "Rejected component %s: %s",
+                msg->name.c_str(), error.c_str());
+        }
+        registration_pub_->publish(reply);
+    }
+
+    // Aktualizacja po handle: values: handle, power_level (indeks), duty_cycle, deregister.
+    void componentUpdateCallback(const diagnostic_msgs::msg::DiagnosticStatus::SharedPtr msg) {
+        uint32_t handle = 0;
+        for (const auto& kv : msg->values) {
+            if (kv.key == "handle") {
+                handle = static_cast<uint32_t>(std::strtoul(kv.value.c_str(), nullptr, 10));
             }
         }
+        PowerComponent* comp = registry_->find(handle);
+        if (!comp) {
+            RCLCPP_WARN(this->get_logger(), "Update for unknown component handle %u", handle);
+            return;
+        }
+
+        std::string error;
+        for (const auto& kv : msg->values) {
+            if (kv.key == "power_level") {
+                size_t level = std::strtoul(kv.value.c_str(), nullptr, 10);
+                if (!registry_->selectPowerLevel(handle, level)) {
+                    error = "bad power_level '" + kv.value + "'";
+                }
+            } else if (kv.key == "duty_cycle") {
+                float duty = 1.0f;
+                if (parseFloat(kv.value, duty, error)) {
+                    comp->duty_cycle = std::clamp(duty, 0.0f, 1.0f);
+                }
+            } else if (kv.key == "deregister" && kv.value == "true") {
+                registry_->remove(handle);
+                registry_->applyDependencies();
+                RCLCPP_INFO(this->get_logger(), "Deregistered component handle %u", handle);
+                return;
+            }
+        }
+        if (!error.empty()) {
+            RCLCPP_WARN(this->get_logger(), "Component update %u: %s", handle, error.c_str());
+        }
+    }
+
+    // Zapytanie what-if: name = identyfikator, values: key = nazwa kandydata,
+    // value = sekwencja aktywności (składnia w WhatIfEvaluator::parse). Wynik na
+    // power/whatif/result z tym samym name, jedna wartość na kandydata.
+    // Callback tylko zrzuca punkt kontrolny i prognozę; liczy wątek whatIfLoop(), więc
+    // executor nie czeka na termin. Najwyżej jedno zapytanie czeka, kolejne dostaje "busy".
+    void whatIfCallback(const diagnostic_msgs::msg::DiagnosticStatus::SharedPtr msg) {
+        auto reply = diagnostic_msgs::msg::DiagnosticStatus();
+        reply.name = msg->name;
+        reply.hardware_id = msg->hardware_id;
+
+        auto current_time = this->now();
+        MarsTime mars_time = marsTimeFromUnix(current_time.seconds());
+        double ltst = localTrueSolarTime(mars_time, site_longitude_deg_);
+        auto job = std::make_unique<WhatIfJob>();
+        job->request = msg;
+        job->origin = checkpoint();
+
+        job->candidates.resize(msg->values.size());
+        std::string error;
+        for (size_t i = 0; i < msg->values.size() && error.empty(); ++i) {
+            if (what_if_->parse(msg->values[i].value, *job->origin.metadata, ltst, job->candidates[i], error)) {
+                continue;
+            }
+            error = msg->values[i].key + ": " + error;
+        }
+        if (!error.empty() || job->candidates.empty()) {
+            reply.level = diagnostic_msgs::msg::DiagnosticStatus::ERROR;
+            reply.message = error.empty() ? "no candidates" : error;
+            what_if_result_pub_->publish(reply);
+            return;
+        }
+
+        double step_ltst_hours = what_if_->config().step_s / 3600.0 / kMarsHourHours;
+        job->solar_w.assign(what_if_->horizonSteps(), 0.0f);
+        solar_forecaster_.forecast(site_latitude_deg_, mars_time, ltst, step_ltst_hours,
+                                   job->solar_w.size(), job->solar_w.data());
+        job->start_ltst_hours = ltst;
+        job->sunrise_ltst_hours = solarDay(site_latitude_deg_, mars_time.declination_deg).sunrise_ltst_hours;
+
+        {
+            std::lock_guard<std::mutex> lock(what_if_mutex_);
+            if (!what_if_job_) {
+                what_if_job_ = std::move(job);
+            }
+        }
+        if (job) {
+            reply.level = diagnostic_msgs::msg::DiagnosticStatus::ERROR;
+            reply.message = "busy";
+            what_if_result_pub_->publish(reply);
+            return;
+        }
+        what_if_wake_.notify_one();
+    }
+
+    void whatIfLoop() {
+        while (true) {
+            std::unique_ptr<WhatIfJob> job;
+            {
+                std::unique_lock<std::mutex> lock(what_if_mutex_);
+                what_if_wake_.wait(lock, [this] { return what_if_stopping_ || what_if_job_; });
+                if (what_if_stopping_) {
+                    return;
+                }
+                job = std::move(what_if_job_);
+            }
+            evaluateWhatIf(*job);
+        }
+    }
+
+    // Wątek whatIfLoop(): job zawiera wszystko, czego potrzebuje symulacja (bez stanu węzła).
+    void evaluateWhatIf(const WhatIfJob& job) {
+        const auto& msg = job.request;
+        auto reply = diagnostic_msgs::msg::DiagnosticStatus();
+        reply.name = msg->name;
+        reply.hardware_id = msg->hardware_id;
+
+        WhatIfContext context;
+        context.origin = &job.origin;
+        context.solar_w = job.solar_w.data();
+        context.start_ltst_hours = job.start_ltst_hours;
+        context.sunrise_ltst_hours = job.sunrise_ltst_hours;
+
+        auto start = std::chrono::steady_clock::now();
+        const auto& results = what_if_->evaluate(context, job.candidates);
+        double elapsed_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+        bool complete = true;
+        char line[192];
+        reply.values.resize(results.size());
+        for (size_t i = 0; i < results.size(); ++i) {
+            const WhatIfResult& r = results[i];
+            complete = complete && r.complete;
+            std::snprintf(line, sizeof(line),
+                "complete=%d soc_at_sunrise=%.1f min_soc=%.1f min_soc_h=%.2f emergency_h=%.2f "
+                "shed_h=%.2f transitions=%u",
+                r.complete ? 1 : 0, r.soc_at_sunrise, r.min_soc, r.min_soc_hours,
+                r.emergency_hours, r.shed_hours, r.transitions);
+            reply.values[i].key = msg->values[i].key;
+            reply.values[i].value = line;
+        }
+        reply.level = complete ? diagnostic_msgs::msg::DiagnosticStatus::OK
+                               : diagnostic_msgs::msg::DiagnosticStatus::WARN;
+        std::snprintf(line, sizeof(line), "%zu candidates in %.1f ms%s", results.size(), elapsed_ms,
+                      complete ? "" : " (deadline reached)");
+        reply.message = line;
+        what_if_result_pub_->publish(reply);
+    }
+
+    void removeOrphanedComponents() {
+        if (!registry_->hasRuntimeComponents()) {
+            return;
+        }
+        size_t removed = registry_->removeOrphans(this->get_node_names());
+        if (removed > 0) {
+            registry_->applyDependencies();
+            RCLCPP_WARN(this->get_logger(),
+                "Deregistered %zu component(s) whose owner node disappeared", removed);
+        }
+    }
+
+    static bool parsePriority(const std::string& text, ComponentPriority& priority) {
+        const char* names[] = {"CRITICAL", "HIGH", "MEDIUM", "LOW"};
+        for (int i = 0; i < 4; ++i) {
+            if (text == names[i] || text == std::to_string(i)) {
+                priority = static_cast<ComponentPriority>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static bool parseFloat(const std::string& text, float& value, std::string& error) {
+        char* end = nullptr;
+        float parsed = std::strtof(text.c_str(), &end);
+        if (text.empty() || *end != '\0' || !std::isfinite(parsed) || parsed < 0.0f) {
+            error = "bad number '" + text + "'";
+            return false;
+        }
+        value = parsed;
+        return true;
+    }
+
+    static std::vector<std::string> splitList(const std::string& text) {
+        std::vector<std::string> items;
+        size_t start = 0;
+        while (start <= text.size()) {
+            size_t end = text.find(',', start);
+            if (end == std::string::npos) {
+                end = text.size();
+            }
+            if (end > start) {
+                items.push_back(text.substr(start, end - start));
+            }
+            start = end + 1;
+        }
+        return items;
+    }
+
+    static bool parseFloatList(const std::string& text, std::vector<float>& values) {
+        std::string error;
+        for (const auto& item : splitList(text)) {
+            float value;
+            if (!parseFloat(item, value, error)) {
+                return false;
+            }
+            values.push_back(value);
+        }
+        return !values.empty();
     }
 
     void managementLoop() {
+        advancePowerStates(components_, kManagementPeriodS, modeAllowsWarmHold(current_mode_));
         updatePowerConsumption();
         
-        float power_balance = energy_state_.solar_generation - 
-                             energy_state_.power_consumption;
-        
-        PowerMode target_mode = determineTargetMode(
-            energy_state_.battery_soc, power_balance);
+        ModeDecision decision = currentDecisionInputs();
+        decision.to = determineTargetMode(
+            decision.soc, decision.power_balance, decision.rule, decision.threshold);
+        mode_trace_.recordTick(decision);
         
-        if (target_mode != current_mode_) {
-            switchMode(target_mode);
+        if (decision.to != current_mode_ && modeChangeAllowed(mode_thresholds_, decision.to,
+                static_cast<float>((this->now() - mode_entered_time_).seconds()))) {
+            mode_trace_.recordTransition(decision);
+            switchMode(decision.to, decision.rule);
         }
         
         allocatePower();
+        lifecycle_->sync(components_);
         
         auto power_msg = std_msgs::msg::Float32();
         power_msg.data = getAvailablePower();
         power_budget_pub_->publish(power_msg);
+        publishPowerGrants();
+
+        publishBusState();
+        recordTelemetry();
+        publishDecimatedOutputs();
+        bool recorded = live_history_.append({decision.time_ms * 1e-3,
+                                              energy_state_.battery_soc, energy_state_.power_consumption,
+                                              energy_state_.solar_generation, current_mode_});
+        if (!recorded) {
+            RCLCPP_WARN_ONCE(this->get_logger(), "History chunk pool exhausted by held checkpoints");
+        }
+    }
+
+    std::shared_ptr<const CoreMetadata> coreMetadata() {
+        if (!core_metadata_ || core_metadata_generation_ != registry_->generation()) {
+            auto metadata = std::make_shared<CoreMetadata>();
+            for (const auto& comp : components_) {
+                metadata->names.push_back(comp.name);
+            }
+            metadata->heating_index = heating_index_;
+            core_metadata_ = std::move(metadata);
+            core_metadata_generation_ = registry_->generation();
+        }
+        return core_metadata_;
+    }
+
+    // Przydziały z allocatePower() w kolejności z power/grant_components (latched).
+    // Publikowane tylko przy zmianie większej niż kGrantDeadbandW, z heartbeatem co 1 s.
+    void publishPowerGrants() {
+        size_t count = components_.size();
+        bool changed = registry_->generation() != grant_generation_;
+        if (changed) {
+            grant_generation_ = registry_->generation();
+            auto names_msg = std_msgs::msg::String();
+            for (const auto& comp : components_) {
+                if (!names_msg.data.empty()) {
+                    names_msg.data += ',';
+                }
+                names_msg.data += comp.name;
+            }
+            grant_components_pub_->publish(names_msg);
+
+            grant_msg_.layout.dim.resize(1);
+            grant_msg_.layout.dim[0].label = "grant_w";
+            grant_msg_.layout.dim[0].size = static_cast<uint32_t>(count);
+            grant_msg_.layout.dim[0].stride = static_cast<uint32_t>(count);
+            grant_msg_.data.assign(count, 0.0f);
+        }
+
+        changed = changed || ++grant_ticks_ >= kGrantHeartbeatTicks;
+        for (size_t i = 0; i < count && !changed; ++i) {
+            changed = std::abs(components_[i].current_power - grant_msg_.data[i]) > kGrantDeadbandW;
+        }
+        if (!changed) {
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            grant_msg_.data[i] = components_[i].current_power;
+        }
+        grant_ticks_ = 0;
+        power_grants_pub_->publish(grant_msg_);
+    }
+
+    ModeDecision currentDecisionInputs() const {
+        ModeDecision decision;
+        decision.time_ms = static_cast<uint64_t>(this->now().nanoseconds() / 1000000);
+        decision.from = current_mode_;
+        decision.to = current_mode_;
+        decision.rule = ModeRule::HOLD;
+        decision.soc = energy_state_.battery_soc;
+        decision.power_balance = energy_state_.solar_generation - energy_state_.power_consumption;
+        decision.solar_generation = energy_state_.solar_generation;
+        decision.threshold = NAN;
+        return decision;
+    }
+
+    void modeHistoryCallback(const std::shared_ptr<std_srvs::srv::Trigger::Request>,
+                             std::shared_ptr<std_srvs::srv::Trigger::Response> response) {
+        const auto& transitions = mode_trace_.transitions();
+        char line[192];
+        for (size_t i = 0; i < transitions.size(); ++i) {
+            const ModeDecision& d = transitions[i];
+            std::snprintf(line, sizeof(line),
+                "%llu ms %s -> %s by %s: soc %.1f%% balance %.1f W solar %.1f W threshold %.1f\n",
+                static_cast<unsigned long long>(d.time_ms),
+                powerModeToString(d.from).c_str(), powerModeToString(d.to).c_str(),
+                modeRuleToString(d.rule), d.soc, d.power_balance, d.solar_generation, d.threshold);
+            response->message += line;
+        }
+        response->success = true;
+    }
+
+    // Ślad trafia do strumienia czarnej skrzynki (power/telemetry) jako osobne typy ramek.
+    void exportModeTraceCallback(const std::shared_ptr<std_srvs::srv::Trigger::Request>,
+                                 std::shared_ptr<std_srvs::srv::Trigger::Response> response) {
+        auto frame_msg = std_msgs::msg::UInt8MultiArray();
+        mode_trace_.exportTransitions(frame_msg.data);
+        telemetry_pub_->publish(frame_msg);
+        size_t ticks = 0;
+        if (mode_trace_.tickTraceEnabled()) {
+            ticks = mode_trace_.ticks().size();
+            mode_trace_.exportTicks(frame_msg.data,
+                static_cast<uint16_t>(kManagementPeriodS * 1000.0f + 0.5f));
+            telemetry_pub_->publish(frame_msg);
+        }
+        response->success = true;
+        response->message = "exported " + std::to_string(mode_trace_.transitions().size()) +
+                            " transitions, " + std::to_string(ticks) + " ticks";
+    }
+
+    // Wyjścia power/stats/<nazwa> z listy telemetry.outputs; każde ma parametry
+    // telemetry.<nazwa>.{signal,statistic,rate_hz,deadband}. Domyślne wartości z tabeli
+    // poniżej; nowa nazwa spoza tabeli potrzebuje własnego signal. rate_hz powyżej
+    // częstotliwości pętli zarządzania oznacza wyjście co tick.
+    void initializeDecimatedOutputs() {
+        const DecimatorConfig defaults[] = {
+            {"battery_soc", TelemetrySignal::BATTERY_SOC, AggregateStatistic::LAST, 1, 0.05f},
+            {"battery_soc_mean_1hz", TelemetrySignal::BATTERY_SOC, AggregateStatistic::MEAN, 10, 0.0f},
+            {"solar_generation_mean_1hz", TelemetrySignal::SOLAR_GENERATION, AggregateStatistic::MEAN, 10, 0.5f},
+            {"available_power_mean_1hz", TelemetrySignal::AVAILABLE_POWER, AggregateStatistic::MEAN, 10, 0.5f},
+            {"battery_soc_minmax_60s", TelemetrySignal::BATTERY_SOC, AggregateStatistic::MIN_MAX, 600, 0.0f},
+            {"voltage_minmax_60s", TelemetrySignal::VOLTAGE, AggregateStatistic::MIN_MAX, 600, 0.0f},
+            {"power_consumption_minmax_60s", TelemetrySignal::POWER_CONSUMPTION, AggregateStatistic::MIN_MAX, 600, 0.0f},
+        };
+
+        std::vector<std::string> default_names;
+        for (const auto& config : defaults) {
+            default_names.push_back(config.topic);
+        }
+        std::vector<std::string> names = this->declare_parameter("telemetry.outputs", default_names);
+
+        for (const auto& name : names) {
+            DecimatorConfig config{name, TelemetrySignal::BATTERY_SOC, AggregateStatistic::LAST, 1, 0.0f};
+            for (const auto& preset : defaults) {
+                if (preset.topic == name) {
+                    config = preset;
+                }
+            }
+            std::string prefix = "telemetry." + name + ".";
+            std::string signal = this->declare_parameter(
+                prefix + "signal", std::string(telemetrySignalName(config.signal)));
+            std::string statistic = this->declare_parameter(
+                prefix + "statistic", std::string(aggregateStatisticName(config.statistic)));
+            double rate_hz = this->declare_parameter(
+                prefix + "rate_hz", 1.0 / (config.period_ticks * static_cast<double>(kManagementPeriodS)));
+            double deadband = this->declare_parameter(prefix + "deadband", static_cast<double>(config.deadband));
+            if (!parseTelemetrySignal(signal, config.signal) ||
+                !parseAggregateStatistic(statistic, config.statistic) || !(rate_hz > 0.0) || deadband < 0.0) {
+                RCLCPP_ERROR(this->get_logger(),
+                    "Telemetry output %s skipped: signal '%s', statistic '%s', rate %.3f Hz, deadband %.3f",
+                    name.c_str(), signal.c_str(), statistic.c_str(), rate_hz, deadband);
+                continue;
+            }
+            config.topic = "power/stats/" + name;
+            long period_ticks = std::lround(1.0 / (rate_hz * kManagementPeriodS));
+            config.period_ticks = static_cast<uint32_t>(std::max(1L, period_ticks));
+            config.deadband = static_cast<float>(deadband);
+
+            DecimatedChannel channel{DecimatedOutput(config), nullptr, nullptr};
+            if (config.statistic == AggregateStatistic::MIN_MAX) {
+                channel.range_pub = this->create_publisher<std_msgs::msg::Float32MultiArray>(
+                    config.topic, 10);
+            } else {
+                channel.value_pub = this->create_publisher<std_msgs::msg::Float32>(
+                    config.topic, 10);
+            }
+            decimated_outputs_.push_back(std::move(channel));
+        }
+    }
+
+    void publishDecimatedOutputs() {
+        float available_power = getAvailablePower();
+        AggregateResult result;
+        for (auto& channel : decimated_outputs_) {
+            float value = selectSignal(energy_state_, available_power,
+                                       channel.output.config().signal);
+            if (!channel.output.accumulate(value, result)) {
+                continue;
+            }
+            if (channel.range_pub) {
+                auto range_msg = std_msgs::msg::Float32MultiArray();
+                range_msg.data = {result.min, result.max};
+                channel.range_pub->publish(range_msg);
+            } else {
+                auto value_msg = std_msgs::msg::Float32();
+                value_msg.data = result.value;
+                channel.value_pub->publish(value_msg);
+            }
+        }
+    }
+
+    void recordTelemetry() {
+        uint64_t time_ms = static_cast<uint64_t>(this->now().nanoseconds() / 1000000);
+        if (!telemetry_encoder_.append(energy_state_, components_, time_ms)) {
+            flushTelemetry();
+            telemetry_encoder_.append(energy_state_, components_, time_ms);
+        }
+    }
+
+    void flushTelemetry() {
+        auto frame_msg = std_msgs::msg::UInt8MultiArray();
+        if (telemetry_encoder_.finish(frame_msg.data) > 0) {
+            telemetry_pub_->publish(frame_msg);
+        }
     }
 
     void predictionLoop() {
@@ -173,124 +975,312 @@ private:
         float dt = (current_time - last_prediction_time_).seconds();
         last_prediction_time_ = current_time;
         
-        float predicted_energy = predictEnergyForNextSol();
+        MarsTime mars_time = marsTimeFromUnix(current_time.seconds());
+        float predicted_energy = predictEnergyForNextSol(mars_time);
+        removeOrphanedComponents();
+        checkBusSync();
+        publishPowerQuality();
+        updateArrayArticulation(mars_time);
+        updateHeaterSchedule(mars_time);
+        updateDustStorm(mars_time, current_time);
+        updateEnergyPlan(mars_time, current_time);
+        publishBudgetCurve(mars_time);
         
         RCLCPP_INFO(this->get_logger(), 
-            "Energy prediction for next sol: %.2f Wh | Current SOC: %.1f%% | Mode: %s",
+            "Energy prediction for next sol: %.2f Wh | Current SOC: %.1f%% | Mode: %s | LMST: %.2f h",
             predicted_energy, energy_state_.battery_soc, 
-            powerModeToString(current_mode_).c_str());
+            powerModeToString(current_mode_).c_str(),
+            localMeanSolarTime(mars_time, site_longitude_deg_));
     }
 
-    void updatePowerConsumption() {
-        float total = 0.0f;
-        for (const auto& comp : components_) {
-            if (comp.is_enabled) {
-                total += comp.current_power;
+    void updateArrayArticulation(const MarsTime& mars_time) {
+        int64_t local_sol = static_cast<int64_t>(std::floor(
+            mars_time.msd + site_longitude_deg_ / 360.0));
+        if (local_sol != tilt_schedule_sol_) {
+            tilt_schedule_ = array_optimizer_->optimize(site_latitude_deg_, mars_time);
+            tilt_schedule_sol_ = local_sol;
+            RCLCPP_INFO(this->get_logger(),
+                "Array tilt schedule for sol %lld: %.1f Wh net vs %.1f Wh flat (actuators %.2f Wh)",
+                static_cast<long long>(local_sol), tilt_schedule_.net_energy_wh,
+                tilt_schedule_.flat_energy_wh, tilt_schedule_.actuator_energy_wh);
+        }
+
+        float setpoint = tilt_schedule_.setpointAt(
+            localTrueSolarTime(mars_time, site_longitude_deg_));
+        if (setpoint != last_tilt_setpoint_) {
+            last_tilt_setpoint_ = setpoint;
+            auto tilt_msg = std_msgs::msg::Float32();
+            tilt_msg.data = setpoint;
+            array_tilt_pub_->publish(tilt_msg);
+        }
+    }
+
+    void updateHeaterSchedule(const MarsTime& mars_time) {
+        if (heating_index_ >= components_.size()) {
+            return;
+        }
+        double ltst = localTrueSolarTime(mars_time, site_longitude_deg_);
+        solar_forecaster_.forecast(site_latitude_deg_, mars_time, ltst, kHeaterPlanStepHours,
+                                   kHeaterPlanSteps, heater_surplus_w_.data());
+        float load = modeLoad(current_mode_);
+        for (auto& surplus : heater_surplus_w_) {
+            surplus = std::max(0.0f, surplus - load);
+        }
+
+        // Tryb bez grzania (EMERGENCY): plan zerowy zamiast wypełnienia, którego nikt nie dostarczy
+        bool heater_available = registry_->modeMasks().allows(current_mode_, heating_index_);
+        const HeaterSchedule& schedule = heater_scheduler_->plan(
+            energy_state_.temperature, ltst, kHeaterPlanStepHours, heater_surplus_w_, heater_available);
+        components_[heating_index_].duty_cycle = schedule.duty[0];
+
+        // Plan grzałek trafia do MPC jako rezerwacja mocy w krokach godzinowych
+        double mpc_step_hours = mpc_->config().step_hours;
+        reserveHeaterPower(mpc_step_hours, mpc_step_hours, reserved_power_w_);
+
+        auto schedule_msg = std_msgs::msg::Float32MultiArray();
+        schedule_msg.layout.dim.resize(1);
+        schedule_msg.layout.dim[0].label = "duty_per_15min";
+        schedule_msg.layout.dim[0].size = static_cast<uint32_t>(kHeaterPlanSteps);
+        schedule_msg.layout.dim[0].stride = static_cast<uint32_t>(kHeaterPlanSteps);
+        schedule_msg.data = schedule.duty;
+        heater_schedule_pub_->publish(schedule_msg);
+
+        if (!schedule.survives) {
+            RCLCPP_WARN(this->get_logger(),
+                "Heater schedule cannot hold %.0f C through the night (%.0f Wh planned%s)",
+                heater_scheduler_->config().survival_temp_c, schedule.heater_energy_wh,
+                heater_available ? "" : ", heating disabled in this mode");
+        }
+    }
+
+    // Średnia moc grzałek [W] w przedziałach od teraz; pierwszy przedział może być krótszy.
+    // Przedziały w godzinach ziemskich, krok planu grzałek przeliczony z LTST.
+    void reserveHeaterPower(double first_step_hours, double step_hours, std::vector<float>& reserved_w) const {
+        std::fill(reserved_w.begin(), reserved_w.end(), 0.0f);
+        const HeaterSchedule& schedule = heater_scheduler_->schedule();
+        double plan_step_hours = kHeaterPlanStepHours * kMarsHourHours;
+        for (size_t k = 0; k < schedule.duty.size(); ++k) {
+            double t = k * plan_step_hours;
+            size_t step = t < first_step_hours
+                ? 0 : 1 + static_cast<size_t>((t - first_step_hours) / step_hours);
+            if (step < reserved_w.size()) {
+                reserved_w[step] += static_cast<float>(
+                    schedule.duty[k] * heater_scheduler_->config().heater_power_w * plan_step_hours);
             }
         }
-        energy_state_.power_consumption = total;
+        for (size_t step = 0; step < reserved_w.size(); ++step) {
+            reserved_w[step] /= static_cast<float>(step == 0 ? first_step_hours : step_hours);
+        }
     }
 
-    PowerMode determineTargetMode(float soc, float power_balance) {
-        if (soc < 15.0f) {
-            return PowerMode::EMERGENCY;
+    void publishBudgetCurve(const MarsTime& mars_time) {
+        double ltst = localTrueSolarTime(mars_time, site_longitude_deg_);
+        double first_step_hours = (std::floor(ltst) + 1.0 - ltst) * kMarsHourHours;
+        reserveHeaterPower(first_step_hours, kMarsHourHours, budget_reserved_w_);
+
+        BudgetInputs inputs;
+        inputs.ltst_hours = ltst;
+        inputs.local_sol = static_cast<int64_t>(std::floor(mars_time.msd + site_longitude_deg_ / 360.0));
+        inputs.soc = energy_state_.battery_soc;
+        inputs.battery_capacity_wh = mpc_->config().battery_capacity_wh;
+        inputs.committed_load_w = modeLoad(PowerMode::HIBERNATION);
+        inputs.mode_load_w = modeLoad(current_mode_);
+        inputs.reserved_w = budget_reserved_w_.data();
+
+        const auto& points = budget_curve_.update(solar_forecaster_, site_latitude_deg_, mars_time, inputs);
+        for (size_t k = 0; k < kBudgetSteps; ++k) {
+            budget_msg_.data[3 * k] = points[k].energy_wh;
+            budget_msg_.data[3 * k + 1] = points[k].soc;
+            budget_msg_.data[3 * k + 2] = points[k].confidence;
         }
-        
-        if (energy_state_.solar_generation < 5.0f && soc < 50.0f) {
-            return PowerMode::HIBERNATION;
+        budget_curve_pub_->publish(budget_msg_);
+    }
+
+    // Próbka generacji do estymaty nieprzezroczystości. Trend i stan burzy zmieniają się
+    // raz na sol; w trakcie burzy plan przetrwania jest odświeżany co godzinę marsjańską.
+    void updateDustStorm(const MarsTime& mars_time, const rclcpp::Time& now) {
+        double ltst = localTrueSolarTime(mars_time, site_longitude_deg_);
+        int64_t local_sol = static_cast<int64_t>(std::floor(mars_time.msd + site_longitude_deg_ / 360.0));
+        SolarPosition sun = solarPosition(site_latitude_deg_, mars_time.declination_deg, ltst);
+        bool was_active = storm_monitor_->active();
+        bool closed = storm_monitor_->addSample(local_sol, energy_state_.solar_generation,
+            topOfAtmosphereIrradiance(mars_time.heliocentric_au), std::sin(sun.elevation_deg * kDegToRad));
+        const OpacityTrend& trend = storm_monitor_->trend();
+        bool active = storm_monitor_->active();
+        if (closed) {
+            RCLCPP_INFO(this->get_logger(),
+                "Atmospheric opacity for sol %lld: %.2f (trend %+.3f per sol over %zu sols)",
+                static_cast<long long>(trend.last_sol), trend.opacity, trend.slope, trend.sols);
         }
-        
-        if (soc < 30.0f || power_balance < -10.0f) {
-            return PowerMode::LOW_POWER;
+        if (active != was_active) {
+            RCLCPP_WARN(this->get_logger(), "Dust storm %s: opacity %.2f, trend %+.3f per sol",
+                active ? "detected" : "cleared", trend.opacity, trend.slope);
         }
-        
-        if (soc > 40.0f && power_balance > 0.0f) {
-            return PowerMode::NORMAL;
+
+        int64_t hour = local_sol * 24 + static_cast<int64_t>(std::floor(ltst));
+        if (active && (closed || !was_active || hour != storm_plan_hour_)) {
+            StormPlanInputs inputs;
+            inputs.unix_seconds = now.seconds();
+            inputs.latitude_deg = site_latitude_deg_;
+            inputs.east_longitude_deg = site_longitude_deg_;
+            inputs.soc = energy_state_.battery_soc;
+            inputs.battery_capacity_wh = mpc_->config().battery_capacity_wh;
+            stormLoads(inputs.committed_load_w, inputs.flexible_load_w);
+            inputs.thermal_floor_w = static_cast<float>(survivalHeaterPower(heater_scheduler_->config()));
+            const StormPlan& plan = storm_planner_->update(*storm_monitor_, inputs);
+            storm_plan_hour_ = hour;
+            if (!plan.survives) {
+                RCLCPP_ERROR(this->get_logger(),
+                    "Dust storm survival not assured: SOC falls to %.1f%% in %.1f sols "
+                    "with heating at the thermal floor",
+                    plan.min_soc, plan.min_soc_sols);
+            } else if (plan.flexible_fraction < 1.0f) {
+                RCLCPP_INFO(this->get_logger(),
+                    "Dust storm profile: %.0f%% of flexible load (%.1f W), min SOC %.1f%% in %.1f sols (%.0f us)",
+                    100.0f * plan.flexible_fraction, plan.flexible_budget_w, plan.min_soc,
+                    plan.min_soc_sols, plan.solve_us);
+            }
+        }
+
+        const StormPlan& plan = storm_planner_->plan();
+        storm_msg_.data = {active ? 1.0f : 0.0f, static_cast<float>(trend.opacity),
+                           static_cast<float>(trend.slope), active ? plan.flexible_budget_w : 0.0f,
+                           active ? plan.min_soc : 0.0f, active ? plan.min_soc_sols : 0.0f};
+        dust_storm_pub_->publish(storm_msg_);
+    }
+
+    // Obciążenie trybu DUST_STORM podzielone jak w allocateComponentPower():
+    // elastyczna część (grzanie) podlega budżetowi planu przetrwania.
+    void stormLoads(float& committed_w, float& flexible_w) const {
+        committed_w = 0.0f;
+        flexible_w = 0.0f;
+        for (size_t i = 0; i < components_.size(); ++i) {
+            const auto& comp = components_[i];
+            if (!registry_->modeMasks().allows(PowerMode::DUST_STORM, i)) {
+                continue;
+            }
+            if (comp.priority != ComponentPriority::CRITICAL && !comp.is_essential) {
+                flexible_w += comp.nominal_power;
+            } else {
+                committed_w += comp.nominal_power;
+            }
         }
-        
-        return current_mode_;
     }
 
-    void switchMode(PowerMode new_mode) {
+    void updateEnergyPlan(const MarsTime& mars_time, const rclcpp::Time& now) {
+        double ltst = localTrueSolarTime(mars_time, site_longitude_deg_);
+        solar_forecaster_.calibrate(energy_state_.solar_generation,
+            solar_forecaster_.clearSkyPower(site_latitude_deg_, mars_time, ltst));
+        // W burzy tryb i budżet pochodzą z planu przetrwania; dobowy horyzont MPC jest za krótki
+        if (!mpc_enabled_ || storm_monitor_->active()) {
+            return;
+        }
+
+        const MpcConfig& config = mpc_->config();
+        solar_forecaster_.forecast(site_latitude_deg_, mars_time, ltst, config.step_hours / kMarsHourHours,
+                                   config.horizon_steps, solar_forecast_w_.data());
+        MpcProblem problem;
+        problem.soc = energy_state_.battery_soc;
+        problem.solar_w = solar_forecast_w_.data();
+        problem.reserved_w = reserved_power_w_.data();
+        problem.base_load_w = modeLoad(PowerMode::HIBERNATION);
+        problem.flexible_load_w = modeLoad(PowerMode::NORMAL) - problem.base_load_w;
+
+        const MpcSolution& plan = mpc_->solve(problem);
+        flexible_budget_w_ = plan.service[0] * problem.flexible_load_w;
+        planned_mode_ = PowerMode::HIBERNATION;
+        float tolerance = 0.05f * problem.flexible_load_w;
+        for (PowerMode mode : {PowerMode::NORMAL, PowerMode::LOW_POWER}) {
+            if (modeLoad(mode) <= plan.first_step_load_w + tolerance) {
+                planned_mode_ = mode;
+                break;
+            }
+        }
+        plan_time_ = now;
+        plan_valid_ = true;
+
+        if (!plan.converged) {
+            RCLCPP_WARN(this->get_logger(),
+                "Energy MPC stopped after %zu iterations (%.0f us) without converging",
+                plan.iterations, plan.solve_us);
+        }
+    }
+
+    // Obciążenie elastyczne MPC pomija grzanie (grzałka wchodzi do planu jako rezerwacja),
+    // a przydział liczy grzanie do budżetu elastycznego: bieżący pobór grzałki jest dokładany,
+    // żeby w pełni obsłużony plan nie głodził grzałki ani nauki. Plan burzy liczy grzanie sam.
+    float plannedFlexibleBudget() const {
+        float heater_w = heating_index_ < components_.size() ? powerStateDemand(components_[heating_index_]) : 0.0f;
+        return flexible_budget_w_ + heater_w;
+    }
+
+    bool hasFreshPlan() const {
+        return mpc_enabled_ && plan_valid_ && (this->now() - plan_time_).seconds() < kPlanFreshnessS;
+    }
+
+    // Grzałki są planowane osobno i wchodzą do MPC jako rezerwacje
+    float modeLoad(PowerMode mode) const {
+        float load = 0.0f;
+        for (size_t i = 0; i < components_.size(); ++i) {
+            const auto& comp = components_[i];
+            if (i != heating_index_ && registry_->modeMasks().allows(mode, i)) {
+                load += comp.nominal_power;
+            }
+        }
+        return load;
+    }
+
+    void updatePowerConsumption() {
+        energy_state_.power_consumption = totalPowerConsumption(components_.data(), components_.size());
+    }
+
+    // rule i threshold opisują regułę, która zadziałała (dla śladu decyzji)
+    PowerMode determineTargetMode(float soc, float power_balance, ModeRule& rule, float& threshold) {
+        return selectMode(mode_thresholds_, current_mode_, storm_monitor_->active(), hasFreshPlan(),
+                          planned_mode_, soc, power_balance, energy_state_.solar_generation, rule, threshold);
+    }
+
+    void switchMode(PowerMode new_mode, ModeRule rule) {
         RCLCPP_WARN(this->get_logger(), 
-            "Switching power mode: %s -> %s",
+            "Switching power mode: %s -> %s (%s)",
             powerModeToString(current_mode_).c_str(),
-            powerModeToString(new_mode).c_str());
+            powerModeToString(new_mode).c_str(),
+            modeRuleToString(rule));
         
+        PowerMode previous_mode = current_mode_;
         current_mode_ = new_mode;
         energy_state_.mode = new_mode;
+        mode_entered_time_ = this->now();
     
         auto mode_msg = std_msgs::msg::String();
         mode_msg.data = powerModeToString(new_mode);
         power_mode_pub_->publish(mode_msg);
         
-        adjustComponentsForMode(new_mode);
+        adjustComponentsForMode(previous_mode, new_mode);
     }
 
-    void adjustComponentsForMode(PowerMode mode) {
-        switch (mode) {
-            case PowerMode::NORMAL:
-                // Wszystkie komponenty włączone
-                for (auto& comp : components_) {
-                    comp.is_enabled = true;
-                }
-                break;
-                
-            case PowerMode::LOW_POWER:
-                for (auto& comp : components_) {
-                    if (comp.priority == ComponentPriority::LOW) {
-                        comp.is_enabled = false;
-                    }
-                    if (comp.name == "cameras") {
-                        comp.is_enabled = false;
-                    }
-                }
-                break;
-                
-            case PowerMode::HIBERNATION:
-                for (auto& comp : components_) {
-                    if (comp.priority != ComponentPriority::CRITICAL && !comp.is_essential) {
-                        comp.is_enabled = false;
-                    }
-                }
-                break;
-                
-            case PowerMode::EMERGENCY:
-                for (auto& comp : components_) {
-                    if (comp.priority == ComponentPriority::CRITICAL) {
-                        comp.is_enabled = true;
-                    } else {
-                        comp.is_enabled = false;
-                    }
-                }
-                break;
+    // Zmiana składu jako różnica masek; zmienione komponenty (razem z kaskadą zależności)
+    // trafiają do logu i do koordynatora lifecycle.
+    void adjustComponentsForMode(PowerMode from, PowerMode mode) {
+        uint32_t before = enabledMask(components_.data(), components_.size());
+        applyModeMask(components_.data(), components_.size(), registry_->modeMasks(), from, mode);
+        registry_->applyDependencies();
+        uint32_t changed = before ^ enabledMask(components_.data(), components_.size());
+        for (uint32_t bits = changed; bits != 0; bits &= bits - 1) {
+            const auto& comp = components_[__builtin_ctz(bits)];
+            RCLCPP_INFO(this->get_logger(), "Component %s %s",
+                comp.name.c_str(), comp.is_enabled ? "enabled" : "disabled");
         }
+        lifecycle_->componentsChanged(components_, changed);
     }
 
     void allocatePower() {
         float available_power = energy_state_.solar_generation;
-    
-        std::vector<PowerComponent*> sorted_components;
-        for (auto& comp : components_) {
-            if (comp.is_enabled) {
-                sorted_components.push_back(&comp);
-            }
-        }
-        
-        std::sort(sorted_components.begin(), sorted_components.end(),
-            [](const PowerComponent* a, const PowerComponent* b) {
-                return a->priority < b->priority;
-            });
-        
-        for (auto* comp : sorted_components) {
-            if (available_power >= comp->nominal_power) {
-                comp->current_power = comp->nominal_power;
-                available_power -= comp->nominal_power;
-            } else {
-                comp->current_power = available_power;
-                available_power = 0.0f;
-            }
-        }
+        float flexible_budget = storm_monitor_->active() ? storm_planner_->plan().flexible_budget_w
+                              : hasFreshPlan() ? plannedFlexibleBudget() : available_power;
+        const auto& order = registry_->allocationOrder();
+        allocateComponentPower(components_.data(), order.data(), order.size(),
+                               available_power, flexible_budget);
     }
 
     float getCriticalPowerConsumption() const {
@@ -303,10 +1293,11 @@ private:
         return critical_power;
     }
 
-    float predictEnergyForNextSol() {
+    float predictEnergyForNextSol(const MarsTime& mars_time) {
         float avg_solar_generation = 80.0f; // Średnia generacja [W]
-        float sol_duration = 24.6f * 3600.0f; // Czas sola [s]
-        float daylight_fraction = 0.5f; // 50% czasu to dzień
+        float sol_duration = static_cast<float>(kSolSeconds); // Czas sola [s]
+        float daylight_fraction = static_cast<float>(
+            solarDay(site_latitude_deg_, mars_time.declination_deg).daylight_fraction);
         
         float predicted_generation = avg_solar_generation * sol_duration * 
                                     daylight_fraction / 3600.0f; // [Wh]
@@ -323,22 +1314,118 @@ private:
             case PowerMode::LOW_POWER: return "LOW_POWER";
             case PowerMode::HIBERNATION: return "HIBERNATION";
             case PowerMode::EMERGENCY: return "EMERGENCY";
+            case PowerMode::DUST_STORM: return "DUST_STORM";
             default: return "UNKNOWN";
         }
     }
 
     PowerMode current_mode_;
     EnergyState energy_state_;
+    ModeThresholds mode_thresholds_;
+    rclcpp::Time mode_entered_time_;
+    ModeTrace mode_trace_;
     std::vector<PowerComponent> components_;
+    std::unique_ptr<ComponentRegistry> registry_;
+    std::unique_ptr<LifecycleCoordinator> lifecycle_;
+    static constexpr size_t kLiveHistoryChunks = 140;  // ~1 h przy 10 Hz
+    History live_history_{kLiveHistoryChunks};
+    std::shared_ptr<const CoreMetadata> core_metadata_;
+    std::unique_ptr<ThreadPool> what_if_pool_;
+    std::unique_ptr<WhatIfEvaluator> what_if_;
+    std::mutex what_if_mutex_;
+    std::condition_variable what_if_wake_;
+    std::unique_ptr<WhatIfJob> what_if_job_;        // oczekujące zapytanie, najwyżej jedno
+    bool what_if_stopping_ = false;
+    std::thread what_if_thread_;
+    uint32_t core_metadata_generation_ = 0;
     rclcpp::Time last_prediction_time_;
+    double site_latitude_deg_;
+    double site_longitude_deg_;
+
+    ThreadPool worker_pool_;
+    std::unique_ptr<ArrayArticulationOptimizer> array_optimizer_;
+    TiltSchedule tilt_schedule_;
+    int64_t tilt_schedule_sol_ = -1;
+    float last_tilt_setpoint_ = NAN;
+
+    SolarForecaster solar_forecaster_;
+    std::unique_ptr<EnergyMpc> mpc_;
+    bool mpc_enabled_;
+    std::vector<float> solar_forecast_w_;
+    std::vector<float> reserved_power_w_;
+    bool plan_valid_ = false;
+    rclcpp::Time plan_time_;
+    PowerMode planned_mode_ = PowerMode::NORMAL;
+    float flexible_budget_w_ = 0.0f;
+
+    std::unique_ptr<DustStormMonitor> storm_monitor_;
+    std::unique_ptr<StormSurvivalPlanner> storm_planner_;
+    int64_t storm_plan_hour_ = -1;
+    std_msgs::msg::Float32MultiArray storm_msg_;
+
+    static constexpr size_t kQualityFields = 6 + kPowerQualityBands + 1;
+    static_assert(kPowerQualityBands == 4, "power/quality layout lists four bands");
+    std::unique_ptr<PowerQualityAnalyzer> power_quality_;
+    std_msgs::msg::Float32MultiArray quality_msg_;
+
+    static constexpr float kManagementPeriodS = 0.1f;
+    static constexpr size_t kHeaterPlanSteps = 99;
+    static constexpr double kHeaterPlanStepHours = 0.25;       // [h LTST]
+    std::unique_ptr<HeaterScheduler> heater_scheduler_;
+    BudgetCurve budget_curve_;
+    std::vector<float> budget_reserved_w_;
+    std_msgs::msg::Float32MultiArray budget_msg_;
+    std::vector<float> heater_surplus_w_;
+    size_t heating_index_ = SIZE_MAX;
+    TelemetryEncoder telemetry_encoder_;
+
+    static constexpr size_t kBusSyncDepth = 16;
+    static constexpr size_t kBusVoltageInput = 0;
+    static constexpr size_t kBusCurrentInput = 1;
+    ApproximateTimeSync<kBusSyncDepth> bus_sync_{0};
+    SyncStats bus_sync_reported_;
+    double bus_power_sum_w_ = 0.0;
+    uint32_t bus_power_samples_ = 0;
+
+    static constexpr float kGrantDeadbandW = 0.1f;
+    static constexpr uint32_t kGrantHeartbeatTicks = 10;
+    std_msgs::msg::Float32MultiArray grant_msg_;
+    uint32_t grant_generation_ = UINT32_MAX;
+    uint32_t grant_ticks_ = 0;
+
+    struct DecimatedChannel {
+        DecimatedOutput output;
+        rclcpp::Publisher<std_msgs::msg::Float32>::SharedPtr value_pub;
+        rclcpp::Publisher<std_msgs::msg::Float32MultiArray>::SharedPtr range_pub;
+    };
+    std::vector<DecimatedChannel> decimated_outputs_;
 
     rclcpp::Publisher<std_msgs::msg::String>::SharedPtr power_mode_pub_;
     rclcpp::Publisher<std_msgs::msg::Float32>::SharedPtr battery_status_pub_;
+    rclcpp::Publisher<std_msgs::msg::Float32>::SharedPtr bus_power_pub_;
     rclcpp::Publisher<std_msgs::msg::Float32>::SharedPtr power_budget_pub_;
+    rclcpp::Publisher<std_msgs::msg::Float32MultiArray>::SharedPtr power_grants_pub_;
+    rclcpp::Publisher<std_msgs::msg::String>::SharedPtr grant_components_pub_;
+    rclcpp::Publisher<std_msgs::msg::UInt8MultiArray>::SharedPtr telemetry_pub_;
+    rclcpp::Publisher<std_msgs::msg::Float32>::SharedPtr array_tilt_pub_;
+    rclcpp::Publisher<std_msgs::msg::Float32MultiArray>::SharedPtr heater_schedule_pub_;
+    rclcpp::Publisher<std_msgs::msg::Float32MultiArray>::SharedPtr budget_curve_pub_;
+    rclcpp::Publisher<std_msgs::msg::Float32MultiArray>::SharedPtr dust_storm_pub_;
+    rclcpp::Publisher<std_msgs::msg::Float32MultiArray>::SharedPtr power_quality_pub_;
 
-    rclcpp::Subscription<std_msgs::msg::Float32>::SharedPtr battery_sub_;
+    rclcpp::Subscription<sensor_msgs::msg::BatteryState>::SharedPtr battery_sub_;
+    rclcpp::Subscription<sensor_msgs::msg::BatteryState>::SharedPtr bus_current_sub_;
     rclcpp::Subscription<std_msgs::msg::Float32>::SharedPtr solar_sub_;
+    rclcpp::Subscription<std_msgs::msg::Float32>::SharedPtr temperature_sub_;
     rclcpp::Subscription<geometry_msgs::msg::Twist>::SharedPtr cmd_vel_sub_;
+    rclcpp::Subscription<diagnostic_msgs::msg::DiagnosticStatus>::SharedPtr register_sub_;
+    rclcpp::Subscription<diagnostic_msgs::msg::DiagnosticStatus>::SharedPtr component_update_sub_;
+    rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticStatus>::SharedPtr registration_pub_;
+    rclcpp::Subscription<diagnostic_msgs::msg::DiagnosticStatus>::SharedPtr what_if_sub_;
+    rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticStatus>::SharedPtr what_if_result_pub_;
+
+    rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr mode_history_srv_;
+    rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr mode_trace_export_srv_;
 
     rclcpp::TimerBase::SharedPtr management_timer_;
     rclcpp::TimerBase::SharedPtr prediction_timer_;
@@ -0,0 +1,200 @@
+#ifndef MARS_TIME_HPP
+#define MARS_TIME_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace rover_energy {
+
+// Czas marsjański wg Allison & McEwen (2000), algorytm Mars24.
+static constexpr double kSolSeconds = 88775.244;
+static constexpr double kSolHours = kSolSeconds / 3600.0;
+static constexpr double kMarsHourHours = kSolHours / 24.0;     // godzina LTST w godzinach ziemskich
+static constexpr double kSolToEarthDay = 1.0274912517;
+static constexpr double kTtMinusUtcSeconds = 69.184;
+static constexpr double kDegToRad = 3.14159265358979323846 / 180.0;
+static constexpr double kRadToDeg = 180.0 / 3.14159265358979323846;
+static constexpr double kSolarConstantAt1Au = 1361.0; // [W/m2]
+
+struct PlanetaryPerturbation {
+    double amplitude_deg;
+    double rate_deg_per_day; // 0.985626 / tau
+    double phase_deg;
+};
+
+static constexpr std::array<PlanetaryPerturbation, 7> kMarsPerturbations = {{
+    {0.0071, 0.985626 / 2.2353, 49.409},
+    {0.0057, 0.985626 / 2.7543, 168.173},
+    {0.0039, 0.985626 / 1.1177, 191.837},
+    {0.0037, 0.985626 / 15.7866, 21.736},
+    {0.0021, 0.985626 / 2.1354, 15.704},
+    {0.0020, 0.985626 / 2.4694, 95.528},
+    {0.0018, 0.985626 / 32.8493, 49.095},
+}};
+
+struct MarsTime {
+    double msd;                  // Mars Sol Date
+    double mst_hours;            // czas na południku zerowym
+    double ls_deg;               // długość areocentryczna Słońca
+    double eot_deg;              // równanie czasu
+    double declination_deg;
+    double heliocentric_au;
+};
+
+struct SolarPosition {
+    double elevation_deg;
+    double azimuth_deg;          // od północy, zgodnie z ruchem wskazówek
+};
+
+struct SolarDay {
+    double sunrise_ltst_hours;
+    double sunset_ltst_hours;
+    double daylight_fraction;
+};
+
+inline double wrapDegrees(double deg) {
+    deg = std::fmod(deg, 360.0);
+    return deg < 0.0 ? deg + 360.0 : deg;
+}
+
+inline double wrapHours(double hours) {
+    hours = std::fmod(hours, 24.0);
+    return hours < 0.0 ? hours + 24.0 : hours;
+}
+
+inline double solarDeclinationDeg(double ls_deg) {
+    double sin_ls = std::sin(ls_deg * kDegToRad);
+    return std::asin(0.42565 * sin_ls) * kRadToDeg + 0.25 * sin_ls;
+}
+
+inline MarsTime marsTimeFromUnix(double unix_seconds) {
+    double jd_tt = 2440587.5 + (unix_seconds + kTtMinusUtcSeconds) / 86400.0;
+    double dt_j2000 = jd_tt - 2451545.0;
+
+    double m_deg = wrapDegrees(19.3871 + 0.52402073 * dt_j2000);
+    double alpha_fms = 270.3871 + 0.524038496 * dt_j2000;
+    double pbs = 0.0;
+    for (const auto& p : kMarsPerturbations) {
+        pbs += p.amplitude_deg * std::cos((p.rate_deg_per_day * dt_j2000 + p.phase_deg) * kDegToRad);
+    }
+    double m = m_deg * kDegToRad;
+    double eoc = (10.691 + 3.0e-7 * dt_j2000) * std::sin(m) + 0.623 * std::sin(2.0 * m) +
+                 0.050 * std::sin(3.0 * m) + 0.005 * std::sin(4.0 * m) +
+                 0.0005 * std::sin(5.0 * m) + pbs;
+
+    MarsTime t;
+    t.ls_deg = wrapDegrees(alpha_fms + eoc);
+    double ls = t.ls_deg * kDegToRad;
+    t.eot_deg = 2.861 * std::sin(2.0 * ls) - 0.071 * std::sin(4.0 * ls) +
+                0.002 * std::sin(6.0 * ls) - eoc;
+    t.msd = (jd_tt - 2451549.5) / kSolToEarthDay + 44796.0 - 0.0009626;
+    t.mst_hours = wrapHours(24.0 * t.msd);
+    t.declination_deg = solarDeclinationDeg(t.ls_deg);
+    t.heliocentric_au = 1.52367934 * (1.00436 - 0.09309 * std::cos(m) - 0.004336 * std::cos(2.0 * m) -
+                                      0.00031 * std::cos(3.0 * m) - 0.00003 * std::cos(4.0 * m));
+    return t;
+}
+
+inline double localMeanSolarTime(const MarsTime& t, double east_longitude_deg) {
+    return wrapHours(t.mst_hours + east_longitude_deg / 15.0);
+}
+
+inline double localTrueSolarTime(const MarsTime& t, double east_longitude_deg) {
+    return wrapHours(localMeanSolarTime(t, east_longitude_deg) + t.eot_deg / 15.0);
+}
+
+inline double topOfAtmosphereIrradiance(double heliocentric_au) {
+    return kSolarConstantAt1Au / (heliocentric_au * heliocentric_au);
+}
+
+inline SolarPosition solarPosition(double latitude_deg, double declination_deg, double ltst_hours) {
+    double lat = latitude_deg * kDegToRad;
+    double dec = declination_deg * kDegToRad;
+    double h = (ltst_hours - 12.0) * 15.0 * kDegToRad;
+    double sin_el = std::sin(lat) * std::sin(dec) + std::cos(lat) * std::cos(dec) * std::cos(h);
+    double el = std::asin(std::max(-1.0, std::min(1.0, sin_el)));
+    double az = std::atan2(-std::cos(dec) * std::sin(h),
+                           std::cos(lat) * std::sin(dec) - std::sin(lat) * std::cos(dec) * std::cos(h));
+    return {el * kRadToDeg, wrapDegrees(az * kRadToDeg)};
+}
+
+inline SolarDay solarDay(double latitude_deg, double declination_deg) {
+    double lat = latitude_deg * kDegToRad;
+    double dec = declination_deg * kDegToRad;
+    double cos_h0 = -std::tan(lat) * std::tan(dec);
+    SolarDay day;
+    if (cos_h0 <= -1.0) {
+        day = {0.0, 24.0, 1.0};     // dzień polarny
+    } else if (cos_h0 >= 1.0) {
+        day = {12.0, 12.0, 0.0};    // noc polarna
+    } else {
+        double h0_hours = std::acos(cos_h0) * kRadToDeg / 15.0;
+        day = {12.0 - h0_hours, 12.0 + h0_hours, h0_hours / 12.0};
+    }
+    return day;
+}
+
+// Geometria na jeden sol: deklinację traktujemy jako stałą w ciągu sola,
+// cos(kąta godzinnego) liczymy rekurencją obrotu zamiast trygonometrii na próbkę.
+class SolarGeometryBatch {
+public:
+    SolarGeometryBatch(double latitude_deg, double declination_deg) {
+        double lat = latitude_deg * kDegToRad;
+        double dec = declination_deg * kDegToRad;
+        sin_lat_ = std::sin(lat);
+        cos_lat_ = std::cos(lat);
+        sin_dec_ = std::sin(dec);
+        cos_dec_ = std::cos(dec);
+        a_ = sin_lat_ * sin_dec_;
+        b_ = cos_lat_ * cos_dec_;
+    }
+
+    // sin(elewacji) dla n próbek LTST od start_hours co step_hours.
+    void sinElevation(double start_hours, double step_hours, size_t n, float* out) const {
+        double c, s, dc, ds;
+        rotationStart(start_hours, step_hours, c, s, dc, ds);
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = static_cast<float>(a_ + b_ * c);
+            rotate(c, s, dc, ds);
+        }
+    }
+
+    // Składowe wektora do Słońca w układzie (wschód, północ, zenit).
+    void sunVectors(double start_hours, double step_hours, size_t n,
+                    float* east, float* north, float* up) const {
+        double c, s, dc, ds;
+        rotationStart(start_hours, step_hours, c, s, dc, ds);
+        for (size_t i = 0; i < n; ++i) {
+            east[i] = static_cast<float>(-cos_dec_ * s);
+            north[i] = static_cast<float>(cos_lat_ * sin_dec_ - sin_lat_ * cos_dec_ * c);
+            up[i] = static_cast<float>(a_ + b_ * c);
+            rotate(c, s, dc, ds);
+        }
+    }
+
+private:
+    static void rotationStart(double start_hours, double step_hours,
+                              double& c, double& s, double& dc, double& ds) {
+        double h = (start_hours - 12.0) * 15.0 * kDegToRad;
+        double dh = step_hours * 15.0 * kDegToRad;
+        c = std::cos(h);
+        s = std::sin(h);
+        dc = std::cos(dh);
+        ds = std::sin(dh);
+    }
+
+    static void rotate(double& c, double& s, double dc, double ds) {
+        double next_c = c * dc - s * ds;
+        s = s * dc + c * ds;
+        c = next_c;
+    }
+
+    double sin_lat_, cos_lat_, sin_dec_, cos_dec_;
+    double a_, b_;
+};
+
+}
+
+#endif // MARS_TIME_HPP
@@ -0,0 +1,276 @@
+#ifndef MODE_TRACE_HPP
+#define MODE_TRACE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "power_types.hpp"
+#include "telemetry_codec.hpp"
+
+namespace rover_energy {
+
+// Ramki śladu decyzji w formacie czarnej skrzynki (nagłówek jak TelemetryFrameType::ENERGY)
+static constexpr uint8_t kModeTransitionFrameType = 2;
+static constexpr uint8_t kModeTickFrameType = 3;
+static constexpr uint8_t kTickTimeOffset = 0x80;   // bajt mode|rule<<3 ticka: po nim odchyłka czasu
+
+static_assert(static_cast<unsigned>(ModeRule::DUST_STORM) < 16, "ModeRule no longer fits below the tick time flag");
+
+inline const char* modeRuleToString(ModeRule rule) {
+    switch (rule) {
+        case ModeRule::HOLD: return "HOLD";
+        case ModeRule::CRITICAL_SOC: return "CRITICAL_SOC";
+        case ModeRule::MPC_PLAN: return "MPC_PLAN";
+        case ModeRule::NIGHT_LOW_SOC: return "NIGHT_LOW_SOC";
+        case ModeRule::LOW_SOC: return "LOW_SOC";
+        case ModeRule::POWER_DEFICIT: return "POWER_DEFICIT";
+        case ModeRule::RECOVERED: return "RECOVERED";
+        case ModeRule::COMMANDED: return "COMMANDED";
+        case ModeRule::DUST_STORM: return "DUST_STORM";
+    }
+    return "UNKNOWN";
+}
+
+struct ModeDecision {
+    uint64_t time_ms;       // ms uniksowe
+    PowerMode from;
+    PowerMode to;
+    ModeRule rule;
+    float soc;
+    float power_balance;
+    float solar_generation;
+    float threshold;        // próg reguły, która zadziałała; NAN gdy reguła nie ma progu
+};
+
+// Skwantowany ślad co tick: 16 B na cykl zarządzania.
+struct ModeTick {
+    uint64_t time_ms;
+    int16_t soc;            // [0.01 %]
+    int16_t power_balance;  // [0.1 W]
+    int16_t solar;          // [0.1 W]
+    uint8_t mode;
+    uint8_t rule;
+};
+
+// Bufor cykliczny o stałej pojemności; push() nadpisuje najstarszy wpis.
+template <typename T, size_t N>
+class FixedRing {
+public:
+    void push(const T& value) {
+        items_[head_] = value;
+        head_ = (head_ + 1) % N;
+        if (size_ < N) {
+            ++size_;
+        }
+    }
+
+    size_t size() const { return size_; }
+    static constexpr size_t capacity() { return N; }
+
+    // i = 0 to najstarszy wpis
+    const T& operator[](size_t i) const { return items_[(head_ + N - size_ + i) % N]; }
+
+private:
+    std::array<T, N> items_{};
+    size_t head_ = 0;
+    size_t size_ = 0;
+};
+
+// Zapis śladu nie alokuje i nie formatuje; tekst i ramki powstają dopiero na żądanie.
+class ModeTrace {
+public:
+    static constexpr size_t kTransitionCapacity = 64;
+    static constexpr size_t kTickCapacity = 600;
+
+    void setTickTraceEnabled(bool enabled) { tick_trace_enabled_ = enabled; }
+    bool tickTraceEnabled() const { return tick_trace_enabled_; }
+
+    void recordTransition(const ModeDecision& decision) { transitions_.push(decision); }
+
+    void recordTick(const ModeDecision& decision) {
+        if (!tick_trace_enabled_) {
+            return;
+        }
+        ModeTick tick;
+        tick.time_ms = decision.time_ms;
+        tick.soc = quantize(decision.soc, 100.0f);
+        tick.power_balance = quantize(decision.power_balance, 10.0f);
+        tick.solar = quantize(decision.solar_generation, 10.0f);
+        tick.mode = static_cast<uint8_t>(decision.to);
+        tick.rule = static_cast<uint8_t>(decision.rule);
+        ticks_.push(tick);
+    }
+
+    const FixedRing<ModeDecision, kTransitionCapacity>& transitions() const { return transitions_; }
+    const FixedRing<ModeTick, kTickCapacity>& ticks() const { return ticks_; }
+
+    // Rekord przejścia: varint czasu od base, bajt from|to<<3, bajt reguły,
+    // zigzag SOC [0.01 %], bilans i generacja [0.1 W], próg [0.01] (kTelemetryInvalid = brak).
+    size_t exportTransitions(std::vector<uint8_t>& out) {
+        size_t n = transitions_.size();
+        out.assign(kTelemetryHeaderBytes + n * 32, 0);
+        uint64_t base = n > 0 ? transitions_[0].time_ms : 0;
+        uint8_t* p = out.data() + kTelemetryHeaderBytes;
+        for (size_t i = 0; i < n; ++i) {
+            const ModeDecision& d = transitions_[i];
+            p = writeVarint64(p, d.time_ms - base);
+            *p++ = static_cast<uint8_t>(static_cast<uint8_t>(d.from) | (static_cast<uint8_t>(d.to) << 3));
+            *p++ = static_cast<uint8_t>(d.rule);
+            p = writeVarint(p, zigzagEncode(quantizeTelemetry(d.soc, 100.0f)));
+            p = writeVarint(p, zigzagEncode(quantizeTelemetry(d.power_balance, 10.0f)));
+            p = writeVarint(p, zigzagEncode(quantizeTelemetry(d.solar_generation, 10.0f)));
+            p = writeVarint(p, zigzagEncode(quantizeTelemetry(d.threshold, 100.0f)));
+        }
+        return finishFrame(out, p, kModeTransitionFrameType, n, base, 0);
+    }
+
+    // Rekord ticka: bajt mode|rule<<3, zigzag delt SOC, bilansu i generacji względem
+    // poprzedniego ticka; czas to poprzedni + tick_ms z nagłówka, a odchyłkę [ms]
+    // niesie varint zigzag po bajcie trybu, gdy ustawiony jest jego najwyższy bit.
+    size_t exportTicks(std::vector<uint8_t>& out, uint16_t tick_ms) {
+        size_t n = ticks_.size();
+        out.assign(kTelemetryHeaderBytes + n * 21, 0);
+        uint64_t base = n > 0 ? ticks_[0].time_ms : 0;
+        uint8_t* p = out.data() + kTelemetryHeaderBytes;
+        ModeTick last{};
+        last.time_ms = base - tick_ms;
+        for (size_t i = 0; i < n; ++i) {
+            const ModeTick& t = ticks_[i];
+            int64_t offset = std::clamp<int64_t>(static_cast<int64_t>(t.time_ms - last.time_ms) - tick_ms,
+                                                 INT32_MIN, INT32_MAX);
+            uint8_t control = static_cast<uint8_t>(t.mode | (t.rule << 3));
+            if (offset != 0) {
+                control |= kTickTimeOffset;
+            }
+            *p++ = control;
+            if (offset != 0) {
+                p = writeVarint(p, zigzagEncode(static_cast<int32_t>(offset)));
+            }
+            p = writeVarint(p, zigzagEncode(t.soc - last.soc));
+            p = writeVarint(p, zigzagEncode(t.power_balance - last.power_balance));
+            p = writeVarint(p, zigzagEncode(t.solar - last.solar));
+            last = t;
+        }
+        return finishFrame(out, p, kModeTickFrameType, n, base, tick_ms);
+    }
+
+private:
+    static int16_t quantize(float value, float scale) {
+        return static_cast<int16_t>(std::lround(std::fmax(-32768.0f, std::fmin(32767.0f, value * scale))));
+    }
+
+    size_t finishFrame(std::vector<uint8_t>& out, uint8_t* end, uint8_t type, size_t count,
+                       uint64_t base_time_ms, uint16_t tick_ms) {
+        TelemetryFrameHeader header;
+        header.magic = kTelemetryMagic;
+        header.version = kTelemetryVersion;
+        header.type = type;
+        header.sequence = sequence_++;
+        header.sample_count = static_cast<uint16_t>(count);
+        header.component_count = 0;
+        header.flags = 0;
+        header.tick_ms = tick_ms;
+        header.base_time_ms = base_time_ms;
+        header.payload_bytes = static_cast<uint16_t>(end - out.data() - kTelemetryHeaderBytes);
+        header.crc = telemetryCrc16(out.data() + kTelemetryHeaderBytes, header.payload_bytes);
+        writeTelemetryHeader(out.data(), header);
+        out.resize(kTelemetryHeaderBytes + header.payload_bytes);
+        return out.size();
+    }
+
+    FixedRing<ModeDecision, kTransitionCapacity> transitions_;
+    FixedRing<ModeTick, kTickCapacity> ticks_;
+    bool tick_trace_enabled_ = false;
+    uint16_t sequence_ = 0;
+};
+
+// Dekoder naziemny ramki przejść.
+inline bool decodeModeTransitions(const uint8_t* data, size_t len, std::vector<ModeDecision>& out) {
+    TelemetryFrameHeader h;
+    if (!readTelemetryHeader(data, len, h) || h.type != kModeTransitionFrameType) {
+        return false;
+    }
+    const uint8_t* in = data + kTelemetryHeaderBytes;
+    const uint8_t* end = in + h.payload_bytes;
+    if (telemetryCrc16(in, h.payload_bytes) != h.crc) {
+        return false;
+    }
+    out.clear();
+    for (size_t i = 0; i < h.sample_count; ++i) {
+        uint64_t offset;
+        uint32_t v[5];
+        ModeDecision d;
+        if (!(in = readVarint64(in, end, offset)) || end - in < 2) {
+            return false;
+        }
+        d.time_ms = h.base_time_ms + offset;
+        d.from = static_cast<PowerMode>(in[0] & 0x07);
+        d.to = static_cast<PowerMode>(in[0] >> 3);
+        d.rule = static_cast<ModeRule>(in[1]);
+        in += 2;
+        for (int k = 1; k < 5; ++k) {
+            if (!(in = readVarint(in, end, v[k]))) {
+                return false;
+            }
+        }
+        d.soc = dequantizeTelemetry(zigzagDecode(v[1]), 100.0f);
+        d.power_balance = dequantizeTelemetry(zigzagDecode(v[2]), 10.0f);
+        d.solar_generation = dequantizeTelemetry(zigzagDecode(v[3]), 10.0f);
+        d.threshold = dequantizeTelemetry(zigzagDecode(v[4]), 100.0f);
+        out.push_back(d);
+    }
+    return true;
+}
+
+// Dekoder naziemny ramki ticków (odwrotność exportTicks()).
+inline bool decodeModeTicks(const uint8_t* data, size_t len, std::vector<ModeTick>& out) {
+    TelemetryFrameHeader h;
+    if (!readTelemetryHeader(data, len, h) || h.type != kModeTickFrameType) {
+        return false;
+    }
+    const uint8_t* in = data + kTelemetryHeaderBytes;
+    const uint8_t* end = in + h.payload_bytes;
+    if (telemetryCrc16(in, h.payload_bytes) != h.crc) {
+        return false;
+    }
+    out.clear();
+    ModeTick last{};
+    last.time_ms = h.base_time_ms - h.tick_ms;
+    for (size_t i = 0; i < h.sample_count; ++i) {
+        if (in == end) {
+            return false;
+        }
+        uint8_t control = *in++;
+        int64_t offset = 0;
+        uint32_t v[3];
+        if (control & kTickTimeOffset) {
+            if (!(in = readVarint(in, end, v[0]))) {
+                return false;
+            }
+            offset = zigzagDecode(v[0]);
+        }
+        for (int k = 0; k < 3; ++k) {
+            if (!(in = readVarint(in, end, v[k]))) {
+                return false;
+            }
+        }
+        ModeTick t;
+        t.time_ms = last.time_ms + static_cast<uint64_t>(h.tick_ms + offset);
+        t.soc = static_cast<int16_t>(last.soc + zigzagDecode(v[0]));
+        t.power_balance = static_cast<int16_t>(last.power_balance + zigzagDecode(v[1]));
+        t.solar = static_cast<int16_t>(last.solar + zigzagDecode(v[2]));
+        t.mode = control & 0x07;
+        t.rule = (control & 0x7f) >> 3;
+        out.push_back(t);
+        last = t;
+    }
+    return true;
+}
+
+}
+
+#endif // MODE_TRACE_HPP
@@ -0,0 +1,300 @@
+#ifndef POLICY_TUNING_HPP
+#define POLICY_TUNING_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "batch_simulator.hpp"
+#include "energy_core.hpp"
+
+namespace rover_energy {
+
+// CMA-ES (mu/mu_w, lambda) z aktualizacją rank-one i rank-mu, minimalizacja.
+// Przestrzeń znormalizowana do [0, 1]^n; próbki poza pudełkiem są przycinane.
+class CmaEs {
+public:
+    CmaEs(const std::vector<double>& mean, double sigma, uint64_t seed)
+        : n_(mean.size()), mean_(mean), sigma_(sigma), rng_(seed) {
+        lambda_ = 4 + static_cast<size_t>(3.0 * std::log(static_cast<double>(n_)));
+        mu_ = lambda_ / 2;
+        weights_.resize(mu_);
+        for (size_t i = 0; i < mu_; ++i) {
+            weights_[i] = std::log(mu_ + 0.5) - std::log(i + 1.0);
+        }
+        double sum = std::accumulate(weights_.begin(), weights_.end(), 0.0);
+        double sum_sq = 0.0;
+        for (auto& w : weights_) {
+            w /= sum;
+            sum_sq += w * w;
+        }
+        mueff_ = 1.0 / sum_sq;
+
+        double n = static_cast<double>(n_);
+        cc_ = (4.0 + mueff_ / n) / (n + 4.0 + 2.0 * mueff_ / n);
+        cs_ = (mueff_ + 2.0) / (n + mueff_ + 5.0);
+        c1_ = 2.0 / ((n + 1.3) * (n + 1.3) + mueff_);
+        cmu_ = std::min(1.0 - c1_, 2.0 * (mueff_ - 2.0 + 1.0 / mueff_) / ((n + 2.0) * (n + 2.0) + mueff_));
+        damps_ = 1.0 + 2.0 * std::max(0.0, std::sqrt((mueff_ - 1.0) / (n + 1.0)) - 1.0) + cs_;
+        chi_n_ = std::sqrt(n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+
+        pc_.assign(n_, 0.0);
+        ps_.assign(n_, 0.0);
+        c_.assign(n_ * n_, 0.0);
+        b_.assign(n_ * n_, 0.0);
+        d_.assign(n_, 1.0);
+        for (size_t i = 0; i < n_; ++i) {
+            c_[i * n_ + i] = 1.0;
+            b_[i * n_ + i] = 1.0;
+        }
+        population_.assign(lambda_, std::vector<double>(n_));
+    }
+
+    size_t lambda() const { return lambda_; }
+    double sigma() const { return sigma_; }
+    const std::vector<double>& mean() const { return mean_; }
+
+    const std::vector<std::vector<double>>& ask() {
+        std::normal_distribution<double> normal;
+        std::vector<double> z(n_);
+        for (auto& x : population_) {
+            for (auto& v : z) {
+                v = normal(rng_);
+            }
+            for (size_t i = 0; i < n_; ++i) {
+                double y = 0.0;
+                for (size_t j = 0; j < n_; ++j) {
+                    y += b_[i * n_ + j] * d_[j] * z[j];
+                }
+                x[i] = std::clamp(mean_[i] + sigma_ * y, 0.0, 1.0);
+            }
+        }
+        return population_;
+    }
+
+    void tell(const std::vector<double>& fitness) {
+        std::vector<size_t> rank(lambda_);
+        std::iota(rank.begin(), rank.end(), 0);
+        std::sort(rank.begin(), rank.end(), [&](size_t a, size_t b) { return fitness[a] < fitness[b]; });
+
+        std::vector<double> y_w(n_, 0.0);
+        std::vector<std::vector<double>> y(mu_, std::vector<double>(n_));
+        for (size_t k = 0; k < mu_; ++k) {
+            for (size_t i = 0; i < n_; ++i) {
+                y[k][i] = (population_[rank[k]][i] - mean_[i]) / sigma_;
+                y_w[i] += weights_[k] * y[k][i];
+            }
+        }
+        for (size_t i = 0; i < n_; ++i) {
+            mean_[i] += sigma_ * y_w[i];
+        }
+
+        // C^-1/2 y_w = B D^-1 B^T y_w
+        std::vector<double> bt(n_, 0.0);
+        for (size_t j = 0; j < n_; ++j) {
+            for (size_t i = 0; i < n_; ++i) {
+                bt[j] += b_[i * n_ + j] * y_w[i];
+            }
+            bt[j] /= d_[j];
+        }
+        double cs_factor = std::sqrt(cs_ * (2.0 - cs_) * mueff_);
+        double ps_norm = 0.0;
+        for (size_t i = 0; i < n_; ++i) {
+            double v = 0.0;
+            for (size_t j = 0; j < n_; ++j) {
+                v += b_[i * n_ + j] * bt[j];
+            }
+            ps_[i] = (1.0 - cs_) * ps_[i] + cs_factor * v;
+            ps_norm += ps_[i] * ps_[i];
+        }
+        ps_norm = std::sqrt(ps_norm);
+        ++generation_;
+        bool hsig = ps_norm / std::sqrt(1.0 - std::pow(1.0 - cs_, 2.0 * generation_)) / chi_n_ <
+                    1.4 + 2.0 / (n_ + 1.0);
+
+        double cc_factor = std::sqrt(cc_ * (2.0 - cc_) * mueff_);
+        for (size_t i = 0; i < n_; ++i) {
+            pc_[i] = (1.0 - cc_) * pc_[i] + (hsig ? cc_factor * y_w[i] : 0.0);
+        }
+        double correction = hsig ? 0.0 : c1_ * cc_ * (2.0 - cc_);
+        for (size_t i = 0; i < n_; ++i) {
+            for (size_t j = 0; j <= i; ++j) {
+                double rank_mu = 0.0;
+                for (size_t k = 0; k < mu_; ++k) {
+                    rank_mu += weights_[k] * y[k][i] * y[k][j];
+                }
+                double value = (1.0 - c1_ - cmu_) * c_[i * n_ + j] + c1_ * pc_[i] * pc_[j] +
+                               correction * c_[i * n_ + j] + cmu_ * rank_mu;
+                c_[i * n_ + j] = value;
+                c_[j * n_ + i] = value;
+            }
+        }
+        sigma_ *= std::exp((cs_ / damps_) * (ps_norm / chi_n_ - 1.0));
+        sigma_ = std::min(sigma_, 1.0);
+        decompose();
+    }
+
+private:
+    // Rozkład własny C = B diag(d^2) B^T metodą Jacobiego (n to kilkanaście wymiarów).
+    void decompose() {
+        std::vector<double> a = c_;
+        std::fill(b_.begin(), b_.end(), 0.0);
+        for (size_t i = 0; i < n_; ++i) {
+            b_[i * n_ + i] = 1.0;
+        }
+        for (int sweep = 0; sweep < 50; ++sweep) {
+            double off = 0.0;
+            for (size_t p = 0; p < n_; ++p) {
+                for (size_t q = p + 1; q < n_; ++q) {
+                    off += a[p * n_ + q] * a[p * n_ + q];
+                }
+            }
+            if (off < 1e-20) {
+                break;
+            }
+            for (size_t p = 0; p < n_; ++p) {
+                for (size_t q = p + 1; q < n_; ++q) {
+                    double apq = a[p * n_ + q];
+                    if (std::abs(apq) < 1e-30) {
+                        continue;
+                    }
+                    double theta = (a[q * n_ + q] - a[p * n_ + p]) / (2.0 * apq);
+                    double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                    double c = 1.0 / std::sqrt(t * t + 1.0);
+                    double s = t * c;
+                    for (size_t k = 0; k < n_; ++k) {
+                        double akp = a[k * n_ + p];
+                        double akq = a[k * n_ + q];
+                        a[k * n_ + p] = c * akp - s * akq;
+                        a[k * n_ + q] = s * akp + c * akq;
+                    }
+                    for (size_t k = 0; k < n_; ++k) {
+                        double apk = a[p * n_ + k];
+                        double aqk = a[q * n_ + k];
+                        a[p * n_ + k] = c * apk - s * aqk;
+                        a[q * n_ + k] = s * apk + c * aqk;
+                    }
+                    for (size_t k = 0; k < n_; ++k) {
+                        double bkp = b_[k * n_ + p];
+                        double bkq = b_[k * n_ + q];
+                        b_[k * n_ + p] = c * bkp - s * bkq;
+                        b_[k * n_ + q] = s * bkp + c * bkq;
+                    }
+                }
+            }
+        }
+        for (size_t i = 0; i < n_; ++i) {
+            d_[i] = std::sqrt(std::max(a[i * n_ + i], 1e-20));
+        }
+    }
+
+    size_t n_;
+    size_t lambda_;
+    size_t mu_;
+    std::vector<double> weights_;
+    double mueff_, cc_, cs_, c1_, cmu_, damps_, chi_n_;
+    std::vector<double> mean_;
+    double sigma_;
+    std::vector<double> pc_, ps_;
+    std::vector<double> c_, b_, d_;
+    std::vector<std::vector<double>> population_;
+    size_t generation_ = 0;
+    std::mt19937_64 rng_;
+};
+
+// Indeksy punktów niezdominowanych przy maksymalizacji obu celów.
+inline std::vector<size_t> paretoFront(const std::vector<float>& first, const std::vector<float>& second) {
+    std::vector<size_t> order(first.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return first[a] != first[b] ? first[a] > first[b] : second[a] > second[b];
+    });
+    std::vector<size_t> front;
+    float best_second = -INFINITY;
+    for (size_t i : order) {
+        if (second[i] > best_second) {
+            front.push_back(i);
+            best_second = second[i];
+        }
+    }
+    return front;
+}
+
+// Przestrzeń polityk: 8 progów trybów (z histerezą) i klucz kolejności przydziału
+// dla każdego komponentu elastycznego. Komponenty krytyczne i niezbędne zostają
+// na początku kolejności, elastyczne są sortowane rosnąco po kluczu.
+class PolicySpace {
+public:
+    static constexpr size_t kThresholdCount = 8;
+
+    explicit PolicySpace(const CoreState& initial)
+        : initial_(initial) {
+        for (size_t k = 0; k < initial.component_count; ++k) {
+            size_t index = initial.allocation_order[k];
+            const CoreComponent& comp = initial.components[index];
+            if (comp.priority == ComponentPriority::CRITICAL || comp.is_essential) {
+                fixed_.push_back(index);
+            } else {
+                flexible_.push_back(index);
+            }
+        }
+    }
+
+    size_t dimension() const { return kThresholdCount + flexible_.size(); }
+
+    std::vector<double> encode(const ModeThresholds& t) const {
+        std::vector<double> x(dimension());
+        const float values[kThresholdCount] = {t.emergency_soc, t.hibernation_solar_w, t.hibernation_soc,
+            t.low_power_soc, t.low_power_balance_w, t.normal_soc, t.normal_balance_w, t.min_dwell_s};
+        for (size_t i = 0; i < kThresholdCount; ++i) {
+            x[i] = (values[i] - kLower[i]) / (kUpper[i] - kLower[i]);
+        }
+        // Bieżąca kolejność elastycznych jako rosnące klucze
+        for (size_t i = 0; i < flexible_.size(); ++i) {
+            x[kThresholdCount + i] = (i + 0.5) / flexible_.size();
+        }
+        return x;
+    }
+
+    PolicyParameters decode(const std::vector<double>& x) const {
+        float v[kThresholdCount];
+        for (size_t i = 0; i < kThresholdCount; ++i) {
+            v[i] = static_cast<float>(kLower[i] + x[i] * (kUpper[i] - kLower[i]));
+        }
+        PolicyParameters policy;
+        policy.thresholds = {v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7]};
+
+        std::vector<size_t> flexible = flexible_;
+        std::vector<double> keys(x.begin() + kThresholdCount, x.end());
+        std::vector<size_t> order(flexible.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return keys[a] < keys[b]; });
+        size_t k = 0;
+        for (size_t index : fixed_) {
+            policy.allocation_order[k++] = static_cast<uint8_t>(index);
+        }
+        for (size_t i : order) {
+            policy.allocation_order[k++] = static_cast<uint8_t>(flexible[i]);
+        }
+        policy.custom_order = true;
+        return policy;
+    }
+
+    const std::vector<size_t>& flexibleComponents() const { return flexible_; }
+
+private:
+    static constexpr double kLower[kThresholdCount] = {5.0, 0.0, 20.0, 15.0, -40.0, 20.0, -10.0, 0.0};
+    static constexpr double kUpper[kThresholdCount] = {25.0, 20.0, 70.0, 50.0, 0.0, 80.0, 20.0, 600.0};
+
+    CoreState initial_;
+    std::vector<size_t> fixed_;
+    std::vector<size_t> flexible_;
+};
+
+}
+
+#endif // POLICY_TUNING_HPP
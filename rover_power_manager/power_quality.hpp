@@ -0,0 +1,295 @@
+#ifndef POWER_QUALITY_HPP
+#define POWER_QUALITY_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace rover_energy {
+
+// Tętnienia PWM napędów i uszkodzenia przetwornic widać na napięciu szyny na długo przed SOC.
+// Analiza strumieniowa próbek kHz: okna Hanna z 50% zakładką, widmo z rzeczywistego FFT
+// w miejscu, energie pasm i zliczanie stanów nieustalonych; wynik zbierany raz na okres raportu.
+
+static constexpr size_t kPowerQualityWindow = 256;
+static constexpr size_t kPowerQualityBands = 4;
+static constexpr double kTwoPi = 2.0 * 3.14159265358979323846;
+
+// Rzeczywiste FFT N punktów w miejscu: zespolone FFT N/2 punktów na parach (x[2n], x[2n+1])
+// i rozdzielenie widma. Tablice obrotów i permutacji liczone raz w konstruktorze.
+// Wynik upakowany: data[0] = X[0], data[1] = X[N/2], data[2k], data[2k+1] = Re, Im X[k].
+template <size_t N>
+class RealFft {
+    static_assert(N >= 4 && (N & (N - 1)) == 0, "RealFft size must be a power of two");
+    static constexpr size_t M = N / 2;
+
+public:
+    RealFft() {
+        for (size_t k = 0; k < M / 2; ++k) {
+            double angle = -kTwoPi * k / M;
+            twiddle_[k] = {static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle))};
+        }
+        for (size_t k = 0; k < M / 2; ++k) {
+            double angle = -kTwoPi * (k + 1) / N;
+            split_[k] = {static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle))};
+        }
+        size_t bits = 0;
+        while ((size_t{1} << bits) < M) {
+            ++bits;
+        }
+        for (size_t i = 0; i < M; ++i) {
+            size_t r = 0;
+            for (size_t b = 0; b < bits; ++b) {
+                r |= ((i >> b) & 1u) << (bits - 1 - b);
+            }
+            if (i < r) {
+                swaps_[swap_count_++] = {static_cast<uint16_t>(i), static_cast<uint16_t>(r)};
+            }
+        }
+    }
+
+    void forward(float* data) const {
+        complexForward(data);
+
+        float re0 = data[0];
+        float im0 = data[1];
+        data[0] = re0 + im0;
+        data[1] = re0 - im0;
+        // Para k, M-k: E i O to widma próbek parzystych i nieparzystych, X[k] = E + W^k·O
+        for (size_t k = 1; k <= M / 2; ++k) {
+            size_t j = M - k;
+            float ar = data[2 * k], ai = data[2 * k + 1];
+            float br = data[2 * j], bi = -data[2 * j + 1];
+            float er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+            float or_ = 0.5f * (ar - br), oi = 0.5f * (ai - bi);
+            const Complex& w = split_[k - 1];
+            float tr = w.re * or_ - w.im * oi;
+            float ti = w.re * oi + w.im * or_;
+            data[2 * k] = er + ti;
+            data[2 * k + 1] = ei - tr;
+            if (j != k) {
+                data[2 * j] = er - ti;
+                data[2 * j + 1] = -ei - tr;
+            }
+        }
+    }
+
+private:
+    struct Complex {
+        float re;
+        float im;
+    };
+
+    // Radix-2 z przerzedzeniem w czasie na przeplecionych (re, im)
+    void complexForward(float* data) const {
+        for (size_t s = 0; s < swap_count_; ++s) {
+            size_t a = 2u * swaps_[s][0];
+            size_t b = 2u * swaps_[s][1];
+            std::swap(data[a], data[b]);
+            std::swap(data[a + 1], data[b + 1]);
+        }
+        for (size_t len = 2; len <= M; len <<= 1) {
+            size_t half = len / 2;
+            size_t stride = M / len;
+            for (size_t start = 0; start < M; start += len) {
+                for (size_t k = 0; k < half; ++k) {
+                    const Complex& w = twiddle_[k * stride];
+                    float* u = data + 2 * (start + k);
+                    float* v = data + 2 * (start + k + half);
+                    float vr = w.re * v[0] - w.im * v[1];
+                    float vi = w.re * v[1] + w.im * v[0];
+                    v[0] = u[0] - vr;
+                    v[1] = u[1] - vi;
+                    u[0] += vr;
+                    u[1] += vi;
+                }
+            }
+        }
+    }
+
+    std::array<Complex, M / 2> twiddle_{};
+    std::array<Complex, M / 2> split_{};
+    std::array<std::array<uint16_t, 2>, M / 2> swaps_{};
+    size_t swap_count_ = 0;
+};
+
+struct PowerQualityConfig {
+    // Granice pasm [Hz]; biny powyżej Nyquista pomijane
+    std::array<double, kPowerQualityBands + 1> band_edges_hz = {5.0, 50.0, 200.0, 600.0, 2000.0};
+    float transient_threshold_v = 0.5f;     // odchyłka od linii bazowej uznana za stan nieustalony
+    float baseline_time_s = 0.05f;          // stała czasowa linii bazowej (EMA)
+    float max_gap_s = 0.01f;                // dłuższa przerwa w próbkach zaczyna okno od nowa
+};
+
+struct PowerQualityMetrics {
+    float mean_voltage = 0.0f;
+    float ripple_rms_v = 0.0f;              // całe widmo poza składową stałą
+    std::array<float, kPowerQualityBands> band_rms_v{};
+    float dominant_hz = 0.0f;               // bin o największej energii w okresie
+    float dominant_rms_v = 0.0f;
+    float peak_deviation_v = 0.0f;          // największa odchyłka od linii bazowej
+    float sample_rate_hz = 0.0f;            // ze stempli ostatniego okna
+    uint32_t transients = 0;
+    uint32_t windows = 0;
+    uint32_t samples = 0;
+};
+
+// Stała pamięć i bez alokacji w addSample(); FFT co N/2 próbek.
+class PowerQualityAnalyzer {
+public:
+    static constexpr size_t kWindow = kPowerQualityWindow;
+    static constexpr size_t kHop = kWindow / 2;
+    static constexpr size_t kBins = kWindow / 2 + 1;
+
+    explicit PowerQualityAnalyzer(const PowerQualityConfig& config = PowerQualityConfig())
+        : config_(config) {
+        double sum_sq = 0.0;
+        for (size_t n = 0; n < kWindow; ++n) {
+            window_[n] = static_cast<float>(0.5 - 0.5 * std::cos(kTwoPi * n / kWindow));
+            sum_sq += static_cast<double>(window_[n]) * window_[n];
+        }
+        // Parseval dla widma jednostronnego: średni kwadrat w binie = 2|X|² / (N·Σw²)
+        bin_scale_ = static_cast<float>(2.0 / (kWindow * sum_sq));
+    }
+
+    const PowerQualityConfig& config() const { return config_; }
+
+    void addSample(int64_t stamp_ns, float voltage) {
+        if (!std::isfinite(voltage)) {
+            return;
+        }
+        if (filled_ > 0 && (stamp_ns <= last_stamp_ns_ ||
+                            stamp_ns - last_stamp_ns_ > static_cast<int64_t>(config_.max_gap_s * 1e9f))) {
+            filled_ = 0;
+        }
+        trackTransient(stamp_ns, voltage);
+        last_stamp_ns_ = stamp_ns;
+        voltage_sum_ += voltage;
+        ++period_.samples;
+
+        if (filled_ == 0) {
+            window_start_ns_ = stamp_ns;
+        } else if (filled_ == kHop) {
+            hop_start_ns_ = stamp_ns;
+        }
+        samples_[filled_++] = voltage;
+        if (filled_ == kWindow) {
+            analyzeWindow(stamp_ns);
+            std::memmove(samples_.data(), samples_.data() + kHop, kHop * sizeof(float));
+            filled_ = kHop;
+            window_start_ns_ = hop_start_ns_;
+        }
+    }
+
+    // Metryki z próbek i okien od poprzedniego wywołania; zeruje akumulatory okresu.
+    PowerQualityMetrics report() {
+        PowerQualityMetrics m = period_;
+        if (m.samples > 0) {
+            m.mean_voltage = static_cast<float>(voltage_sum_ / m.samples);
+        }
+        if (m.windows > 0) {
+            for (size_t b = 0; b < kPowerQualityBands; ++b) {
+                m.band_rms_v[b] = static_cast<float>(std::sqrt(band_ms_[b] / m.windows));
+            }
+            m.ripple_rms_v = static_cast<float>(std::sqrt(ripple_ms_ / m.windows));
+        }
+        m.sample_rate_hz = sample_rate_hz_;
+
+        period_ = PowerQualityMetrics();
+        voltage_sum_ = 0.0;
+        ripple_ms_ = 0.0;
+        band_ms_.fill(0.0);
+        return m;
+    }
+
+private:
+    // Linia bazowa EMA i histereza: ponowne zliczenie dopiero po powrocie poniżej połowy progu.
+    void trackTransient(int64_t stamp_ns, float voltage) {
+        if (!baseline_valid_) {
+            baseline_ = voltage;
+            baseline_valid_ = true;
+            return;
+        }
+        float dt = static_cast<float>(std::max<int64_t>(stamp_ns - last_stamp_ns_, 0)) * 1e-9f;
+        float deviation = std::fabs(voltage - baseline_);
+        period_.peak_deviation_v = std::max(period_.peak_deviation_v, deviation);
+        if (!in_transient_ && deviation > config_.transient_threshold_v) {
+            in_transient_ = true;
+            ++period_.transients;
+        } else if (in_transient_ && deviation < 0.5f * config_.transient_threshold_v) {
+            in_transient_ = false;
+        }
+        baseline_ += (1.0f - std::exp(-dt / config_.baseline_time_s)) * (voltage - baseline_);
+    }
+
+    void analyzeWindow(int64_t end_ns) {
+        if (end_ns <= window_start_ns_) {
+            return;
+        }
+        sample_rate_hz_ = static_cast<float>((kWindow - 1) * 1e9 / static_cast<double>(end_ns - window_start_ns_));
+
+        float mean = 0.0f;
+        for (float v : samples_) {
+            mean += v;
+        }
+        mean /= kWindow;
+        for (size_t n = 0; n < kWindow; ++n) {
+            work_[n] = (samples_[n] - mean) * window_[n];
+        }
+        fft_.forward(work_.data());
+
+        double bin_hz = static_cast<double>(sample_rate_hz_) / kWindow;
+        double ripple = 0.0;
+        for (size_t k = 1; k < kBins; ++k) {
+            float ms;
+            if (k == kBins - 1) {
+                ms = 0.5f * bin_scale_ * work_[1] * work_[1];
+            } else {
+                ms = bin_scale_ * (work_[2 * k] * work_[2 * k] + work_[2 * k + 1] * work_[2 * k + 1]);
+            }
+            ripple += ms;
+            double f = k * bin_hz;
+            for (size_t b = 0; b < kPowerQualityBands; ++b) {
+                if (f >= config_.band_edges_hz[b] && f < config_.band_edges_hz[b + 1]) {
+                    band_ms_[b] += ms;
+                    break;
+                }
+            }
+            float rms = std::sqrt(ms);
+            if (rms > period_.dominant_rms_v) {
+                period_.dominant_rms_v = rms;
+                period_.dominant_hz = static_cast<float>(f);
+            }
+        }
+        ripple_ms_ += ripple;
+        ++period_.windows;
+    }
+
+    PowerQualityConfig config_;
+    RealFft<kWindow> fft_;
+    std::array<float, kWindow> window_{};
+    std::array<float, kWindow> samples_{};
+    std::array<float, kWindow> work_{};
+    float bin_scale_ = 0.0f;
+    size_t filled_ = 0;
+    int64_t window_start_ns_ = 0;
+    int64_t hop_start_ns_ = 0;
+    int64_t last_stamp_ns_ = 0;
+    float sample_rate_hz_ = 0.0f;
+
+    float baseline_ = 0.0f;
+    bool baseline_valid_ = false;
+    bool in_transient_ = false;
+
+    PowerQualityMetrics period_;
+    double voltage_sum_ = 0.0;
+    double ripple_ms_ = 0.0;
+    std::array<double, kPowerQualityBands> band_ms_{};
+};
+
+}
+
+#endif // POWER_QUALITY_HPP
@@ -0,0 +1,102 @@
+#ifndef POWER_TYPES_HPP
+#define POWER_TYPES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace rover_energy {
+enum class PowerMode {
+    NORMAL,         
+    LOW_POWER,      
+    HIBERNATION,      
+    EMERGENCY,
+    DUST_STORM      // przetrwanie wielosolowej burzy pyłowej (trend nieprzezroczystości)
+};
+
+static constexpr size_t kPowerModeCount = 5;
+
+constexpr uint8_t modeBit(PowerMode mode) {
+    return static_cast<uint8_t>(1u << static_cast<unsigned>(mode));
+}
+
+// Reguła, która ustaliła tryb docelowy (ślad decyzji dla operatorów)
+enum class ModeRule : uint8_t {
+    HOLD,               // żadna reguła nie zadziałała, tryb bez zmian
+    CRITICAL_SOC,
+    MPC_PLAN,
+    NIGHT_LOW_SOC,
+    LOW_SOC,
+    POWER_DEFICIT,
+    RECOVERED,
+    COMMANDED,          // setMode()
+    DUST_STORM          // trend nieprzezroczystości atmosfery (DustStormMonitor)
+};
+
+struct ModeThresholds {
+    float emergency_soc = 15.0f;            // [%]
+    float hibernation_solar_w = 5.0f;
+    float hibernation_soc = 50.0f;
+    float low_power_soc = 30.0f;
+    float low_power_balance_w = -10.0f;
+    float normal_soc = 40.0f;
+    float normal_balance_w = 0.0f;
+    float min_dwell_s = 0.0f;               // histereza: minimalny czas w trybie (poza EMERGENCY)
+};
+
+// Typ liczbowy jako parametr szablonu: float w węźle, Dual w analizie wrażliwości.
+template <typename T>
+struct BasicEnergyState {
+    T battery_soc;      
+    T voltage;              
+    T current;      
+    T power_consumption;    
+    T solar_generation; 
+    T temperature;      
+    PowerMode mode;
+};
+
+using EnergyState = BasicEnergyState<float>;
+
+enum class ComponentPriority {
+    CRITICAL = 0,   
+    HIGH = 1,   
+    MEDIUM = 2,
+    LOW = 3 
+};
+
+enum class ComponentPowerState {
+    OFF,
+    BOOTING,
+    WARM,
+    ACTIVE
+};
+
+struct ComponentTransitionModel {
+    float boot_time_s = 0.0f;
+    float boot_power_factor = 1.0f;   // pobór w trakcie rozruchu jako krotność nominalnego
+    float warm_power = 0.0f;          // pobór w gotowości [W]
+    float warmup_time_s = 0.0f;       // od WARM do ACTIVE (stabilizacja instrumentu)
+};
+
+struct PowerComponent {
+    std::string name;
+    ComponentPriority priority;
+    float nominal_power;
+    float current_power;
+    bool is_enabled;                // efektywne: mode_enabled i wszystkie zależności włączone
+    bool is_essential;
+    float duty_cycle = 1.0f;
+    ComponentPowerState power_state = ComponentPowerState::ACTIVE;
+    float state_time_s = 0.0f;
+    ComponentTransitionModel transition{};
+    uint32_t handle = 0;            // 0 = komponent wbudowany
+    uint32_t dependency_mask = 0;   // bity indeksów komponentów, od których zależy
+    bool shed_in_low_power = false; // zrzucany w LOW_POWER mimo priorytetu
+    uint8_t mode_mask = 0;          // bity modeBit() trybów, w których jest włączony; 0 = z priorytetu
+    bool mode_enabled = true;       // żądanie składu trybu, niezależne od zależności
+};
+
+}
+
+#endif // POWER_TYPES_HPP
@@ -0,0 +1,310 @@
+// Moduł Pythona nad rdzeniem energii (ten sam kod co węzeł, bez ROS).
+// Tablice wejściowe muszą być float32 i C-ciągłe: są czytane w miejscu, bez kopii.
+// Wyniki są alokowane jako tablice NumPy i zapisywane bezpośrednio przez rdzeń.
+// Obliczenia idą bez GIL, wsady na puli wątków.
+//
+//   c++ -O2 -std=c++17 -shared -fPIC -pthread $(python3 -m pybind11 --includes) -I.. \
+//       rover_energy_module.cpp -o rover_energy$(python3-config --extension-suffix)
+//
+//   import numpy as np, rover_energy
+//   core = rover_energy.Core()
+//   solar = core.clear_sky_forecast(18.4, 1.7e9, 6.0, 10.0 / 3600.0 * 24.0 / 24.66, 1_000_000)
+//   trace = core.simulate(solar, step_s=10.0)      # milion kroków w jednym wywołaniu
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "batch_simulator.hpp"
+#include "component_registry.hpp"
+#include "default_components.hpp"
+#include "energy_core.hpp"
+#include "mars_time.hpp"
+#include "solar_forecast.hpp"
+#include "thread_pool.hpp"
+
+namespace py = pybind11;
+
+namespace rover_energy {
+
+using FloatArray = py::array_t<float, py::array::c_style>;
+using ModeArray = py::array_t<uint8_t, py::array::c_style>;
+
+// Stan startowy z wbudowanej tabeli komponentów, jak po starcie węzła.
+class PyCore {
+public:
+    PyCore(double battery_capacity_wh, size_t threads)
+        : pool_(threads > 0 ? threads - 1 : std::max(1u, std::thread::hardware_concurrency()) - 1),
+          simulator_(pool_) {
+        std::vector<PowerComponent> components = defaultComponents();
+        ComponentRegistry registry(components);
+        registry.applyDependencies();
+        initial_ = CoreState{};
+        captureComponents(components, registry.allocationOrder(), initial_);
+        initial_.energy = {80.0f, 28.0f, 0.0f, 0.0f, 0.0f, -20.0f, PowerMode::NORMAL};
+        initial_.mode.mode = PowerMode::NORMAL;
+        initial_.mode.planned_mode = PowerMode::NORMAL;
+        initial_.mode.thresholds = ModeThresholds();
+        initial_.battery.capacity_wh = static_cast<float>(battery_capacity_wh);
+        initial_.battery.solar_calibration = 1.0f;
+        for (const auto& comp : components) {
+            metadata_.names.push_back(comp.name);
+        }
+    }
+
+    const std::vector<std::string>& componentNames() const { return metadata_.names; }
+
+    py::dict simulate(const FloatArray& solar_w, const py::object& extra_load_w, float initial_soc,
+                      float step_s, const ModeThresholds& thresholds, bool record_grants) {
+        size_t steps = requireVector(solar_w, "solar_w");
+        const float* extra = optionalMatching(extra_load_w, steps, "extra_load_w");
+        size_t count = initial_.component_count;
+
+        FloatArray soc(steps);
+        FloatArray consumption(steps);
+        ModeArray mode(steps);
+        FloatArray grants(record_grants ? std::vector<py::ssize_t>{static_cast<py::ssize_t>(steps),
+                                                                   static_cast<py::ssize_t>(count)}
+                                        : std::vector<py::ssize_t>{0, static_cast<py::ssize_t>(count)});
+        TraceBuffers trace;
+        trace.soc = soc.mutable_data();
+        trace.consumption = consumption.mutable_data();
+        trace.mode = mode.mutable_data();
+        trace.grants = record_grants ? grants.mutable_data() : nullptr;
+
+        PolicyParameters policy;
+        policy.thresholds = thresholds;
+        ScenarioView scenario{solar_w.data(), extra, steps, initial_soc, step_s};
+        SimulationMetrics metrics;
+        {
+            py::gil_scoped_release release;
+            metrics = BatchSimulator::simulate(initial_, policy, scenario, scienceIndex(), trace);
+        }
+
+        py::dict result;
+        result["soc"] = soc;
+        result["consumption"] = consumption;
+        result["mode"] = mode;
+        if (record_grants) {
+            result["grants"] = grants;
+        }
+        result["min_soc"] = metrics.min_soc;
+        result["final_soc"] = metrics.final_soc;
+        result["science_hours"] = metrics.science_hours;
+        result["emergency_hours"] = metrics.emergency_hours;
+        result["transitions"] = metrics.transitions;
+        return result;
+    }
+
+    // solar_w [scenariusze, kroki]; wynik [polityki, scenariusze] o dtype SimulationMetrics.
+    py::array_t<SimulationMetrics> simulateBatch(const FloatArray& solar_w, const py::object& extra_load_w,
+                                                 const FloatArray& initial_soc, float step_s,
+                                                 const std::vector<ModeThresholds>& policies) {
+        if (solar_w.ndim() != 2) {
+            throw std::invalid_argument("solar_w must have shape (scenarios, steps)");
+        }
+        size_t scenarios = static_cast<size_t>(solar_w.shape(0));
+        size_t steps = static_cast<size_t>(solar_w.shape(1));
+        if (requireVector(initial_soc, "initial_soc") != scenarios) {
+            throw std::invalid_argument("initial_soc must have one entry per scenario");
+        }
+        const float* extra = optionalMatching(extra_load_w, scenarios * steps, "extra_load_w");
+        if (policies.empty()) {
+            throw std::invalid_argument("at least one policy is required");
+        }
+
+        std::vector<PolicyParameters> parameters(policies.size());
+        for (size_t p = 0; p < policies.size(); ++p) {
+            parameters[p].thresholds = policies[p];
+        }
+        std::vector<ScenarioView> views(scenarios);
+        for (size_t s = 0; s < scenarios; ++s) {
+            views[s] = {solar_w.data() + s * steps, extra ? extra + s * steps : nullptr, steps,
+                        initial_soc.data()[s], step_s};
+        }
+
+        py::array_t<SimulationMetrics> out({static_cast<py::ssize_t>(policies.size()),
+                                            static_cast<py::ssize_t>(scenarios)});
+        SimulationMetrics* metrics = out.mutable_data();
+        {
+            py::gil_scoped_release release;
+            simulator_.run(initial_, parameters.data(), parameters.size(), views.data(), views.size(),
+                           scienceIndex(), metrics);
+        }
+        return out;
+    }
+
+    // Reguły determineTargetMode() węzła, wektorowo, bez planu MPC.
+    py::tuple selectModes(const FloatArray& soc, const FloatArray& power_balance, const FloatArray& solar_w,
+                          const ModeArray& current_mode, const ModeThresholds& thresholds) {
+        size_t n = requireVector(soc, "soc");
+        if (requireVector(power_balance, "power_balance") != n || requireVector(solar_w, "solar_w") != n ||
+            requireVector(current_mode, "current_mode") != n) {
+            throw std::invalid_argument("all inputs must have the same length");
+        }
+        ModeArray mode(n);
+        ModeArray rule(n);
+        FloatArray threshold(n);
+        {
+            const float* s = soc.data();
+            const float* balance = power_balance.data();
+            const float* solar = solar_w.data();
+            const uint8_t* current = current_mode.data();
+            uint8_t* mode_out = mode.mutable_data();
+            uint8_t* rule_out = rule.mutable_data();
+            float* threshold_out = threshold.mutable_data();
+            py::gil_scoped_release release;
+            for (size_t i = 0; i < n; ++i) {
+                ModeRule r;
+                PowerMode m = selectMode(thresholds, static_cast<PowerMode>(current[i]), false, false,
+                                         PowerMode::NORMAL, s[i], balance[i], solar[i], r, threshold_out[i]);
+                mode_out[i] = static_cast<uint8_t>(m);
+                rule_out[i] = static_cast<uint8_t>(r);
+            }
+        }
+        return py::make_tuple(mode, rule, threshold);
+    }
+
+    // Przydział allocatePower() dla każdej dostępnej mocy w ustalonym składzie trybu mode:
+    // wyłączone komponenty są OFF, włączone ACTIVE (bez rozruchów); wynik [próbki, komponenty].
+    FloatArray allocate(const FloatArray& available_w, PowerMode mode, const py::object& flexible_budget_w) {
+        size_t n = requireVector(available_w, "available_w");
+        const float* budget = optionalMatching(flexible_budget_w, n, "flexible_budget_w");
+        size_t count = initial_.component_count;
+        FloatArray grants({static_cast<py::ssize_t>(n), static_cast<py::ssize_t>(count)});
+        const float* available_in = available_w.data();
+        float* out = grants.mutable_data();
+        {
+            py::gil_scoped_release release;
+            std::array<CoreComponent, kMaxComponents> components = initial_.components;
+            applyModeMask(components.data(), count, initial_.mode_masks, initial_.mode.mode, mode);
+            applyDependencyMasks(components.data(), count);
+            for (size_t c = 0; c < count; ++c) {
+                enterPowerState(components[c], components[c].is_enabled
+                    ? ComponentPowerState::ACTIVE : ComponentPowerState::OFF);
+            }
+            for (size_t i = 0; i < n; ++i) {
+                float available = available_in[i];
+                allocateComponentPower(components.data(), initial_.allocation_order.data(), count, available,
+                                       budget ? budget[i] : available);
+                for (size_t c = 0; c < count; ++c) {
+                    out[i * count + c] = components[c].current_power;
+                }
+            }
+        }
+        return grants;
+    }
+
+    FloatArray clearSkyForecast(double latitude_deg, double unix_time, double start_ltst_hours,
+                                double step_ltst_hours, size_t n, double optical_depth) {
+        SolarArrayModel model;
+        model.optical_depth = optical_depth;
+        SolarForecaster forecaster(model);
+        MarsTime mars_time = marsTimeFromUnix(unix_time);
+        FloatArray out(n);
+        float* out_w = out.mutable_data();
+        {
+            py::gil_scoped_release release;
+            forecaster.clearSkyForecast(latitude_deg, mars_time, start_ltst_hours, step_ltst_hours, n, out_w);
+        }
+        return out;
+    }
+
+private:
+    size_t scienceIndex() const { return metadata_.find("science_instruments"); }
+
+    template <typename T>
+    static size_t requireVector(const py::array_t<T, py::array::c_style>& a, const char* name) {
+        if (a.ndim() != 1) {
+            throw std::invalid_argument(std::string(name) + " must be one-dimensional");
+        }
+        return static_cast<size_t>(a.shape(0));
+    }
+
+    // None albo tablica float32 o size elementach; zwraca wskaźnik do danych Pythona.
+    static const float* optionalMatching(const py::object& object, size_t size, const char* name) {
+        if (object.is_none()) {
+            return nullptr;
+        }
+        if (!py::isinstance<FloatArray>(object)) {
+            throw std::invalid_argument(std::string(name) + " must be a C-contiguous float32 array");
+        }
+        auto a = py::reinterpret_borrow<FloatArray>(object);
+        if (static_cast<size_t>(a.size()) != size) {
+            throw std::invalid_argument(std::string(name) + " has the wrong size");
+        }
+        return a.data();
+    }
+
+    ThreadPool pool_;
+    BatchSimulator simulator_;
+    CoreState initial_;
+    CoreMetadata metadata_;
+};
+
+}
+
+using namespace rover_energy;
+
+PYBIND11_MODULE(rover_energy, m) {
+    m.doc() = "Rover power core: mode rules, allocation, forecast and batch simulation";
+
+    py::enum_<PowerMode>(m, "PowerMode")
+        .value("NORMAL", PowerMode::NORMAL)
+        .value("LOW_POWER", PowerMode::LOW_POWER)
+        .value("HIBERNATION", PowerMode::HIBERNATION)
+        .value("EMERGENCY", PowerMode::EMERGENCY)
+        .value("DUST_STORM", PowerMode::DUST_STORM);
+
+    py::enum_<ModeRule>(m, "ModeRule")
+        .value("HOLD", ModeRule::HOLD)
+        .value("CRITICAL_SOC", ModeRule::CRITICAL_SOC)
+        .value("MPC_PLAN", ModeRule::MPC_PLAN)
+        .value("NIGHT_LOW_SOC", ModeRule::NIGHT_LOW_SOC)
+        .value("LOW_SOC", ModeRule::LOW_SOC)
+        .value("POWER_DEFICIT", ModeRule::POWER_DEFICIT)
+        .value("RECOVERED", ModeRule::RECOVERED)
+        .value("COMMANDED", ModeRule::COMMANDED)
+        .value("DUST_STORM", ModeRule::DUST_STORM);
+
+    py::class_<ModeThresholds>(m, "ModeThresholds")
+        .def(py::init<>())
+        .def_readwrite("emergency_soc", &ModeThresholds::emergency_soc)
+        .def_readwrite("hibernation_solar_w", &ModeThresholds::hibernation_solar_w)
+        .def_readwrite("hibernation_soc", &ModeThresholds::hibernation_soc)
+        .def_readwrite("low_power_soc", &ModeThresholds::low_power_soc)
+        .def_readwrite("low_power_balance_w", &ModeThresholds::low_power_balance_w)
+        .def_readwrite("normal_soc", &ModeThresholds::normal_soc)
+        .def_readwrite("normal_balance_w", &ModeThresholds::normal_balance_w)
+        .def_readwrite("min_dwell_s", &ModeThresholds::min_dwell_s);
+
+    PYBIND11_NUMPY_DTYPE(SimulationMetrics, min_soc, final_soc, science_hours, emergency_hours, transitions);
+
+    py::class_<PyCore>(m, "Core")
+        .def(py::init<double, size_t>(), py::arg("battery_capacity_wh") = 2000.0, py::arg("threads") = 0)
+        .def_property_readonly("component_names", &PyCore::componentNames)
+        .def("simulate", &PyCore::simulate,
+             py::arg("solar_w").noconvert(), py::arg("extra_load_w") = py::none(),
+             py::arg("initial_soc") = 80.0f, py::arg("step_s") = 10.0f,
+             py::arg("thresholds") = ModeThresholds(), py::arg("record_grants") = false)
+        .def("simulate_batch", &PyCore::simulateBatch,
+             py::arg("solar_w").noconvert(), py::arg("extra_load_w") = py::none(),
+             py::arg("initial_soc").noconvert(), py::arg("step_s") = 10.0f,
+             py::arg("policies") = std::vector<ModeThresholds>{ModeThresholds()})
+        .def("select_modes", &PyCore::selectModes,
+             py::arg("soc").noconvert(), py::arg("power_balance").noconvert(), py::arg("solar_w").noconvert(),
+             py::arg("current_mode").noconvert(), py::arg("thresholds") = ModeThresholds())
+        .def("allocate", &PyCore::allocate,
+             py::arg("available_w").noconvert(), py::arg("mode") = PowerMode::NORMAL,
+             py::arg("flexible_budget_w") = py::none())
+        .def("clear_sky_forecast", &PyCore::clearSkyForecast,
+             py::arg("latitude_deg"), py::arg("unix_time"), py::arg("start_ltst_hours"),
+             py::arg("step_ltst_hours"), py::arg("n"), py::arg("optical_depth") = 0.5);
+}
@@ -0,0 +1,137 @@
+#ifndef SENSOR_SYNC_HPP
+#define SENSOR_SYNC_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+namespace rover_energy {
+
+// Próbka czujnika ze stemplem z nagłówka wiadomości [ns].
+struct StampedSample {
+    int64_t stamp_ns;
+    float value;
+};
+
+// Bufor pierścieniowy o stałej pojemności; pełny nadpisuje najstarszą próbkę.
+template <size_t N>
+class StampedRing {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "StampedRing capacity must be a power of two");
+
+public:
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+    const StampedSample& front() const { return items_[head_]; }
+    const StampedSample& at(size_t k) const { return items_[(head_ + k) & (N - 1)]; }
+
+    // false, gdy bufor był pełny i najstarsza próbka przepadła
+    bool push(const StampedSample& sample) {
+        items_[(head_ + size_) & (N - 1)] = sample;
+        if (size_ == N) {
+            head_ = (head_ + 1) & (N - 1);
+            return false;
+        }
+        ++size_;
+        return true;
+    }
+
+    void pop() {
+        head_ = (head_ + 1) & (N - 1);
+        --size_;
+    }
+
+private:
+    std::array<StampedSample, N> items_{};
+    size_t head_ = 0;
+    size_t size_ = 0;
+};
+
+struct MatchedPair {
+    int64_t stamp_ns;       // średnia stempli pary
+    int64_t skew_ns;        // stempel wejścia 1 minus stempel wejścia 0
+    float first;
+    float second;
+};
+
+struct SyncStats {
+    uint64_t matched = 0;
+    uint64_t unmatched = 0;         // próbki odrzucone bez pary
+    uint64_t overflowed = 0;        // nadpisane w pełnym buforze
+    uint64_t out_of_order = 0;      // stempel nie nowszy niż poprzednia próbka wejścia
+};
+
+// Przybliżone dopasowanie czasu dwóch strumieni (ApproximateTime z message_filters
+// dla dwóch wejść). Para powstaje z czół obu buforów, gdy stemple różnią się najwyżej
+// o slop, a następna próbka wcześniejszego strumienia nie byłaby bliżej partnera;
+// bez tej następnej para czeka (opóźnienie najwyżej jednej próbki). Stała pamięć,
+// bez alokacji, więc nadaje się do strumieni kHz wprost w callbackach.
+template <size_t N>
+class ApproximateTimeSync {
+public:
+    explicit ApproximateTimeSync(int64_t slop_ns)
+        : slop_ns_(slop_ns) {}
+
+    const SyncStats& stats() const { return stats_; }
+
+    // input 0 albo 1; on_match(const MatchedPair&) dla każdej nowej pary, w kolejności czasu.
+    template <typename OnMatch>
+    void push(size_t input, int64_t stamp_ns, float value, OnMatch&& on_match) {
+        if (stamp_ns <= last_stamp_ns_[input]) {
+            ++stats_.out_of_order;
+            return;
+        }
+        last_stamp_ns_[input] = stamp_ns;
+        if (!rings_[input].push({stamp_ns, value})) {
+            ++stats_.overflowed;
+        }
+        match(on_match);
+    }
+
+private:
+    template <typename OnMatch>
+    void match(OnMatch& on_match) {
+        StampedRing<N>& a = rings_[0];
+        StampedRing<N>& b = rings_[1];
+        while (!a.empty() && !b.empty()) {
+            const StampedSample& x = a.front();
+            const StampedSample& y = b.front();
+            int64_t skew = y.stamp_ns - x.stamp_ns;
+            // Strumienie są rosnące, więc starsza próbka bez partnera w slop już go nie dostanie
+            if (std::llabs(skew) > slop_ns_) {
+                if (skew > 0) {
+                    a.pop();
+                } else {
+                    b.pop();
+                }
+                ++stats_.unmatched;
+                continue;
+            }
+            StampedRing<N>& earlier = skew >= 0 ? a : b;
+            int64_t partner_ns = skew >= 0 ? y.stamp_ns : x.stamp_ns;
+            if (skew != 0) {
+                if (earlier.size() < 2) {
+                    return;
+                }
+                if (std::llabs(earlier.at(1).stamp_ns - partner_ns) < std::llabs(skew)) {
+                    earlier.pop();
+                    ++stats_.unmatched;
+                    continue;
+                }
+            }
+            on_match(MatchedPair{x.stamp_ns + skew / 2, skew, x.value, y.value});
+            ++stats_.matched;
+            a.pop();
+            b.pop();
+        }
+    }
+
+    int64_t slop_ns_;
+    std::array<StampedRing<N>, 2> rings_;
+    std::array<int64_t, 2> last_stamp_ns_ = {INT64_MIN, INT64_MIN};
+    SyncStats stats_;
+};
+
+}
+
+#endif // SENSOR_SYNC_HPP
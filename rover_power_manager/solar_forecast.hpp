@@ -0,0 +1,144 @@
+#ifndef SOLAR_FORECAST_HPP
+#define SOLAR_FORECAST_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+#include "mars_time.hpp"
+
+namespace rover_energy {
+
+// Modele są szablonami po typie liczbowym: double w prognozie, Dual w analizie wrażliwości.
+template <typename T>
+struct BasicSurfaceIrradiance {
+    T beam;             // [W/m2] na płaszczyznę prostopadłą do promieni
+    T diffuse;          // [W/m2] na płaszczyznę poziomą
+};
+
+using SurfaceIrradiance = BasicSurfaceIrradiance<double>;
+
+template <typename T>
+inline BasicSurfaceIrradiance<T> surfaceIrradiance(double toa, double sin_elevation, const T& optical_depth) {
+    using std::exp;
+    if (sin_elevation < 0.01) {
+        return {T(0.0), T(0.0)};
+    }
+    T transmission = exp(-optical_depth / sin_elevation);
+    // Połowę rozproszonego światła pyłu liczymy jako izotropową poświatę
+    return {toa * transmission, 0.5 * toa * sin_elevation * (1.0 - transmission)};
+}
+
+template <typename T>
+struct BasicSolarArrayModel {
+    T area_m2 = 2.0;
+    T efficiency = 0.25;
+    T optical_depth = 0.5;
+};
+
+using SolarArrayModel = BasicSolarArrayModel<double>;
+
+static constexpr size_t kSolarSubsamples = 4;
+
+// Moc [W] płaskiego poziomego panelu przy danej wysokości Słońca.
+template <typename T>
+inline T flatPanelPower(const BasicSolarArrayModel<T>& model, double toa, double sin_elevation) {
+    BasicSurfaceIrradiance<T> irradiance = surfaceIrradiance(toa, sin_elevation, model.optical_depth);
+    return model.area_m2 * model.efficiency * (irradiance.beam * std::max(0.0, sin_elevation) + irradiance.diffuse);
+}
+
+// Odwrotność flatPanelPower() względem głębokości optycznej: P = k·s·(1 + e^(-τ/s)) / 2,
+// k = pole · sprawność · TOA. Pomiar poniżej poświaty (τ → ∞) daje max_depth.
+inline double opacityFromPower(const SolarArrayModel& model, double toa, double sin_elevation,
+                               double power_w, double max_depth) {
+    double scale = model.area_m2 * model.efficiency * toa * sin_elevation;
+    if (sin_elevation < 0.01 || scale <= 0.0) {
+        return NAN;
+    }
+    double transmission = 2.0 * power_w / scale - 1.0;
+    if (transmission >= 1.0) {
+        return 0.0;
+    }
+    if (transmission <= std::exp(-max_depth / sin_elevation)) {
+        return max_depth;
+    }
+    return -sin_elevation * std::log(transmission);
+}
+
+// Średnia moc bezchmurnego nieba w n krokach po step_hours (kSolarSubsamples podpróbek na krok).
+template <typename T, typename Out>
+inline void clearSkyPowerSeries(const BasicSolarArrayModel<T>& model, double latitude_deg, const MarsTime& mars_time,
+                                double start_ltst_hours, double step_hours, size_t n, Out* out_w) {
+    SolarGeometryBatch geometry(latitude_deg, mars_time.declination_deg);
+    double toa = topOfAtmosphereIrradiance(mars_time.heliocentric_au);
+    double sub_hours = step_hours / kSolarSubsamples;
+    std::array<float, kSolarSubsamples> sin_el;
+    for (size_t k = 0; k < n; ++k) {
+        geometry.sinElevation(start_ltst_hours + k * step_hours + 0.5 * sub_hours,
+                              sub_hours, kSolarSubsamples, sin_el.data());
+        Out sum = 0.0f;
+        for (float s : sin_el) {
+            sum += static_cast<Out>(flatPanelPower(model, toa, s));
+        }
+        out_w[k] = sum / kSolarSubsamples;
+    }
+}
+
+// Prognoza mocy z płaskiego panelu dla kolejnych kroków horyzontu, skalowana
+// stosunkiem zmierzonej generacji do modelu (kurz, degradacja, zacienienie).
+class SolarForecaster {
+public:
+    static constexpr size_t kSubsamples = kSolarSubsamples;
+
+    explicit SolarForecaster(const SolarArrayModel& model = SolarArrayModel())
+        : model_(model) {}
+
+    const SolarArrayModel& model() const { return model_; }
+
+    float calibration() const { return calibration_; }
+
+    // Względny rozrzut pomiaru wokół skalibrowanego modelu (EMA odchylenia standardowego).
+    float calibrationSpread() const { return std::sqrt(calibration_variance_); }
+
+    float clearSkyPower(double latitude_deg, const MarsTime& mars_time, double ltst_hours) const {
+        SolarPosition sun = solarPosition(latitude_deg, mars_time.declination_deg, ltst_hours);
+        return static_cast<float>(flatPanelPower(model_, topOfAtmosphereIrradiance(mars_time.heliocentric_au),
+                                                 std::sin(sun.elevation_deg * kDegToRad)));
+    }
+
+    void calibrate(float measured_w, float model_w) {
+        if (model_w < 5.0f) {
+            return;
+        }
+        float ratio = std::clamp(measured_w / model_w, 0.05f, 2.0f);
+        float error = (ratio - calibration_) / std::max(calibration_, 0.05f);
+        calibration_variance_ += 0.05f * (error * error - calibration_variance_);
+        calibration_ += 0.05f * (ratio - calibration_);
+    }
+
+    // Średnia moc [W] w n krokach po step_hours, zaczynając od start_ltst_hours.
+    void forecast(double latitude_deg, const MarsTime& mars_time, double start_ltst_hours,
+                  double step_hours, size_t n, float* out_w) const {
+        clearSkyForecast(latitude_deg, mars_time, start_ltst_hours, step_hours, n, out_w);
+        for (size_t k = 0; k < n; ++k) {
+            out_w[k] *= calibration_;
+        }
+    }
+
+    // Jak forecast(), ale bez kalibracji; wynik zależy tylko od geometrii i modelu panelu.
+    void clearSkyForecast(double latitude_deg, const MarsTime& mars_time, double start_ltst_hours,
+                          double step_hours, size_t n, float* out_w) const {
+        clearSkyPowerSeries(model_, latitude_deg, mars_time, start_ltst_hours, step_hours, n, out_w);
+    }
+
+private:
+
+    SolarArrayModel model_;
+    float calibration_ = 1.0f;
+    float calibration_variance_ = 0.09f;
+};
+
+}
+
+#endif // SOLAR_FORECAST_HPP
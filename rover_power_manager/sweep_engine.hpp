@@ -0,0 +1,377 @@
+#ifndef SWEEP_ENGINE_HPP
+#define SWEEP_ENGINE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "batch_simulator.hpp"
+#include "core_serialization.hpp"
+#include "energy_core.hpp"
+#include "thread_pool.hpp"
+
+namespace rover_energy {
+
+// Oś siatki: parametr ModeThresholds (nazwa jak w parametrach węzła, z prefiksem
+// „mode.” lub bez) zmieniany od kroku from_step; wcześniej obowiązuje wartość bazowa.
+struct SweepAxis {
+    std::string parameter;
+    size_t from_step = 0;
+    std::vector<float> values;
+};
+
+// Przebiegi = iloczyn kartezjański osi × scenariusze.
+struct SweepSpec {
+    CoreState initial;
+    ModeThresholds base;
+    std::vector<ScenarioView> scenarios;
+    std::vector<SweepAxis> axes;
+    size_t checkpoint_steps = 360;      // co ile kroków stan trafia do pamięci podręcznej
+    size_t science_index = SIZE_MAX;
+};
+
+struct SweepRun {
+    size_t scenario;
+    std::vector<float> values;          // po jednej wartości na oś
+    SimulationMetrics metrics;
+};
+
+struct SweepStats {
+    size_t runs = 0;
+    size_t chunks_total = 0;            // odcinki między punktami kontrolnymi po wszystkich przebiegach
+    size_t chunks_simulated = 0;
+    size_t cache_hits = 0;              // z pamięci z poprzednich rund lub wywołań
+    size_t deduplicated = 0;            // ten sam odcinek w kilku przebiegach tej samej rundy
+};
+
+inline float* thresholdField(ModeThresholds& t, const std::string& name) {
+    std::string key = name.compare(0, 5, "mode.") == 0 ? name.substr(5) : name;
+    if (key == "emergency_soc") return &t.emergency_soc;
+    if (key == "hibernation_solar_w") return &t.hibernation_solar_w;
+    if (key == "hibernation_soc") return &t.hibernation_soc;
+    if (key == "low_power_soc") return &t.low_power_soc;
+    if (key == "low_power_balance_w") return &t.low_power_balance_w;
+    if (key == "normal_soc") return &t.normal_soc;
+    if (key == "normal_balance_w") return &t.normal_balance_w;
+    if (key == "min_dwell_s") return &t.min_dwell_s;
+    return nullptr;
+}
+
+// Przegląd z zapamiętywaniem wyników: przebiegi idą rundami od punktu kontrolnego do
+// punktu kontrolnego, a kluczem odcinka jest (stan, wejścia odcinka, polityka); skrót służy
+// tylko do wyszukania kandydatów, równość sprawdzana jest na pełnym stanie i wejściach.
+// Przebiegi różniące się tylko parametrami późnej misji dzielą cały wspólny prefiks;
+// każdy unikalny odcinek liczony jest raz.
+class SweepEngine {
+public:
+    explicit SweepEngine(ThreadPool& pool, size_t cache_limit = 1 << 16)
+        : pool_(pool), cache_limit_(cache_limit) {}
+
+    // false = każdy odcinek liczony od nowa (porównanie i kontrola poprawności)
+    void setMemoize(bool memoize) { memoize_ = memoize; }
+    const SweepStats& stats() const { return stats_; }
+    size_t cacheSize() const { return cache_.size(); }
+    void clearCache() { cache_.clear(); }
+
+    bool run(const SweepSpec& spec, std::vector<SweepRun>& out, std::string& error) {
+        stats_ = SweepStats();
+        if (spec.checkpoint_steps == 0) {
+            error = "checkpoint_steps must be positive";
+            return false;
+        }
+        size_t combinations = 1;
+        for (const auto& axis : spec.axes) {
+            ModeThresholds probe;
+            if (!thresholdField(probe, axis.parameter)) {
+                error = "unknown sweep parameter: " + axis.parameter;
+                return false;
+            }
+            if (axis.values.empty()) {
+                error = "sweep axis without values: " + axis.parameter;
+                return false;
+            }
+            combinations *= axis.values.size();
+        }
+
+        // Granice odcinków na scenariusz: wielokrotności checkpoint_steps i kroki from_step
+        // (polityka jest stała wewnątrz odcinka), z góry policzone skróty i kopie wejść.
+        std::vector<ScenarioChunks> scenarios(spec.scenarios.size());
+        for (size_t s = 0; s < spec.scenarios.size(); ++s) {
+            const ScenarioView& view = spec.scenarios[s];
+            ScenarioChunks& chunks = scenarios[s];
+            for (size_t k = 0; k < view.steps; k += spec.checkpoint_steps) {
+                chunks.bounds.push_back(k);
+            }
+            for (const auto& axis : spec.axes) {
+                if (axis.from_step < view.steps) {
+                    chunks.bounds.push_back(axis.from_step);
+                }
+            }
+            std::sort(chunks.bounds.begin(), chunks.bounds.end());
+            chunks.bounds.erase(std::unique(chunks.bounds.begin(), chunks.bounds.end()), chunks.bounds.end());
+            chunks.bounds.push_back(view.steps);
+            for (size_t c = 0; c + 1 < chunks.bounds.size(); ++c) {
+                chunks.input_hash.push_back(hashInputs(view, chunks.bounds[c], chunks.bounds[c + 1]));
+                chunks.inputs.push_back(copyInputs(view, chunks.bounds[c], chunks.bounds[c + 1]));
+            }
+        }
+
+        size_t run_count = combinations * spec.scenarios.size();
+        out.resize(run_count);
+        std::vector<RunState> runs(run_count);
+        for (size_t i = 0; i < run_count; ++i) {
+            SweepRun& r = out[i];
+            RunState& state = runs[i];
+            r.scenario = i % spec.scenarios.size();
+            r.values.resize(spec.axes.size());
+            size_t index = i / spec.scenarios.size();
+            for (size_t a = spec.axes.size(); a-- > 0;) {
+                r.values[a] = spec.axes[a].values[index % spec.axes[a].values.size()];
+                index /= spec.axes[a].values.size();
+            }
+            state.core = spec.initial;
+            state.core.mode.plan_valid = false;
+            state.core.mode.transitions = 0;
+            state.core.energy.battery_soc = spec.scenarios[r.scenario].initial_soc;
+            state.min_soc = state.core.energy.battery_soc;
+            stats_.chunks_total += scenarios[r.scenario].input_hash.size();
+        }
+        stats_.runs = run_count;
+
+        std::vector<size_t> job_of_run(run_count);
+        std::vector<Job> jobs;
+        std::unordered_map<uint64_t, std::vector<size_t>> round_index;
+        for (size_t chunk = 0;; ++chunk) {
+            jobs.clear();
+            round_index.clear();
+            for (size_t i = 0; i < run_count; ++i) {
+                const ScenarioChunks& chunks = scenarios[out[i].scenario];
+                if (chunk >= chunks.input_hash.size()) {
+                    job_of_run[i] = SIZE_MAX;
+                    continue;
+                }
+                // Klucz: stan z polityką odcinka i wyzerowanym licznikiem przejść
+                // (liczniki sumowane są osobno) + skrót i długość wejść + krok; same wejścia
+                // porównywane są osobno (job.inputs), bo skrót może kolidować.
+                CoreState& core = runs[i].core;
+                core.mode.thresholds = thresholdsAt(spec, out[i].values, chunks.bounds[chunk]);
+                core.mode.transitions = 0;
+                Job job;
+                serializeCoreState(core, job.key);
+                size_t at = job.key.size();
+                job.key.resize(at + 16);
+                uint64_t input_hash = chunks.input_hash[chunk];
+                writeU32(job.key.data() + at, static_cast<uint32_t>(input_hash));
+                writeU32(job.key.data() + at + 4, static_cast<uint32_t>(input_hash >> 32));
+                writeU32(job.key.data() + at + 8, static_cast<uint32_t>(chunks.bounds[chunk + 1] - chunks.bounds[chunk]));
+                float step_s = spec.scenarios[out[i].scenario].step_s;
+                std::memcpy(job.key.data() + at + 12, &step_s, 4);
+                job.hash = fnv1a64(job.key.data(), job.key.size());
+                job.inputs = chunks.inputs[chunk];
+
+                if (memoize_) {
+                    size_t existing = findJob(round_index, jobs, job);
+                    if (existing != SIZE_MAX) {
+                        job_of_run[i] = existing;
+                        ++stats_.deduplicated;
+                        continue;
+                    }
+                }
+                job.run = i;
+                job.chunk = chunk;
+                job_of_run[i] = jobs.size();
+                round_index[job.hash].push_back(jobs.size());
+                jobs.push_back(std::move(job));
+            }
+            if (jobs.empty()) {
+                break;
+            }
+
+            std::vector<size_t> pending;
+            for (size_t j = 0; j < jobs.size(); ++j) {
+                const ChunkResult* cached = memoize_ ? lookup(jobs[j]) : nullptr;
+                if (cached) {
+                    jobs[j].result = *cached;
+                    ++stats_.cache_hits;
+                } else {
+                    pending.push_back(j);
+                }
+            }
+            pool_.parallelFor(pending.size(), [&](size_t p) {
+                Job& job = jobs[pending[p]];
+                const ScenarioChunks& chunks = scenarios[out[job.run].scenario];
+                job.result.end = runs[job.run].core;
+                simulateChunk(job.result, spec.scenarios[out[job.run].scenario], chunks.bounds[job.chunk],
+                              chunks.bounds[job.chunk + 1], spec.science_index);
+            });
+            stats_.chunks_simulated += pending.size();
+            if (memoize_) {
+                for (size_t j : pending) {
+                    store(jobs[j]);
+                }
+            }
+
+            for (size_t i = 0; i < run_count; ++i) {
+                if (job_of_run[i] == SIZE_MAX) {
+                    continue;
+                }
+                const ChunkResult& result = jobs[job_of_run[i]].result;
+                RunState& state = runs[i];
+                state.core = result.end;
+                state.min_soc = std::min(state.min_soc, result.min_soc);
+                state.science_ticks += result.science_ticks;
+                state.emergency_ticks += result.emergency_ticks;
+                state.transitions += result.end.mode.transitions;
+            }
+        }
+
+        for (size_t i = 0; i < run_count; ++i) {
+            const RunState& state = runs[i];
+            float hours = spec.scenarios[out[i].scenario].step_s / 3600.0f;
+            out[i].metrics = {state.min_soc, state.core.energy.battery_soc, state.science_ticks * hours,
+                              state.emergency_ticks * hours, state.transitions};
+        }
+        return true;
+    }
+
+private:
+    // Wejścia odcinka: solar_w, potem extra_load_w (zera, gdy scenariusz go nie ma).
+    using ChunkInputs = std::shared_ptr<const std::vector<float>>;
+
+    struct ScenarioChunks {
+        std::vector<size_t> bounds;         // początki odcinków + końcowy krok
+        std::vector<uint64_t> input_hash;
+        std::vector<ChunkInputs> inputs;    // współdzielone przez zadania i wpisy pamięci
+    };
+
+    struct ChunkResult {
+        CoreState end;                      // mode.transitions = przejścia w odcinku
+        float min_soc = 100.0f;
+        uint32_t science_ticks = 0;
+        uint32_t emergency_ticks = 0;
+    };
+
+    // Pełny klucz i kopia wejść: kolizja skrótu stanu albo wejść nie zwraca cudzego wyniku,
+    // także między wywołaniami run(), po których bufory scenariuszy mogą już nie istnieć.
+    struct CacheEntry {
+        std::vector<uint8_t> key;
+        ChunkInputs inputs;
+        ChunkResult result;
+    };
+
+    struct Job {
+        std::vector<uint8_t> key;
+        ChunkInputs inputs;
+        uint64_t hash = 0;
+        size_t run = 0;
+        size_t chunk = 0;
+        ChunkResult result;
+    };
+
+    struct RunState {
+        CoreState core;
+        float min_soc = 100.0f;
+        uint32_t science_ticks = 0;
+        uint32_t emergency_ticks = 0;
+        uint32_t transitions = 0;
+    };
+
+    static ModeThresholds thresholdsAt(const SweepSpec& spec, const std::vector<float>& values, size_t step) {
+        ModeThresholds t = spec.base;
+        for (size_t a = 0; a < spec.axes.size(); ++a) {
+            if (step >= spec.axes[a].from_step) {
+                *thresholdField(t, spec.axes[a].parameter) = values[a];
+            }
+        }
+        return t;
+    }
+
+    static uint64_t hashInputs(const ScenarioView& view, size_t begin, size_t end) {
+        uint64_t hash = fnv1a64(view.solar_w + begin, (end - begin) * sizeof(float));
+        if (view.extra_load_w) {
+            hash = fnv1a64(view.extra_load_w + begin, (end - begin) * sizeof(float), hash);
+        }
+        return hash;
+    }
+
+    static ChunkInputs copyInputs(const ScenarioView& view, size_t begin, size_t end) {
+        auto inputs = std::make_shared<std::vector<float>>(2 * (end - begin), 0.0f);
+        std::copy(view.solar_w + begin, view.solar_w + end, inputs->begin());
+        if (view.extra_load_w) {
+            std::copy(view.extra_load_w + begin, view.extra_load_w + end, inputs->begin() + (end - begin));
+        }
+        return inputs;
+    }
+
+    // Porównanie bitowe, jak klucz stanu: -0 i NaN nie są uznawane za równe innym wartościom.
+    static bool sameInputs(const ChunkInputs& a, const ChunkInputs& b) {
+        return a == b || (a->size() == b->size() &&
+                          std::memcmp(a->data(), b->data(), a->size() * sizeof(float)) == 0);
+    }
+
+    static size_t findJob(const std::unordered_map<uint64_t, std::vector<size_t>>& index,
+                          const std::vector<Job>& jobs, const Job& job) {
+        auto it = index.find(job.hash);
+        if (it == index.end()) {
+            return SIZE_MAX;
+        }
+        for (size_t j : it->second) {
+            if (jobs[j].key == job.key && sameInputs(jobs[j].inputs, job.inputs)) {
+                return j;
+            }
+        }
+        return SIZE_MAX;
+    }
+
+    // Pętla BatchSimulator::simulate() na zakresie kroków [begin, end); result.end zawiera
+    // stan początkowy odcinka.
+    static void simulateChunk(ChunkResult& result, const ScenarioView& scenario, size_t begin, size_t end,
+                              size_t science_index) {
+        CoreState& s = result.end;
+        size_t count = s.component_count;
+        result.min_soc = s.energy.battery_soc;
+        for (size_t k = begin; k < end; ++k) {
+            StepInputs inputs{scenario.solar_w[k], scenario.extra_load_w ? scenario.extra_load_w[k] : 0.0f};
+            stepCore(s, inputs, scenario.step_s);
+            result.min_soc = std::min(result.min_soc, s.energy.battery_soc);
+            result.science_ticks += science_index < count &&
+                                    s.components[science_index].power_state == ComponentPowerState::ACTIVE;
+            result.emergency_ticks += s.mode.mode == PowerMode::EMERGENCY;
+        }
+    }
+
+    const ChunkResult* lookup(const Job& job) const {
+        auto range = cache_.equal_range(job.hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second.key == job.key && sameInputs(it->second.inputs, job.inputs)) {
+                return &it->second.result;
+            }
+        }
+        return nullptr;
+    }
+
+    // Po przekroczeniu limitu pamięć jest czyszczona w całości: przeglądy idą rundami,
+    // więc odcinki bieżącej rundy i tak są już policzone.
+    void store(const Job& job) {
+        if (cache_.size() >= cache_limit_) {
+            cache_.clear();
+        }
+        cache_.emplace(job.hash, CacheEntry{job.key, job.inputs, job.result});
+    }
+
+    ThreadPool& pool_;
+    size_t cache_limit_;
+    bool memoize_ = true;
+    SweepStats stats_;
+    std::unordered_multimap<uint64_t, CacheEntry> cache_;
+};
+
+}
+
+#endif // SWEEP_ENGINE_HPP
@@ -0,0 +1,453 @@
+#ifndef TELEMETRY_CODEC_HPP
+#define TELEMETRY_CODEC_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "power_types.hpp"
+
+namespace rover_energy {
+
+// Format ramki downlinku:
+//   [nagłówek 24 B][próbka 0: wartości bezwzględne][próbki 1..n: delty]
+// Próbka = bajt sterujący (tryb, flagi) + maska zmienionych pól + varinty zigzag.
+// Czas próbki to czas poprzedniej + tick_ms; odchyłkę (jitter, przerwa) niesie
+// opcjonalny varint po masce włączeń. Czas bazowy to 64-bitowe ms uniksowe.
+enum class TelemetryFrameType : uint8_t {
+    ENERGY = 1
+};
+
+struct TelemetryFrameHeader {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t type;
+    uint16_t sequence;
+    uint16_t sample_count;
+    uint8_t component_count;
+    uint8_t flags;
+    uint16_t tick_ms;
+    uint64_t base_time_ms;
+    uint16_t payload_bytes;
+    uint16_t crc;
+};
+
+static constexpr uint16_t kTelemetryMagic = 0x5250;
+static constexpr uint8_t kTelemetryVersion = 2;
+static constexpr size_t kTelemetryHeaderBytes = 24;
+static constexpr size_t kTelemetryMaxComponents = 32;
+static constexpr size_t kTelemetryStateFields = 6;
+static constexpr size_t kTelemetryMaxFields = kTelemetryStateFields + kTelemetryMaxComponents;
+static constexpr size_t kTelemetryMaxFrameBytes = 4096;
+
+// Kwanty pól stanu: SOC [0.01 %], napięcie [10 mV], prąd [10 mA],
+// pobór [0.1 W], generacja [0.1 W], temperatura [0.1 C]; przydziały [0.1 W]
+static constexpr std::array<float, kTelemetryStateFields> kTelemetryStateScale = {
+    100.0f, 100.0f, 100.0f, 10.0f, 10.0f, 10.0f};
+static constexpr float kTelemetryGrantScale = 10.0f;
+
+// Zakres kwantów ±(2^30 - 1), więc delta dwóch wartości mieści się w int32;
+// NaN koduje się jako kTelemetryInvalid, a dekoder oddaje go jako NaN.
+static constexpr int32_t kTelemetryQuantMax = (1 << 30) - 1;
+static constexpr int32_t kTelemetryInvalid = -(1 << 30);
+
+static constexpr uint8_t kSampleModeMask = 0x07;
+static constexpr uint8_t kSampleEnableMaskChanged = 0x08;
+static constexpr uint8_t kSampleModeTransition = 0x10;
+static constexpr uint8_t kSampleTimeOffset = 0x20;
+
+static_assert(kPowerModeCount <= kSampleModeMask + 1u, "PowerMode no longer fits the 3-bit sample mode field");
+
+inline uint16_t telemetryCrc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (int b = 0; b < 8; ++b) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021)
+                                 : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+inline int32_t quantizeTelemetry(float value, float scale) {
+    if (std::isnan(value)) {
+        return kTelemetryInvalid;
+    }
+    double scaled = std::clamp(static_cast<double>(value) * scale,
+                               -static_cast<double>(kTelemetryQuantMax), static_cast<double>(kTelemetryQuantMax));
+    return static_cast<int32_t>(std::lround(scaled));
+}
+
+inline float dequantizeTelemetry(int32_t q, float scale) {
+    return q == kTelemetryInvalid ? NAN : static_cast<float>(q) / scale;
+}
+
+inline uint32_t zigzagEncode(int32_t v) {
+    return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+inline int32_t zigzagDecode(uint32_t v) {
+    return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+}
+
+inline uint8_t* writeVarint(uint8_t* out, uint32_t v) {
+    while (v >= 0x80) {
+        *out++ = static_cast<uint8_t>(v | 0x80);
+        v >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(v);
+    return out;
+}
+
+inline const uint8_t* readVarint(const uint8_t* in, const uint8_t* end, uint32_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 35 && in < end; shift += 7) {
+        uint8_t byte = *in++;
+        v |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return in;
+        }
+    }
+    return nullptr;
+}
+
+inline uint8_t* writeVarint64(uint8_t* out, uint64_t v) {
+    while (v >= 0x80) {
+        *out++ = static_cast<uint8_t>(v | 0x80);
+        v >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(v);
+    return out;
+}
+
+inline const uint8_t* readVarint64(const uint8_t* in, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 70 && in < end; shift += 7) {
+        uint8_t byte = *in++;
+        v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return in;
+        }
+    }
+    return nullptr;
+}
+
+inline void writeU16(uint8_t* out, uint16_t v) {
+    out[0] = static_cast<uint8_t>(v);
+    out[1] = static_cast<uint8_t>(v >> 8);
+}
+
+inline void writeU32(uint8_t* out, uint32_t v) {
+    writeU16(out, static_cast<uint16_t>(v));
+    writeU16(out + 2, static_cast<uint16_t>(v >> 16));
+}
+
+inline void writeU64(uint8_t* out, uint64_t v) {
+    writeU32(out, static_cast<uint32_t>(v));
+    writeU32(out + 4, static_cast<uint32_t>(v >> 32));
+}
+
+inline uint16_t readU16(const uint8_t* in) {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+inline uint32_t readU32(const uint8_t* in) {
+    return readU16(in) | (static_cast<uint32_t>(readU16(in + 2)) << 16);
+}
+
+inline uint64_t readU64(const uint8_t* in) {
+    return readU32(in) | (static_cast<uint64_t>(readU32(in + 4)) << 32);
+}
+
+inline void writeTelemetryHeader(uint8_t* out, const TelemetryFrameHeader& h) {
+    writeU16(out, h.magic);
+    out[2] = h.version;
+    out[3] = h.type;
+    writeU16(out + 4, h.sequence);
+    writeU16(out + 6, h.sample_count);
+    out[8] = h.component_count;
+    out[9] = h.flags;
+    writeU16(out + 10, h.tick_ms);
+    writeU64(out + 12, h.base_time_ms);
+    writeU16(out + 20, h.payload_bytes);
+    writeU16(out + 22, h.crc);
+}
+
+inline bool readTelemetryHeader(const uint8_t* in, size_t len, TelemetryFrameHeader& h) {
+    if (len < kTelemetryHeaderBytes) {
+        return false;
+    }
+    h.magic = readU16(in);
+    h.version = in[2];
+    h.type = in[3];
+    h.sequence = readU16(in + 4);
+    h.sample_count = readU16(in + 6);
+    h.component_count = in[8];
+    h.flags = in[9];
+    h.tick_ms = readU16(in + 10);
+    h.base_time_ms = readU64(in + 12);
+    h.payload_bytes = readU16(in + 20);
+    h.crc = readU16(in + 22);
+    return h.magic == kTelemetryMagic && h.version == kTelemetryVersion &&
+           h.component_count <= kTelemetryMaxComponents &&
+           kTelemetryHeaderBytes + h.payload_bytes <= len;
+}
+
+// Koder strumieniowy po stronie węzła: bufor alokowany raz, append() co tick.
+class TelemetryEncoder {
+public:
+    explicit TelemetryEncoder(uint16_t tick_ms, uint16_t max_samples = 100)
+        : tick_ms_(tick_ms), max_samples_(max_samples) {
+        reset();
+    }
+
+    // Zwraca false, gdy ramka jest pełna (albo odchyłka czasu nie mieści się w int32 ms);
+    // należy wtedy wywołać finish().
+    bool append(const EnergyState& state, const std::vector<PowerComponent>& components,
+                uint64_t time_ms) {
+        size_t n = std::min(components.size(), kTelemetryMaxComponents);
+        int64_t time_offset = 0;
+        if (sample_count_ == 0) {
+            base_time_ms_ = time_ms;
+            component_count_ = static_cast<uint8_t>(n);
+        } else if (n != component_count_) {
+            return false;
+        } else {
+            time_offset = static_cast<int64_t>(time_ms - last_time_ms_) - tick_ms_;
+            if (time_offset < INT32_MIN || time_offset > INT32_MAX) {
+                return false;
+            }
+        }
+        size_t fields = kTelemetryStateFields + n;
+        size_t mask_bytes = (fields + 7) / 8;
+        size_t worst_case = 1 + mask_bytes + 5 + 5 + fields * 5;
+        if (sample_count_ >= max_samples_ || write_pos_ + worst_case > buffer_.size()) {
+            return false;
+        }
+
+        std::array<int32_t, kTelemetryMaxFields> q;
+        float values[kTelemetryStateFields] = {
+            state.battery_soc, state.voltage, state.current,
+            state.power_consumption, state.solar_generation, state.temperature};
+        for (size_t i = 0; i < kTelemetryStateFields; ++i) {
+            q[i] = quantizeTelemetry(values[i], kTelemetryStateScale[i]);
+        }
+        uint32_t enable_mask = 0;
+        for (size_t i = 0; i < n; ++i) {
+            q[kTelemetryStateFields + i] = quantizeTelemetry(components[i].current_power, kTelemetryGrantScale);
+            if (components[i].is_enabled) {
+                enable_mask |= 1u << i;
+            }
+        }
+
+        bool key_sample = sample_count_ == 0;
+        uint8_t mode = static_cast<uint8_t>(state.mode);
+        uint8_t control = mode & kSampleModeMask;
+        if (key_sample || enable_mask != last_enable_mask_) {
+            control |= kSampleEnableMaskChanged;
+        }
+        if (has_previous_ && mode != last_mode_) {
+            control |= kSampleModeTransition;
+        }
+        if (time_offset != 0) {
+            control |= kSampleTimeOffset;
+        }
+
+        uint8_t* out = buffer_.data() + write_pos_;
+        *out++ = control;
+        uint8_t* mask = out;
+        std::fill(mask, mask + mask_bytes, 0);
+        out += mask_bytes;
+        if (control & kSampleEnableMaskChanged) {
+            out = writeVarint(out, enable_mask);
+        }
+        if (control & kSampleTimeOffset) {
+            out = writeVarint(out, zigzagEncode(static_cast<int32_t>(time_offset)));
+        }
+        for (size_t i = 0; i < fields; ++i) {
+            int32_t delta = key_sample ? q[i] : q[i] - last_[i];
+            if (delta != 0) {
+                mask[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+                out = writeVarint(out, zigzagEncode(delta));
+            }
+            last_[i] = q[i];
+        }
+
+        write_pos_ = static_cast<size_t>(out - buffer_.data());
+        last_enable_mask_ = enable_mask;
+        last_mode_ = mode;
+        last_time_ms_ = time_ms;
+        has_previous_ = true;
+        ++sample_count_;
+        return true;
+    }
+
+    bool empty() const { return sample_count_ == 0; }
+
+    uint16_t sampleCount() const { return sample_count_; }
+
+    // Zamyka ramkę i kopiuje ją do out; kolejna ramka zaczyna się od próbki kluczowej.
+    size_t finish(std::vector<uint8_t>& out) {
+        if (sample_count_ == 0) {
+            return 0;
+        }
+        TelemetryFrameHeader header;
+        header.magic = kTelemetryMagic;
+        header.version = kTelemetryVersion;
+        header.type = static_cast<uint8_t>(TelemetryFrameType::ENERGY);
+        header.sequence = sequence_++;
+        header.sample_count = sample_count_;
+        header.component_count = component_count_;
+        header.flags = 0;
+        header.tick_ms = tick_ms_;
+        header.base_time_ms = base_time_ms_;
+        header.payload_bytes = static_cast<uint16_t>(write_pos_ - kTelemetryHeaderBytes);
+        header.crc = telemetryCrc16(buffer_.data() + kTelemetryHeaderBytes, header.payload_bytes);
+        writeTelemetryHeader(buffer_.data(), header);
+
+        out.assign(buffer_.begin(), buffer_.begin() + write_pos_);
+        size_t frame_bytes = write_pos_;
+        reset();
+        return frame_bytes;
+    }
+
+private:
+    void reset() {
+        write_pos_ = kTelemetryHeaderBytes;
+        sample_count_ = 0;
+        component_count_ = 0;
+    }
+
+    std::array<uint8_t, kTelemetryMaxFrameBytes> buffer_;
+    std::array<int32_t, kTelemetryMaxFields> last_{};
+    size_t write_pos_ = kTelemetryHeaderBytes;
+    uint16_t tick_ms_;
+    uint16_t max_samples_;
+    uint16_t sample_count_ = 0;
+    uint16_t sequence_ = 0;
+    uint8_t component_count_ = 0;
+    uint8_t last_mode_ = 0;
+    bool has_previous_ = false;
+    uint32_t last_enable_mask_ = 0;
+    uint64_t base_time_ms_ = 0;
+    uint64_t last_time_ms_ = 0;
+};
+
+// Zdekodowana ramka w układzie kolumnowym (SoA), wiersz = próbka.
+struct TelemetryColumns {
+    TelemetryFrameHeader header;
+    std::vector<uint64_t> time_ms;
+    std::array<std::vector<float>, kTelemetryStateFields> state;
+    std::vector<std::vector<float>> grants;
+    std::vector<uint8_t> mode;
+    std::vector<uint8_t> transition;
+    std::vector<uint32_t> enable_mask;
+};
+
+// Dekoder naziemny: przebieg skalarny rozpakowuje varinty do kolumn delt,
+// potem sumy prefiksowe i skalowanie idą kolumnami w pętlach wektoryzowalnych.
+class TelemetryDecoder {
+public:
+    bool decode(const uint8_t* data, size_t len, TelemetryColumns& out) {
+        TelemetryFrameHeader& h = out.header;
+        if (!readTelemetryHeader(data, len, h) ||
+            h.type != static_cast<uint8_t>(TelemetryFrameType::ENERGY)) {
+            return false;
+        }
+        const uint8_t* in = data + kTelemetryHeaderBytes;
+        const uint8_t* end = in + h.payload_bytes;
+        if (telemetryCrc16(in, h.payload_bytes) != h.crc) {
+            return false;
+        }
+
+        size_t n = h.sample_count;
+        size_t fields = kTelemetryStateFields + h.component_count;
+        size_t mask_bytes = (fields + 7) / 8;
+        deltas_.resize(fields);
+        for (auto& column : deltas_) {
+            column.assign(n, 0);
+        }
+        out.mode.resize(n);
+        out.transition.resize(n);
+        out.enable_mask.resize(n);
+        out.time_ms.resize(n);
+
+        uint32_t enable_mask = 0;
+        uint64_t time_ms = h.base_time_ms;
+        for (size_t s = 0; s < n; ++s) {
+            if (end - in < static_cast<ptrdiff_t>(1 + mask_bytes)) {
+                return false;
+            }
+            uint8_t control = *in++;
+            const uint8_t* mask = in;
+            in += mask_bytes;
+            out.mode[s] = control & kSampleModeMask;
+            out.transition[s] = (control & kSampleModeTransition) ? 1 : 0;
+            if (control & kSampleEnableMaskChanged) {
+                in = readVarint(in, end, enable_mask);
+                if (!in) {
+                    return false;
+                }
+            }
+            out.enable_mask[s] = enable_mask;
+            int32_t time_offset = 0;
+            if (control & kSampleTimeOffset) {
+                uint32_t raw;
+                in = readVarint(in, end, raw);
+                if (!in) {
+                    return false;
+                }
+                time_offset = zigzagDecode(raw);
+            }
+            if (s > 0) {
+                time_ms += static_cast<uint64_t>(static_cast<int64_t>(h.tick_ms) + time_offset);
+            }
+            out.time_ms[s] = time_ms;
+            for (size_t f = 0; f < fields; ++f) {
+                if (mask[f / 8] & (1u << (f % 8))) {
+                    uint32_t raw;
+                    in = readVarint(in, end, raw);
+                    if (!in) {
+                        return false;
+                    }
+                    deltas_[f][s] = zigzagDecode(raw);
+                }
+            }
+        }
+
+        for (size_t f = 0; f < kTelemetryStateFields; ++f) {
+            integrateColumn(deltas_[f], 1.0f / kTelemetryStateScale[f], out.state[f]);
+        }
+        out.grants.resize(h.component_count);
+        for (size_t c = 0; c < h.component_count; ++c) {
+            integrateColumn(deltas_[kTelemetryStateFields + c], 1.0f / kTelemetryGrantScale,
+                            out.grants[c]);
+        }
+        return true;
+    }
+
+private:
+    // Sumy modulo 2^32: uszkodzona ramka z poprawnym CRC nie wywoła przepełnienia int32.
+    static void integrateColumn(std::vector<int32_t>& column, float scale, std::vector<float>& out) {
+        size_t n = column.size();
+        for (size_t s = 1; s < n; ++s) {
+            column[s] = static_cast<int32_t>(static_cast<uint32_t>(column[s]) + static_cast<uint32_t>(column[s - 1]));
+        }
+        out.resize(n);
+        const int32_t* src = column.data();
+        float* dst = out.data();
+        for (size_t s = 0; s < n; ++s) {
+            dst[s] = src[s] == kTelemetryInvalid ? NAN : static_cast<float>(src[s]) * scale;
+        }
+    }
+
+    std::vector<std::vector<int32_t>> deltas_;
+};
+
+}
+
+#endif // TELEMETRY_CODEC_HPP
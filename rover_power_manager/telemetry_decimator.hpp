@@ -0,0 +1,169 @@
+#ifndef TELEMETRY_DECIMATOR_HPP
+#define TELEMETRY_DECIMATOR_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#include "power_types.hpp"
+
+namespace rover_energy {
+
+enum class TelemetrySignal {
+    BATTERY_SOC,
+    VOLTAGE,
+    POWER_CONSUMPTION,
+    SOLAR_GENERATION,
+    TEMPERATURE,
+    AVAILABLE_POWER
+};
+
+enum class AggregateStatistic {
+    LAST,
+    MEAN,
+    MIN_MAX
+};
+
+struct DecimatorConfig {
+    std::string topic;
+    TelemetrySignal signal;
+    AggregateStatistic statistic;
+    uint32_t period_ticks;
+    float deadband;
+};
+
+struct AggregateResult {
+    float value;
+    float min;
+    float max;
+    uint32_t samples;
+};
+
+inline const char* telemetrySignalName(TelemetrySignal signal) {
+    switch (signal) {
+        case TelemetrySignal::BATTERY_SOC: return "battery_soc";
+        case TelemetrySignal::VOLTAGE: return "voltage";
+        case TelemetrySignal::POWER_CONSUMPTION: return "power_consumption";
+        case TelemetrySignal::SOLAR_GENERATION: return "solar_generation";
+        case TelemetrySignal::TEMPERATURE: return "temperature";
+        case TelemetrySignal::AVAILABLE_POWER: return "available_power";
+    }
+    return "unknown";
+}
+
+inline const char* aggregateStatisticName(AggregateStatistic statistic) {
+    switch (statistic) {
+        case AggregateStatistic::LAST: return "last";
+        case AggregateStatistic::MEAN: return "mean";
+        case AggregateStatistic::MIN_MAX: return "min_max";
+    }
+    return "unknown";
+}
+
+// Odwrotności nazw z parametrów; false dla nieznanej nazwy.
+inline bool parseTelemetrySignal(const std::string& name, TelemetrySignal& signal) {
+    for (TelemetrySignal s : {TelemetrySignal::BATTERY_SOC, TelemetrySignal::VOLTAGE,
+                              TelemetrySignal::POWER_CONSUMPTION, TelemetrySignal::SOLAR_GENERATION,
+                              TelemetrySignal::TEMPERATURE, TelemetrySignal::AVAILABLE_POWER}) {
+        if (name == telemetrySignalName(s)) {
+            signal = s;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool parseAggregateStatistic(const std::string& name, AggregateStatistic& statistic) {
+    for (AggregateStatistic s : {AggregateStatistic::LAST, AggregateStatistic::MEAN, AggregateStatistic::MIN_MAX}) {
+        if (name == aggregateStatisticName(s)) {
+            statistic = s;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Wyjście wypuszczone mimo strefy martwej co tyle okresów (sygnał życia).
+static constexpr uint32_t kDeadbandHeartbeatPeriods = 10;
+
+inline float selectSignal(const EnergyState& state, float available_power, TelemetrySignal signal) {
+    switch (signal) {
+        case TelemetrySignal::BATTERY_SOC: return state.battery_soc;
+        case TelemetrySignal::VOLTAGE: return state.voltage;
+        case TelemetrySignal::POWER_CONSUMPTION: return state.power_consumption;
+        case TelemetrySignal::SOLAR_GENERATION: return state.solar_generation;
+        case TelemetrySignal::TEMPERATURE: return state.temperature;
+        case TelemetrySignal::AVAILABLE_POWER: return available_power;
+    }
+    return 0.0f;
+}
+
+// Agregat liczony przyrostowo z kolejnych ticków, bez alokacji.
+class DecimatedOutput {
+public:
+    explicit DecimatedOutput(const DecimatorConfig& config)
+        : config_(config) {
+        config_.period_ticks = std::max<uint32_t>(1, config_.period_ticks);
+        resetWindow();
+    }
+
+    const DecimatorConfig& config() const { return config_; }
+
+    // Zwraca true, gdy okno się domknęło i wynik przeszedł przez strefę martwą.
+    bool accumulate(float value, AggregateResult& result) {
+        last_ = value;
+        sum_ += value;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+        if (++count_ < config_.period_ticks) {
+            return false;
+        }
+
+        result.value = config_.statistic == AggregateStatistic::MEAN
+            ? static_cast<float>(sum_ / count_) : last_;
+        result.min = min_;
+        result.max = max_;
+        result.samples = count_;
+        resetWindow();
+
+        bool changed = !has_published_;
+        if (config_.statistic == AggregateStatistic::MIN_MAX) {
+            changed = changed ||
+                std::abs(result.min - published_.min) > config_.deadband ||
+                std::abs(result.max - published_.max) > config_.deadband;
+        } else {
+            changed = changed || std::abs(result.value - published_.value) > config_.deadband;
+        }
+        if (!changed && ++suppressed_periods_ < kDeadbandHeartbeatPeriods) {
+            return false;
+        }
+        published_ = result;
+        has_published_ = true;
+        suppressed_periods_ = 0;
+        return true;
+    }
+
+private:
+    void resetWindow() {
+        sum_ = 0.0;
+        count_ = 0;
+        min_ = std::numeric_limits<float>::max();
+        max_ = std::numeric_limits<float>::lowest();
+    }
+
+    DecimatorConfig config_;
+    double sum_ = 0.0;
+    uint32_t count_ = 0;
+    float last_ = 0.0f;
+    float min_ = 0.0f;
+    float max_ = 0.0f;
+    AggregateResult published_{};
+    bool has_published_ = false;
+    uint32_t suppressed_periods_ = 0;
+};
+
+}
+
+#endif // TELEMETRY_DECIMATOR_HPP
@@ -0,0 +1,166 @@
+#ifndef THERMAL_MODEL_HPP
+#define THERMAL_MODEL_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "mars_time.hpp"
+
+namespace rover_energy {
+
+// Jednowęzłowy model cieplny skrzynki elektroniki:
+//   C dT/dt = -G (T - T_env) + P_wewn + P_grzałki
+struct ThermalConfig {
+    double heat_capacity_j_per_k = 20000.0;
+    double conductance_w_per_k = 0.8;
+    double internal_dissipation_w = 15.0;
+    double heater_power_w = 40.0;
+    double survival_temp_c = -40.0;
+    double max_storage_temp_c = 30.0;
+    double env_mean_temp_c = -60.0;
+    double env_amplitude_c = 35.0;
+    double env_peak_ltst_hours = 14.5;
+};
+
+inline double environmentTemperature(const ThermalConfig& config, double ltst_hours) {
+    double phase = 2.0 * 3.14159265358979323846 * (ltst_hours - config.env_peak_ltst_hours) / 24.0;
+    return config.env_mean_temp_c + config.env_amplitude_c * std::cos(phase);
+}
+
+// Stała moc grzałki, przy której w ustalonym cyklu dobowym węzeł nie spada poniżej progu
+// przetrwania. Wahanie otoczenia jest tłumione bezwładnością węzła (człon pierwszego rzędu,
+// stała czasowa C/G). Próg cieplny dla planów, które zrzucają grzanie.
+inline double survivalHeaterPower(const ThermalConfig& config) {
+    double omega = 2.0 * 3.14159265358979323846 / kSolSeconds;
+    double tau = config.heat_capacity_j_per_k / config.conductance_w_per_k;
+    double swing = config.env_amplitude_c / std::sqrt(1.0 + omega * tau * omega * tau);
+    double coldest = config.env_mean_temp_c - swing;
+    double power = config.conductance_w_per_k * (config.survival_temp_c - coldest) - config.internal_dissipation_w;
+    return std::clamp(power, 0.0, config.heater_power_w);
+}
+
+struct HeaterSchedule {
+    double step_hours = 0.0;            // krok w godzinach LTST
+    std::vector<float> duty;            // wypełnienie grzałki na krok [0, 1]
+    std::vector<float> temperature_c;   // przewidywana temperatura na końcu kroku
+    double heater_energy_wh = 0.0;
+    double battery_energy_wh = 0.0;     // część energii grzałki nie pokryta nadwyżką słoneczną
+    bool survives = true;
+};
+
+// Zachłanne planowanie: dopóki prognoza spada poniżej progu przetrwania,
+// dokładamy wypełnienie w kroku o najniższym koszcie na stopień podniesionej temperatury.
+// Nadwyżka słoneczna jest darmowa, więc grzejemy w dzień i dryfujemy przez noc.
+class HeaterScheduler {
+public:
+    static constexpr float kDutyIncrement = 0.1f;
+
+    explicit HeaterScheduler(const ThermalConfig& config = ThermalConfig())
+        : config_(config) {}
+
+    const ThermalConfig& config() const { return config_; }
+
+    const HeaterSchedule& schedule() const { return schedule_; }
+
+    // step_hours to godziny LTST (jak prognoza słoneczna); dynamika i energia liczone
+    // w czasie fizycznym, step_hours * kMarsHourHours. heater_available == false (tryb
+    // wyłącza grzanie): plan z zerowym wypełnieniem, survives mówi, czy węzeł przetrwa bez grzania.
+    const HeaterSchedule& plan(double temperature_c, double start_ltst_hours, double step_hours,
+                               const std::vector<float>& solar_surplus_w, bool heater_available = true) {
+        size_t n = solar_surplus_w.size();
+        schedule_.step_hours = step_hours;
+        schedule_.duty.assign(n, 0.0f);
+        schedule_.temperature_c.assign(n, 0.0f);
+        env_.resize(n);
+        price_.resize(n);
+        for (size_t k = 0; k < n; ++k) {
+            env_[k] = environmentTemperature(config_, wrapHours(start_ltst_hours + (k + 0.5) * step_hours));
+            double battery_share = 1.0 - std::clamp(
+                solar_surplus_w[k] / config_.heater_power_w, 0.0, 1.0);
+            price_[k] = 0.01 + battery_share;
+        }
+        double dt = step_hours * kMarsHourHours * 3600.0;
+        decay_ = std::exp(-config_.conductance_w_per_k * dt / config_.heat_capacity_j_per_k);
+        gain_ = (1.0 - decay_) / config_.conductance_w_per_k;
+
+        size_t max_rounds = heater_available ? static_cast<size_t>(n / kDutyIncrement) + 1 : 0;
+        for (size_t round = 0; round < max_rounds; ++round) {
+            simulate(temperature_c);
+            size_t violation = n;
+            for (size_t k = 0; k < n; ++k) {
+                if (schedule_.temperature_c[k] < config_.survival_temp_c) {
+                    violation = k;
+                    break;
+                }
+            }
+            if (violation == n) {
+                break;
+            }
+            size_t best = n;
+            double best_cost = 0.0;
+            double effect = 1.0;
+            for (size_t j = violation + 1; j-- > 0; effect *= decay_) {
+                if (schedule_.duty[j] + kDutyIncrement > 1.0f + 1e-6f || !fitsUnderCeiling(j)) {
+                    continue;
+                }
+                double cost = price_[j] / effect;
+                if (best == n || cost < best_cost) {
+                    best = j;
+                    best_cost = cost;
+                }
+            }
+            if (best == n) {
+                break;
+            }
+            schedule_.duty[best] += kDutyIncrement;
+        }
+
+        simulate(temperature_c);
+        schedule_.survives = true;
+        schedule_.heater_energy_wh = 0.0;
+        schedule_.battery_energy_wh = 0.0;
+        for (size_t k = 0; k < n; ++k) {
+            double energy = schedule_.duty[k] * config_.heater_power_w * step_hours * kMarsHourHours;
+            schedule_.heater_energy_wh += energy;
+            schedule_.battery_energy_wh += energy * std::max(0.0, price_[k] - 0.01);
+            schedule_.survives = schedule_.survives &&
+                schedule_.temperature_c[k] >= config_.survival_temp_c - 0.5;
+        }
+        return schedule_;
+    }
+
+private:
+    void simulate(double temperature_c) {
+        double t = temperature_c;
+        for (size_t k = 0; k < schedule_.duty.size(); ++k) {
+            double power = config_.internal_dissipation_w + schedule_.duty[k] * config_.heater_power_w;
+            t = decay_ * t + (1.0 - decay_) * env_[k] + gain_ * power;
+            schedule_.temperature_c[k] = static_cast<float>(t);
+        }
+    }
+
+    // Czy dodatkowe wypełnienie w kroku j nie przegrzeje żadnego późniejszego kroku.
+    bool fitsUnderCeiling(size_t j) const {
+        double rise = gain_ * kDutyIncrement * config_.heater_power_w;
+        for (size_t k = j; k < schedule_.temperature_c.size() && rise > 0.01; ++k) {
+            if (schedule_.temperature_c[k] + rise > config_.max_storage_temp_c) {
+                return false;
+            }
+            rise *= decay_;
+        }
+        return true;
+    }
+
+    ThermalConfig config_;
+    HeaterSchedule schedule_;
+    std::vector<double> env_;
+    std::vector<double> price_;
+    double decay_ = 1.0;
+    double gain_ = 0.0;
+};
+
+}
+
+#endif // THERMAL_MODEL_HPP
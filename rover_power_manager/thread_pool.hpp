@@ -0,0 +1,120 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rover_energy {
+
+// Stała pula wątków pod pętle równoległe: parallelFor() blokuje do końca partii,
+// wątek wywołujący też bierze indeksy, więc pula 0-wątkowa działa sekwencyjnie.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = std::max(1u, std::thread::hardware_concurrency()) - 1) {
+        workers_.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t concurrency() const { return workers_.size() + 1; }
+
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+        if (count == 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> batch_lock(batch_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &fn;
+            count_ = count;
+            next_.store(0);
+            done_ = 0;
+            ++generation_;
+        }
+        wake_.notify_all();
+        runIndices();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        finished_.wait(lock, [this] { return done_ == count_ && active_ == 0; });
+        job_ = nullptr;
+    }
+
+private:
+    void workerLoop() {
+        size_t seen_generation = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stopping_ || (job_ && generation_ != seen_generation); });
+                if (stopping_) {
+                    return;
+                }
+                seen_generation = generation_;
+            }
+            runIndices();
+        }
+    }
+
+    void runIndices() {
+        size_t completed = 0;
+        const std::function<void(size_t)>* job;
+        size_t count;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!job_) {
+                return;
+            }
+            job = job_;
+            count = count_;
+            ++active_;
+        }
+        for (size_t i = next_.fetch_add(1); i < count; i = next_.fetch_add(1)) {
+            (*job)(i);
+            ++completed;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_ += completed;
+        --active_;
+        if (done_ == count_ && active_ == 0) {
+            finished_.notify_all();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex batch_mutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable finished_;
+    const std::function<void(size_t)>* job_ = nullptr;
+    std::atomic<size_t> next_{0};
+    size_t count_ = 0;
+    size_t done_ = 0;
+    size_t active_ = 0;
+    size_t generation_ = 0;
+    bool stopping_ = false;
+};
+
+}
+
+#endif // THREAD_POOL_HPP
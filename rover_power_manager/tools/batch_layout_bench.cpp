@@ -0,0 +1,147 @@
+// Porównanie układów wsadu: PER_ROVER (stepCore na łazik) i LANES (SoA, linia SIMD = łazik).
+// Sprawdza też, że oba układy dają te same metryki. Druga część to przegląd tick po ticku
+// dużej floty (ograniczony pasmem pamięci): pełny CoreState kontra arena CompactRoverState.
+//
+//   g++ -O3 -march=native -std=c++17 -pthread -I.. batch_layout_bench.cpp -o batch_layout_bench
+//   ./batch_layout_bench [rovers] [sols] [threads] [sweep_rovers] [sweep_ticks]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "batch_simulator.hpp"
+#include "compact_state.hpp"
+#include "component_registry.hpp"
+#include "default_components.hpp"
+#include "mars_time.hpp"
+#include "solar_forecast.hpp"
+#include "thread_pool.hpp"
+
+using namespace rover_energy;
+
+int main(int argc, char** argv) {
+    size_t rovers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+    double sols = argc > 2 ? std::strtod(argv[2], nullptr) : 2.0;
+    size_t threads = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1;
+    size_t sweep_rovers = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 16384;
+    size_t sweep_ticks = argc > 5 ? std::strtoul(argv[5], nullptr, 10) : 1000;
+    float step_s = 10.0f;
+
+    std::vector<PowerComponent> components = defaultComponents();
+    ComponentRegistry registry(components);
+    registry.applyDependencies();
+    CoreState initial{};
+    captureComponents(components, registry.allocationOrder(), initial);
+    initial.energy = {80.0f, 28.0f, 0.0f, 0.0f, 0.0f, -20.0f, PowerMode::NORMAL};
+    initial.mode.mode = PowerMode::NORMAL;
+    initial.mode.thresholds = ModeThresholds();
+    initial.battery.capacity_wh = 2000.0f;
+    initial.battery.solar_calibration = 1.0f;
+    size_t science_index = 6;
+
+    // Jeden scenariusz na łazik, polityki rozrzucone wokół progów domyślnych
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    size_t steps = static_cast<size_t>(sols * kSolSeconds / step_s);
+    std::vector<Scenario> scenarios(rovers);
+    std::vector<PolicyParameters> policies(1);
+    for (auto& scenario : scenarios) {
+        SolarArrayModel model;
+        model.optical_depth = 0.3 + 0.7 * unit(rng);
+        SolarForecaster forecaster(model);
+        scenario.step_s = step_s;
+        scenario.initial_soc = static_cast<float>(40.0 + 50.0 * unit(rng));
+        scenario.solar_w.resize(steps);
+        forecaster.clearSkyForecast(18.4, marsTimeFromUnix(1.7e9 + unit(rng) * 668.6 * kSolSeconds),
+                                    24.0 * unit(rng), step_s / kSolSeconds * 24.0, steps, scenario.solar_w.data());
+    }
+    policies[0].thresholds.min_dwell_s = 60.0f;
+
+    ThreadPool pool(threads - 1);
+    BatchSimulator simulator(pool);
+    std::vector<SimulationMetrics> results[2];
+    const char* names[2] = {"per_rover", "lanes"};
+    BatchLayout layouts[2] = {BatchLayout::PER_ROVER, BatchLayout::LANES};
+    for (int i = 0; i < 2; ++i) {
+        simulator.setLayout(layouts[i]);
+        simulator.run(initial, policies, scenarios, science_index, results[i]);
+        auto start = std::chrono::steady_clock::now();
+        simulator.run(initial, policies, scenarios, science_index, results[i]);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%-10s %8.1f ms  %6.2f ns/rover-tick\n", names[i], seconds * 1e3,
+                    seconds * 1e9 / (static_cast<double>(rovers) * steps));
+    }
+
+    float max_soc_diff = 0.0f;
+    size_t mismatched = 0;
+    for (size_t r = 0; r < rovers; ++r) {
+        const SimulationMetrics& a = results[0][r];
+        const SimulationMetrics& b = results[1][r];
+        max_soc_diff = std::max({max_soc_diff, std::fabs(a.min_soc - b.min_soc), std::fabs(a.final_soc - b.final_soc)});
+        mismatched += a.transitions != b.transitions || a.science_hours != b.science_hours ||
+                      a.emergency_hours != b.emergency_hours;
+    }
+    std::printf("max soc difference %.6f, mismatched rovers %zu of %zu\n", max_soc_diff, mismatched, rovers);
+
+    // Przegląd tick po ticku: łazik i korzysta ze scenariusza i % rovers
+    sweep_ticks = std::min(sweep_ticks, steps);
+    std::vector<StepInputs> inputs(sweep_rovers);
+    auto fill_inputs = [&](size_t k) {
+        for (size_t i = 0; i < sweep_rovers; ++i) {
+            inputs[i] = {scenarios[i % rovers].solar_w[k], 0.0f};
+        }
+    };
+
+    std::vector<CoreState> full(sweep_rovers, initial);
+    for (size_t i = 0; i < sweep_rovers; ++i) {
+        full[i].mode.thresholds = policies[0].thresholds;
+        full[i].energy.battery_soc = scenarios[i % rovers].initial_soc;
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < sweep_ticks; ++k) {
+        fill_inputs(k);
+        for (size_t i = 0; i < sweep_rovers; ++i) {
+            stepCore(full[i], inputs[i], step_s);
+        }
+    }
+    double full_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    CompactTable table;
+    std::string error;
+    if (!buildCompactTable(initial, {policies[0].thresholds}, science_index, table, error)) {
+        std::fprintf(stderr, "compact table: %s\n", error.c_str());
+        return 1;
+    }
+    CompactArena arena(std::move(table));
+    arena.reserve(sweep_rovers);
+    for (size_t i = 0; i < sweep_rovers; ++i) {
+        CoreState s = initial;
+        s.energy.battery_soc = scenarios[i % rovers].initial_soc;
+        arena.add(s, 0);
+    }
+    start = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < sweep_ticks; ++k) {
+        fill_inputs(k);
+        arena.step(0, sweep_rovers, inputs.data(), step_s);
+    }
+    double compact_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    float max_final_diff = 0.0f;
+    size_t same_mode = 0;
+    for (size_t i = 0; i < sweep_rovers; ++i) {
+        max_final_diff = std::max(max_final_diff, std::fabs(full[i].energy.battery_soc - arena[i].soc / kCompactSocScale));
+        same_mode += static_cast<uint8_t>(full[i].mode.mode) == arena[i].mode;
+    }
+    double rover_ticks = static_cast<double>(sweep_rovers) * sweep_ticks;
+    std::printf("sweep %zu rovers x %zu ticks\n", sweep_rovers, sweep_ticks);
+    std::printf("%-10s %8.1f ms  %6.2f ns/rover-tick  %6zu B/rover\n", "core", full_s * 1e3,
+                full_s * 1e9 / rover_ticks, sizeof(CoreState));
+    std::printf("%-10s %8.1f ms  %6.2f ns/rover-tick  %6zu B/rover\n", "compact", compact_s * 1e3,
+                compact_s * 1e9 / rover_ticks, sizeof(CompactRoverState));
+    std::printf("compact vs core: max final soc difference %.4f, same final mode %zu of %zu\n",
+                max_final_diff, same_mode, sweep_rovers);
+    return mismatched == 0 ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+// Sprawdzenie RealFft<N> (power_quality.hpp) względem naiwnej DFT w double dla N = 4..1024:
+// szum ze składową stałą, czyste tony na binach (w tym Nyquist) i ton między binami.
+// Błąd liczony względem sumy |x| (górne ograniczenie |X[k]|), próg dla float z zapasem.
+// Kod wyjścia 0 = zgodne, 1 = rozbieżności.
+//
+//   g++ -O2 -std=c++17 -I.. fft_check.cpp -o fft_check
+//   ./fft_check
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "power_quality.hpp"
+
+using namespace rover_energy;
+
+namespace {
+
+static constexpr double kTolerance = 1e-6;
+
+// Największy błąd widma upakowanego względem DFT, znormalizowany sumą |x|.
+template <size_t N>
+double packedError(const RealFft<N>& fft, const std::vector<double>& x) {
+    std::vector<float> data(x.begin(), x.end());
+    fft.forward(data.data());
+    double norm = 0.0;
+    for (double v : x) {
+        norm += std::fabs(v);
+    }
+    double worst = 0.0;
+    for (size_t k = 0; k <= N / 2; ++k) {
+        std::complex<double> reference = 0.0;
+        for (size_t n = 0; n < N; ++n) {
+            reference += x[n] * std::polar(1.0, -kTwoPi * static_cast<double>(k * n % N) / N);
+        }
+        std::complex<double> packed = k == 0 ? std::complex<double>(data[0], 0.0)
+                                    : k == N / 2 ? std::complex<double>(data[1], 0.0)
+                                    : std::complex<double>(data[2 * k], data[2 * k + 1]);
+        worst = std::max(worst, std::abs(packed - reference));
+    }
+    return norm > 0.0 ? worst / norm : worst;
+}
+
+template <size_t N>
+size_t checkSize(std::mt19937& rng) {
+    RealFft<N> fft;
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    std::vector<std::vector<double>> signals;
+
+    for (int trial = 0; trial < 4; ++trial) {
+        std::vector<double> x(N);
+        for (double& v : x) {
+            v = 28.0 * (trial == 0) + uniform(rng);
+        }
+        signals.push_back(x);
+    }
+    for (size_t k : {size_t{1}, N / 4, N / 2 - 1, N / 2}) {
+        std::vector<double> x(N);
+        for (size_t n = 0; n < N; ++n) {
+            x[n] = std::cos(kTwoPi * static_cast<double>(k * n) / N + 0.3);
+        }
+        signals.push_back(x);
+    }
+    std::vector<double> between(N);
+    for (size_t n = 0; n < N; ++n) {
+        between[n] = std::sin(kTwoPi * 2.37 * static_cast<double>(n) / N);
+    }
+    signals.push_back(between);
+
+    double worst = 0.0;
+    size_t failed = 0;
+    for (const auto& x : signals) {
+        double error = packedError(fft, x);
+        worst = std::max(worst, error);
+        failed += error > kTolerance;
+    }
+    std::printf("N %5zu  signals %zu  max relative error %.2e%s\n", N, signals.size(), worst,
+                failed ? "  FAILED" : "");
+    return failed;
+}
+
+}
+
+int main() {
+    std::mt19937 rng(7);
+    size_t failed = checkSize<4>(rng) + checkSize<8>(rng) + checkSize<16>(rng) + checkSize<32>(rng) +
+                    checkSize<64>(rng) + checkSize<128>(rng) + checkSize<kPowerQualityWindow>(rng) +
+                    checkSize<512>(rng) + checkSize<1024>(rng);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+// Sprawdzenie History (energy_core.hpp): copy-on-write po rozwidleniu, przesuwanie okna
+// pierścienia, wyczerpanie puli fragmentów przez trzymane kopie i powrót po ich zwolnieniu.
+// Każda kopia porównywana jest z własnym przebiegiem wzorcowym (std::vector próbek).
+// Kod wyjścia 0 = zgodne, 1 = rozbieżności.
+//
+//   g++ -O2 -std=c++17 -I.. history_check.cpp -o history_check
+//   ./history_check
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "energy_core.hpp"
+
+using namespace rover_energy;
+
+namespace {
+
+// Czas uniksowy: kolejne próbki różnią się o 1 s (float zaokrągliłby je do 128 s).
+HistorySample makeSample(size_t i, int branch) {
+    return {1760000000.0 + static_cast<double>(i), static_cast<float>(i % 1000) * 0.1f,
+            static_cast<float>(branch), static_cast<float>(i % 7), static_cast<PowerMode>(i % kPowerModeCount)};
+}
+
+bool sameSample(const HistorySample& a, const HistorySample& b) {
+    return a.time_s == b.time_s && a.soc == b.soc && a.power_consumption == b.power_consumption &&
+           a.solar_generation == b.solar_generation && a.mode == b.mode;
+}
+
+// Historia musi zawierać ostatnie size() próbek wzorca (starsze wypadły z pierścienia).
+bool matches(const History& history, const std::vector<HistorySample>& reference, size_t max_samples,
+             const char* what) {
+    size_t expected = std::min(reference.size(), max_samples);
+    bool ok = history.size() >= expected && history.size() <= reference.size();
+    size_t first = reference.size() - history.size();
+    for (size_t i = 0; ok && i < history.size(); ++i) {
+        ok = sameSample(history[i], reference[first + i]);
+    }
+    if (ok && !reference.empty()) {
+        ok = history.latest() && sameSample(*history.latest(), reference.back());
+    }
+    if (!ok) {
+        std::fprintf(stderr, "%s: history of %zu samples differs from %zu reference samples\n", what,
+                     history.size(), reference.size());
+    }
+    return ok;
+}
+
+struct Branch {
+    History history;
+    std::vector<HistorySample> reference;
+};
+
+}
+
+int main() {
+    const size_t max_chunks = 4;
+    const size_t window = max_chunks * kHistoryChunkSamples;
+    size_t failures = 0;
+
+    // Rozwidlenie w środku ogona: obie gałęzie piszą dalej niezależnie.
+    Branch main_branch{History(max_chunks), {}};
+    for (size_t i = 0; i < 300; ++i) {
+        main_branch.history.append(makeSample(i, 0));
+        main_branch.reference.push_back(makeSample(i, 0));
+    }
+    Branch fork{main_branch.history, main_branch.reference};
+    for (size_t i = 300; i < 300 + 2 * window; ++i) {
+        main_branch.history.append(makeSample(i, 0));
+        main_branch.reference.push_back(makeSample(i, 0));
+        if (i < 700) {
+            fork.history.append(makeSample(i, 1));
+            fork.reference.push_back(makeSample(i, 1));
+        }
+    }
+    failures += !matches(main_branch.history, main_branch.reference, window, "main after fork");
+    failures += !matches(fork.history, fork.reference, window, "fork");
+
+    // Kopie trzymane podczas zapisu przypinają fragmenty, aż pula się wyczerpie.
+    std::vector<Branch> held;
+    size_t next = main_branch.reference.size();
+    bool exhausted = false;
+    while (!exhausted && held.size() < 64) {
+        held.push_back({main_branch.history, main_branch.reference});
+        for (size_t k = 0; k < kHistoryChunkSamples && !exhausted; ++k, ++next) {
+            if (main_branch.history.append(makeSample(next, 0))) {
+                main_branch.reference.push_back(makeSample(next, 0));
+            } else {
+                exhausted = true;
+            }
+        }
+    }
+    if (!exhausted) {
+        std::fprintf(stderr, "pool never ran out with %zu held copies\n", held.size());
+        ++failures;
+    }
+    failures += !matches(main_branch.history, main_branch.reference, window, "main at exhaustion");
+    for (const Branch& copy : held) {
+        failures += !matches(copy.history, copy.reference, window, "held copy");
+    }
+
+    // Po zwolnieniu kopii zapis znowu przechodzi, a okno idzie dalej bez przerw.
+    size_t held_copies = held.size();
+    held.clear();
+    for (size_t k = 0; k < 2 * window; ++k, ++next) {
+        if (!main_branch.history.append(makeSample(next, 0))) {
+            std::fprintf(stderr, "append still failing after the copies were released\n");
+            ++failures;
+            break;
+        }
+        main_branch.reference.push_back(makeSample(next, 0));
+    }
+    failures += !matches(main_branch.history, main_branch.reference, window, "main after release");
+
+    // Domyślna historia tworzy pulę przy pierwszej próbce.
+    Branch lazy;
+    for (size_t i = 0; i < 3 * kHistoryChunkSamples; ++i) {
+        lazy.history.append(makeSample(i, 2));
+        lazy.reference.push_back(makeSample(i, 2));
+    }
+    failures += !matches(lazy.history, lazy.reference, kDefaultHistoryChunks * kHistoryChunkSamples, "lazy");
+
+    std::printf("held copies at exhaustion %zu  failures %zu\n", held_copies, failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+// Przegląd siatki progów późnej misji: pierwsze split_sol soli z progami domyślnymi,
+// potem low_power_soc × normal_soc z siatki. Liczy przegląd dwa razy (bez i z
+// zapamiętywaniem odcinków), sprawdza zgodność wyników i wypisuje CSV.
+//
+//   g++ -O3 -march=native -std=c++17 -pthread -I.. policy_sweep.cpp -o policy_sweep
+//   ./policy_sweep [scenarios] [sols] [split_sol] [threads] > sweep.csv
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "batch_simulator.hpp"
+#include "component_registry.hpp"
+#include "default_components.hpp"
+#include "mars_time.hpp"
+#include "solar_forecast.hpp"
+#include "sweep_engine.hpp"
+#include "thread_pool.hpp"
+
+using namespace rover_energy;
+
+int main(int argc, char** argv) {
+    size_t scenario_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+    double sols = argc > 2 ? std::strtod(argv[2], nullptr) : 20.0;
+    double split_sol = argc > 3 ? std::strtod(argv[3], nullptr) : 10.0;
+    size_t threads = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 1;
+    float step_s = 10.0f;
+    if (scenario_count == 0 || sols <= 0.0 || split_sol < 0.0 || threads == 0) {
+        std::fprintf(stderr, "usage: %s [scenarios] [sols] [split_sol] [threads]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<PowerComponent> components = defaultComponents();
+    ComponentRegistry registry(components);
+    registry.applyDependencies();
+    SweepSpec spec;
+    spec.initial = CoreState{};
+    captureComponents(components, registry.allocationOrder(), spec.initial);
+    spec.initial.energy = {80.0f, 28.0f, 0.0f, 0.0f, 0.0f, -20.0f, PowerMode::NORMAL};
+    spec.initial.mode.mode = PowerMode::NORMAL;
+    spec.initial.mode.planned_mode = PowerMode::NORMAL;
+    spec.initial.battery.capacity_wh = 2000.0f;
+    spec.initial.battery.solar_calibration = 1.0f;
+    spec.base.min_dwell_s = 60.0f;
+    spec.science_index = 6;
+
+    // Scenariusze: pora roku, nieprzezroczystość i SOC początkowy z ziarna
+    std::mt19937_64 rng(11);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    size_t steps = static_cast<size_t>(sols * kSolSeconds / step_s);
+    size_t steps_per_sol = static_cast<size_t>(kSolSeconds / step_s);
+    std::vector<Scenario> scenarios(scenario_count);
+    for (auto& scenario : scenarios) {
+        SolarArrayModel model;
+        model.optical_depth = 0.3 + 0.7 * unit(rng);
+        SolarForecaster forecaster(model);
+        scenario.step_s = step_s;
+        scenario.initial_soc = static_cast<float>(40.0 + 50.0 * unit(rng));
+        scenario.solar_w.resize(steps);
+        forecaster.clearSkyForecast(18.4, marsTimeFromUnix(1.7e9 + unit(rng) * 668.6 * kSolSeconds), 6.0,
+                                    step_s / kSolSeconds * 24.0, steps, scenario.solar_w.data());
+        spec.scenarios.push_back(scenario.view());
+    }
+    spec.checkpoint_steps = steps_per_sol;
+    size_t split_step = static_cast<size_t>(split_sol * kSolSeconds / step_s);
+    spec.axes.push_back({"mode.low_power_soc", split_step, {20.0f, 25.0f, 30.0f, 35.0f}});
+    spec.axes.push_back({"mode.normal_soc", split_step, {40.0f, 50.0f, 60.0f}});
+
+    ThreadPool pool(threads - 1);
+    SweepEngine engine(pool);
+    std::vector<SweepRun> runs[2];
+    double seconds[2];
+    const char* names[2] = {"full", "memoized"};
+    for (int i = 0; i < 2; ++i) {
+        engine.setMemoize(i == 1);
+        engine.clearCache();
+        std::string error;
+        auto start = std::chrono::steady_clock::now();
+        if (!engine.run(spec, runs[i], error)) {
+            std::fprintf(stderr, "sweep failed: %s\n", error.c_str());
+            return 1;
+        }
+        seconds[i] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const SweepStats& stats = engine.stats();
+        std::fprintf(stderr, "%-8s %8.1f ms  runs %zu  chunks %zu/%zu simulated  cache hits %zu  shared %zu\n",
+                     names[i], seconds[i] * 1e3, stats.runs, stats.chunks_simulated, stats.chunks_total,
+                     stats.cache_hits, stats.deduplicated);
+    }
+
+    size_t mismatched = 0;
+    for (size_t r = 0; r < runs[0].size(); ++r) {
+        mismatched += std::memcmp(&runs[0][r].metrics, &runs[1][r].metrics, sizeof(SimulationMetrics)) != 0;
+    }
+    std::fprintf(stderr, "speedup %.2fx, %zu mismatched runs\n", seconds[0] / seconds[1], mismatched);
+
+    std::printf("scenario,low_power_soc,normal_soc,min_soc,final_soc,science_h,emergency_h,transitions\n");
+    for (const auto& run : runs[1]) {
+        const SimulationMetrics& m = run.metrics;
+        std::printf("%zu,%.1f,%.1f,%.3f,%.3f,%.2f,%.2f,%u\n", run.scenario, run.values[0], run.values[1], m.min_soc,
+                    m.final_soc, m.science_hours, m.emergency_hours, m.transitions);
+    }
+    return mismatched ? 1 : 0;
+}
@@ -0,0 +1,251 @@
+// Strojenie polityki trybów offline: CMA-ES na korpusie scenariuszy, symulacja
+// wsadowa na wszystkich rdzeniach, raport frontu Pareto (czas nauki vs minimalny SOC).
+//
+//   g++ -O3 -march=native -std=c++17 -pthread -I.. policy_tuner.cpp -o policy_tuner
+//   ./policy_tuner --scenarios 32 --sols 2 --generations 40 --weights 5 > front.csv
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "batch_simulator.hpp"
+#include "component_registry.hpp"
+#include "default_components.hpp"
+#include "energy_core.hpp"
+#include "mars_time.hpp"
+#include "policy_tuning.hpp"
+#include "solar_forecast.hpp"
+#include "thread_pool.hpp"
+
+using namespace rover_energy;
+
+namespace {
+
+struct TunerOptions {
+    size_t scenarios = 32;
+    double sols = 2.0;
+    float step_s = 10.0f;
+    size_t generations = 40;
+    size_t weights = 5;
+    double latitude_deg = 18.4;
+    double battery_capacity_wh = 2000.0;
+    uint64_t seed = 1;
+};
+
+struct Evaluation {
+    std::vector<double> x;
+    float science_hours_per_sol;    // średnia po korpusie
+    float min_soc;                  // najgorszy przypadek korpusu
+    float emergency_hours;          // średnia po korpusie
+};
+
+bool parseOptions(int argc, char** argv, TunerOptions& options) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char* key = argv[i];
+        const char* value = argv[i + 1];
+        if (!std::strcmp(key, "--scenarios")) options.scenarios = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(key, "--sols")) options.sols = std::strtod(value, nullptr);
+        else if (!std::strcmp(key, "--step")) options.step_s = std::strtof(value, nullptr);
+        else if (!std::strcmp(key, "--generations")) options.generations = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(key, "--weights")) options.weights = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(key, "--latitude")) options.latitude_deg = std::strtod(value, nullptr);
+        else if (!std::strcmp(key, "--capacity")) options.battery_capacity_wh = std::strtod(value, nullptr);
+        else if (!std::strcmp(key, "--seed")) options.seed = std::strtoull(value, nullptr, 10);
+        else return false;
+    }
+    return (argc % 2) == 1 && options.scenarios > 0 && options.sols > 0.0 && options.step_s > 0.0f &&
+           options.weights > 0;
+}
+
+// Korpus syntetyczny: pora roku, nieprzezroczystość, godzina startu, SOC
+// początkowy i jazdy losowane z ziarna, więc przebiegi są powtarzalne.
+std::vector<Scenario> buildCorpus(const TunerOptions& options) {
+    std::mt19937_64 rng(options.seed);
+    std::uniform_real_distribution<double> season(0.0, 668.6 * kSolSeconds);
+    std::uniform_real_distribution<double> opacity(0.3, 1.0);
+    std::uniform_real_distribution<double> start_ltst(0.0, 24.0);
+    std::uniform_real_distribution<float> initial_soc(40.0f, 90.0f);
+    std::uniform_real_distribution<double> drive_start(0.0, 1.0);
+
+    size_t steps = static_cast<size_t>(options.sols * kSolSeconds / options.step_s);
+    double step_ltst_hours = options.step_s / kSolSeconds * 24.0;
+    std::vector<Scenario> corpus(options.scenarios);
+    for (auto& scenario : corpus) {
+        SolarArrayModel model;
+        model.optical_depth = opacity(rng);
+        SolarForecaster forecaster(model);
+        MarsTime mars_time = marsTimeFromUnix(1.7e9 + season(rng));
+
+        scenario.step_s = options.step_s;
+        scenario.initial_soc = initial_soc(rng);
+        scenario.solar_w.resize(steps);
+        forecaster.clearSkyForecast(options.latitude_deg, mars_time, start_ltst(rng), step_ltst_hours,
+                                    steps, scenario.solar_w.data());
+
+        // Jedna godzina jazdy (40 W) na sol w losowej chwili
+        scenario.extra_load_w.assign(steps, 0.0f);
+        size_t drive_steps = static_cast<size_t>(3600.0f / options.step_s);
+        size_t steps_per_sol = static_cast<size_t>(kSolSeconds / options.step_s);
+        for (size_t sol_start = 0; sol_start + drive_steps < steps; sol_start += steps_per_sol) {
+            size_t begin = sol_start + static_cast<size_t>(drive_start(rng) * (steps_per_sol - drive_steps));
+            for (size_t k = begin; k < std::min(steps, begin + drive_steps); ++k) {
+                scenario.extra_load_w[k] = 40.0f;
+            }
+        }
+    }
+    return corpus;
+}
+
+CoreState initialState(const TunerOptions& options, CoreMetadata& metadata) {
+    std::vector<PowerComponent> components = defaultComponents();
+    ComponentRegistry registry(components);
+    registry.applyDependencies();
+
+    CoreState state{};
+    captureComponents(components, registry.allocationOrder(), state);
+    state.energy = {80.0f, 28.0f, 0.0f, 0.0f, 0.0f, -20.0f, PowerMode::NORMAL};
+    state.mode.mode = PowerMode::NORMAL;
+    state.mode.planned_mode = PowerMode::NORMAL;
+    state.mode.thresholds = ModeThresholds();
+    state.battery.capacity_wh = static_cast<float>(options.battery_capacity_wh);
+    state.battery.solar_calibration = 1.0f;
+    for (const auto& comp : components) {
+        metadata.names.push_back(comp.name);
+    }
+    return state;
+}
+
+void summarize(const std::vector<SimulationMetrics>& metrics, size_t policy, size_t scenarios,
+               double sols, Evaluation& evaluation) {
+    float science = 0.0f;
+    float emergency = 0.0f;
+    float min_soc = 100.0f;
+    for (size_t s = 0; s < scenarios; ++s) {
+        const SimulationMetrics& m = metrics[policy * scenarios + s];
+        science += m.science_hours;
+        emergency += m.emergency_hours;
+        min_soc = std::min(min_soc, m.min_soc);
+    }
+    evaluation.science_hours_per_sol = static_cast<float>(science / scenarios / sols);
+    evaluation.emergency_hours = emergency / scenarios;
+    evaluation.min_soc = min_soc;
+}
+
+void printEvaluation(const Evaluation& e, const PolicySpace& space, const CoreMetadata& metadata) {
+    PolicyParameters p = space.decode(e.x);
+    const ModeThresholds& t = p.thresholds;
+    std::printf("%.3f,%.2f,%.3f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.1f,", e.science_hours_per_sol, e.min_soc,
+                e.emergency_hours, t.emergency_soc, t.hibernation_solar_w, t.hibernation_soc, t.low_power_soc,
+                t.low_power_balance_w, t.normal_soc, t.normal_balance_w, t.min_dwell_s);
+    for (size_t k = 0; k < metadata.names.size(); ++k) {
+        std::printf("%s%s", k ? ">" : "", metadata.names[p.allocation_order[k]].c_str());
+    }
+    std::printf("\n");
+}
+
+}
+
+int main(int argc, char** argv) {
+    TunerOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: %s [--scenarios N] [--sols S] [--step s] [--generations G] "
+                             "[--weights W] [--latitude deg] [--capacity Wh] [--seed X]\n", argv[0]);
+        return 1;
+    }
+
+    CoreMetadata metadata;
+    CoreState initial = initialState(options, metadata);
+    size_t science_index = metadata.find("science_instruments");
+    std::vector<Scenario> corpus = buildCorpus(options);
+    PolicySpace space(initial);
+
+    ThreadPool pool;
+    BatchSimulator simulator(pool, BatchLayout::LANES);
+    std::vector<SimulationMetrics> metrics;
+    std::vector<PolicyParameters> policies;
+    std::vector<Evaluation> archive;
+
+    // Punkt odniesienia: progi domyślne węzła
+    Evaluation baseline;
+    baseline.x = space.encode(ModeThresholds());
+    policies.assign(1, space.decode(baseline.x));
+    simulator.run(initial, policies, corpus, science_index, metrics);
+    summarize(metrics, 0, corpus.size(), options.sols, baseline);
+    archive.push_back(baseline);
+
+    // Skalaryzacja ważona: w = 1 to sama nauka, w = 0 to sam zapas SOC.
+    // Kara za tryb EMERGENCY trzyma optymalizator z dala od progu przetrwania.
+    for (size_t w = 0; w < options.weights; ++w) {
+        double weight = options.weights > 1 ? static_cast<double>(w) / (options.weights - 1) : 0.5;
+        CmaEs cma(baseline.x, 0.3, options.seed * 7919 + w);
+        std::vector<double> fitness(cma.lambda());
+        for (size_t g = 0; g < options.generations; ++g) {
+            const auto& population = cma.ask();
+            policies.resize(population.size());
+            for (size_t i = 0; i < population.size(); ++i) {
+                policies[i] = space.decode(population[i]);
+            }
+            simulator.run(initial, policies, corpus, science_index, metrics);
+            for (size_t i = 0; i < population.size(); ++i) {
+                Evaluation e;
+                e.x = population[i];
+                summarize(metrics, i, corpus.size(), options.sols, e);
+                fitness[i] = -(weight * e.science_hours_per_sol / kSolHours + (1.0 - weight) * e.min_soc / 100.0) +
+                             e.emergency_hours / (options.sols * kSolHours);
+                archive.push_back(std::move(e));
+            }
+            cma.tell(fitness);
+        }
+        std::fprintf(stderr, "weight %.2f: sigma %.3f after %zu generations\n", weight, cma.sigma(),
+                     options.generations);
+    }
+
+    std::vector<float> science(archive.size());
+    std::vector<float> min_soc(archive.size());
+    for (size_t i = 0; i < archive.size(); ++i) {
+        science[i] = archive[i].science_hours_per_sol;
+        min_soc[i] = archive[i].min_soc;
+    }
+    std::vector<size_t> front = paretoFront(science, min_soc);
+
+    std::printf("science_h_per_sol,min_soc,emergency_h,emergency_soc,hibernation_solar_w,hibernation_soc,"
+                "low_power_soc,low_power_balance_w,normal_soc,normal_balance_w,min_dwell_s,allocation_order\n");
+    std::printf("# baseline\n");
+    printEvaluation(baseline, space, metadata);
+    std::printf("# pareto front (%zu of %zu evaluated policies)\n", front.size(), archive.size());
+    for (size_t i : front) {
+        printEvaluation(archive[i], space, metadata);
+    }
+    if (front.empty()) {
+        return 0;
+    }
+
+    // Kolano frontu: największa suma celów znormalizowanych do zakresu frontu
+    float science_lo = science[front.back()], science_hi = science[front.front()];
+    float soc_lo = min_soc[front.front()], soc_hi = min_soc[front.back()];
+    size_t knee = front.front();
+    float best = -INFINITY;
+    for (size_t i : front) {
+        float score = (science[i] - science_lo) / std::max(science_hi - science_lo, 1e-6f) +
+                      (min_soc[i] - soc_lo) / std::max(soc_hi - soc_lo, 1e-6f);
+        if (score > best) {
+            best = score;
+            knee = i;
+        }
+    }
+    PolicyParameters p = space.decode(archive[knee].x);
+    const ModeThresholds& t = p.thresholds;
+    std::printf("# knee as node parameters\n"
+                "# power_manager:\n#   ros__parameters:\n"
+                "#     mode.emergency_soc: %.2f\n#     mode.hibernation_solar_w: %.2f\n"
+                "#     mode.hibernation_soc: %.2f\n#     mode.low_power_soc: %.2f\n"
+                "#     mode.low_power_balance_w: %.2f\n#     mode.normal_soc: %.2f\n"
+                "#     mode.normal_balance_w: %.2f\n#     mode.min_dwell_s: %.1f\n",
+                t.emergency_soc, t.hibernation_solar_w, t.hibernation_soc, t.low_power_soc,
+                t.low_power_balance_w, t.normal_soc, t.normal_balance_w, t.min_dwell_s);
+    return 0;
+}
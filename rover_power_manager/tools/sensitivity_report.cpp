@@ -0,0 +1,276 @@
+// Raport wrażliwości SOC na koniec symulacji względem parametrów modelu: jeden przebieg
+// rdzenia na liczbach dualnych (różniczkowanie w przód) daje wszystkie pochodne naraz.
+// Progi trybów działają tylko przez porównania (pochodna po ścieżce = 0), więc dla nich
+// raport liczy różnice centralne. --check liczy różnice centralne także dla parametrów
+// ciągłych, do porównania z pochodnymi dualnymi: bez zmian trybu wyniki są zgodne,
+// a rozbieżność oznacza, że zaburzenie przesuwa przełączenia (skoki, których AD nie widzi).
+// Przebieg dualny zlicza zmiany trybu i stanów zasilania; jeśli jakakolwiek wystąpiła,
+// wiersze dualne są oznaczone dual_unreliable, a raport zawsze dokłada różnice centralne.
+//
+//   g++ -O3 -march=native -std=c++17 -pthread -I.. sensitivity_report.cpp -o sensitivity_report
+//   ./sensitivity_report --check 1 > sensitivity.csv
+//
+// Domyślny scenariusz (ćwierć sola od 9:00 LTST, tau 0.3, SOC 90 %) przechodzi bez przełączeń,
+// więc pochodne dualne są tam wiarygodne.
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "component_registry.hpp"
+#include "default_components.hpp"
+#include "dual.hpp"
+#include "energy_core.hpp"
+#include "mars_time.hpp"
+#include "solar_forecast.hpp"
+#include "sweep_engine.hpp"
+
+using namespace rover_energy;
+
+namespace {
+
+struct ReportOptions {
+    double sols = 0.25;
+    float step_s = 10.0f;
+    double latitude_deg = 18.4;
+    double unix_s = 1.7e9;
+    double start_ltst_hours = 9.0;
+    double drive_ltst_hours = 11.0;     // godzina jazdy na sol
+    double optical_depth = 0.3;
+    double efficiency = 0.25;
+    double initial_soc = 90.0;
+    double battery_capacity_wh = 2000.0;
+    double drive_power_w = 40.0;
+    bool check = false;
+};
+
+// Parametry ciągłe różniczkowane liczbami dualnymi
+enum Parameter : size_t {
+    PANEL_EFFICIENCY,
+    OPTICAL_DEPTH,          // pył w atmosferze (tau)
+    PANEL_DUST_FACTOR,      // pył na panelu: mnożnik generacji
+    HEATER_POWER,
+    SCIENCE_POWER,
+    BATTERY_CAPACITY,
+    INITIAL_SOC,
+    DRIVE_POWER,
+    kParameterCount
+};
+
+const char* kParameterNames[kParameterCount] = {
+    "panel_efficiency", "optical_depth", "panel_dust_factor", "heater_power_w",
+    "science_power_w", "battery_capacity_wh", "initial_soc", "drive_power_w"};
+
+const char* kThresholdNames[] = {
+    "mode.emergency_soc", "mode.hibernation_solar_w", "mode.hibernation_soc", "mode.low_power_soc",
+    "mode.low_power_balance_w", "mode.normal_soc", "mode.normal_balance_w", "mode.min_dwell_s"};
+
+using Gradient = Dual<double, kParameterCount>;
+
+bool parseOptions(int argc, char** argv, ReportOptions& options) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char* key = argv[i];
+        const char* value = argv[i + 1];
+        if (!std::strcmp(key, "--sols")) options.sols = std::strtod(value, nullptr);
+        else if (!std::strcmp(key, "--step")) options.step_s = std::strtof(value, nullptr);
+        else if (!std::strcmp(key, "--latitude")) options.latitude_deg = std::strtod(value, nullptr);
+        else if (!std::strcmp(key, "--unix")) options.unix_s = std::strtod(value, nullptr);
+        else if (!std::strcmp(key, "--start-ltst")) options.start_ltst_hours = std::strtod(value, nullptr);
+        else if (!std::strcmp(key, "--drive-ltst")) options.drive_ltst_hours = std::strtod(value, nullptr);
+        else if (!std::strcmp(key, "--opacity")) options.optical_depth = std::strtod(value, nullptr);
+        else if (!std::strcmp(key, "--efficiency")) options.efficiency = std::strtod(value, nullptr);
+        else if (!std::strcmp(key, "--soc")) options.initial_soc = std::strtod(value, nullptr);
+        else if (!std::strcmp(key, "--capacity")) options.battery_capacity_wh = std::strtod(value, nullptr);
+        else if (!std::strcmp(key, "--drive-w")) options.drive_power_w = std::strtod(value, nullptr);
+        else if (!std::strcmp(key, "--check")) options.check = std::strtol(value, nullptr, 10) != 0;
+        else return false;
+    }
+    return (argc % 2) == 1 && options.sols > 0.0 && options.step_s > 0.0f && options.battery_capacity_wh > 0.0;
+}
+
+// Przełączenia w przebiegu: pochodna dualna nie widzi przesunięcia ich chwil.
+struct SwitchCounts {
+    uint32_t mode = 0;
+    uint32_t power_state = 0;
+};
+
+struct Outcome {
+    double final_soc;
+    double min_soc;
+    SwitchCounts switches;
+    std::array<double, kParameterCount> d_final{};
+    std::array<double, kParameterCount> d_min{};
+};
+
+// Prognoza + symulacja rdzenia na typie T (double albo Dual); p w kolejności Parameter.
+template <typename T>
+void simulateSols(const ReportOptions& options, const CoreState& initial, size_t heating, size_t science,
+                  const ModeThresholds& thresholds, const std::array<T, kParameterCount>& p,
+                  T& final_soc, T& min_soc, SwitchCounts& switches) {
+    size_t steps = static_cast<size_t>(options.sols * kSolSeconds / options.step_s);
+    double step_ltst_hours = options.step_s / kSolSeconds * 24.0;
+
+    BasicSolarArrayModel<T> model;
+    model.efficiency = p[PANEL_EFFICIENCY];
+    model.optical_depth = p[OPTICAL_DEPTH];
+    std::vector<T> solar(steps);
+    clearSkyPowerSeries(model, options.latitude_deg, marsTimeFromUnix(options.unix_s), options.start_ltst_hours,
+                        step_ltst_hours, steps, solar.data());
+
+    BasicCoreState<T> s = castCoreState<T>(initial);
+    if (heating < s.component_count) {
+        s.components[heating].nominal_power = p[HEATER_POWER];
+    }
+    if (science < s.component_count) {
+        s.components[science].nominal_power = p[SCIENCE_POWER];
+    }
+    s.battery.capacity_wh = p[BATTERY_CAPACITY];
+    s.energy.battery_soc = p[INITIAL_SOC];
+    s.mode.thresholds = thresholds;
+    s.mode.plan_valid = false;
+
+    min_soc = s.energy.battery_soc;
+    switches = SwitchCounts();
+    std::array<ComponentPowerState, kMaxComponents> states;
+    for (size_t k = 0; k < steps; ++k) {
+        for (size_t c = 0; c < s.component_count; ++c) {
+            states[c] = s.components[c].power_state;
+        }
+        double ltst = wrapHours(options.start_ltst_hours + (k + 0.5) * step_ltst_hours);
+        bool driving = ltst >= options.drive_ltst_hours && ltst < options.drive_ltst_hours + 1.0;
+        BasicStepInputs<T> inputs{solar[k] * p[PANEL_DUST_FACTOR], driving ? p[DRIVE_POWER] : T(0.0)};
+        stepCore(s, inputs, options.step_s);
+        min_soc = std::min(min_soc, s.energy.battery_soc);
+        for (size_t c = 0; c < s.component_count; ++c) {
+            switches.power_state += states[c] != s.components[c].power_state;
+        }
+    }
+    switches.mode = s.mode.transitions;
+    final_soc = s.energy.battery_soc;
+}
+
+std::array<double, kParameterCount> nominalParameters(const ReportOptions& options, const CoreState& initial,
+                                                      size_t heating, size_t science) {
+    std::array<double, kParameterCount> p;
+    p[PANEL_EFFICIENCY] = options.efficiency;
+    p[OPTICAL_DEPTH] = options.optical_depth;
+    p[PANEL_DUST_FACTOR] = 1.0;
+    p[HEATER_POWER] = heating < initial.component_count ? initial.components[heating].nominal_power : 0.0;
+    p[SCIENCE_POWER] = science < initial.component_count ? initial.components[science].nominal_power : 0.0;
+    p[BATTERY_CAPACITY] = options.battery_capacity_wh;
+    p[INITIAL_SOC] = options.initial_soc;
+    p[DRIVE_POWER] = options.drive_power_w;
+    return p;
+}
+
+double elasticity(double value, double derivative, double soc) {
+    return std::fabs(soc) > 1e-9 ? value * derivative / soc : 0.0;
+}
+
+}
+
+int main(int argc, char** argv) {
+    ReportOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: %s [--sols S] [--step s] [--latitude deg] [--unix t] [--start-ltst h] "
+                             "[--drive-ltst h] [--opacity tau] [--efficiency e] [--soc %%] [--capacity Wh] "
+                             "[--drive-w W] [--check 0|1]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<PowerComponent> components = defaultComponents();
+    ComponentRegistry registry(components);
+    registry.applyDependencies();
+    CoreState initial{};
+    captureComponents(components, registry.allocationOrder(), initial);
+    initial.energy = {static_cast<float>(options.initial_soc), 28.0f, 0.0f, 0.0f, 0.0f, -20.0f, PowerMode::NORMAL};
+    initial.mode.mode = PowerMode::NORMAL;
+    initial.mode.planned_mode = PowerMode::NORMAL;
+    initial.battery.capacity_wh = static_cast<float>(options.battery_capacity_wh);
+    initial.battery.solar_calibration = 1.0f;
+    CoreMetadata metadata;
+    for (const auto& comp : components) {
+        metadata.names.push_back(comp.name);
+    }
+    size_t heating = metadata.find("heating");
+    size_t science = metadata.find("science_instruments");
+    ModeThresholds thresholds;
+    std::array<double, kParameterCount> nominal = nominalParameters(options, initial, heating, science);
+
+    // Jeden przebieg dualny: wartość + gradient względem wszystkich parametrów ciągłych
+    auto start = std::chrono::steady_clock::now();
+    std::array<Gradient, kParameterCount> dual_p;
+    for (size_t i = 0; i < kParameterCount; ++i) {
+        dual_p[i] = Gradient::variable(nominal[i], i);
+    }
+    Gradient final_soc, min_soc;
+    SwitchCounts switches;
+    simulateSols(options, initial, heating, science, thresholds, dual_p, final_soc, min_soc, switches);
+    double dual_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    Outcome outcome{final_soc.value, min_soc.value, switches, final_soc.d, min_soc.d};
+    bool dual_reliable = switches.mode == 0 && switches.power_state == 0;
+
+    // Różnice centralne: f(p + h) - f(p - h), 2 przebiegi na parametr
+    auto central = [&](const std::array<double, kParameterCount>& p, const ModeThresholds& t,
+                       double& d_final, double& d_min, const auto& perturb, double h) {
+        std::array<double, kParameterCount> p_hi = p, p_lo = p;
+        ModeThresholds t_hi = t, t_lo = t;
+        perturb(p_hi, t_hi, h);
+        perturb(p_lo, t_lo, -h);
+        double final_hi, final_lo, min_hi, min_lo;
+        SwitchCounts ignored;
+        simulateSols(options, initial, heating, science, t_hi, p_hi, final_hi, min_hi, ignored);
+        simulateSols(options, initial, heating, science, t_lo, p_lo, final_lo, min_lo, ignored);
+        d_final = (final_hi - final_lo) / (2.0 * h);
+        d_min = (min_hi - min_lo) / (2.0 * h);
+    };
+
+    std::printf("# final_soc %.4f, min_soc %.4f over %.2f sols\n", outcome.final_soc, outcome.min_soc, options.sols);
+    std::printf("# mode switches %u, power state switches %u%s\n", outcome.switches.mode,
+                outcome.switches.power_state, dual_reliable ? "" : ": dual rows unreliable, use central differences");
+    std::printf("parameter,value,d_final_soc,elasticity_final,d_min_soc,method\n");
+    double fd_s = 0.0;
+    size_t fd_runs = 0;
+    for (size_t i = 0; i < kParameterCount; ++i) {
+        std::printf("%s,%.4g,%.6g,%.4f,%.6g,%s\n", kParameterNames[i], nominal[i], outcome.d_final[i],
+                    elasticity(nominal[i], outcome.d_final[i], outcome.final_soc), outcome.d_min[i],
+                    dual_reliable ? "dual" : "dual_unreliable");
+        if (options.check || !dual_reliable) {
+            double d_final, d_min;
+            double h = std::max(1e-6, std::fabs(nominal[i]) * 1e-4);
+            auto fd_start = std::chrono::steady_clock::now();
+            central(nominal, thresholds, d_final, d_min,
+                    [i](std::array<double, kParameterCount>& p, ModeThresholds&, double dh) { p[i] += dh; }, h);
+            fd_s += std::chrono::duration<double>(std::chrono::steady_clock::now() - fd_start).count();
+            fd_runs += 2;
+            std::printf("%s,%.4g,%.6g,%.4f,%.6g,central_difference\n", kParameterNames[i], nominal[i], d_final,
+                        elasticity(nominal[i], d_final, outcome.final_soc), d_min);
+        }
+    }
+
+    // Progi: skok o 1 jednostkę (10 s dla histerezy); pochodna dualna byłaby tu zerem
+    for (const char* name : kThresholdNames) {
+        double value = *thresholdField(thresholds, name);
+        double h = std::strcmp(name, "mode.min_dwell_s") ? 1.0 : 10.0;
+        double d_final, d_min;
+        central(nominal, thresholds, d_final, d_min,
+                [name](std::array<double, kParameterCount>&, ModeThresholds& t, double dh) {
+                    *thresholdField(t, name) += static_cast<float>(dh);
+                }, h);
+        std::printf("%s,%.4g,%.6g,%.4f,%.6g,central_difference\n", name, value, d_final,
+                    elasticity(value, d_final, outcome.final_soc), d_min);
+    }
+
+    std::fprintf(stderr, "dual pass %.1f ms for %zu parameters", dual_s * 1e3, static_cast<size_t>(kParameterCount));
+    if (fd_runs > 0) {
+        std::fprintf(stderr, ", central differences %.1f ms (%zu runs)", fd_s * 1e3, fd_runs);
+    }
+    std::fprintf(stderr, "\n");
+    return 0;
+}
@@ -0,0 +1,155 @@
+// Sprawdzenie kodeka telemetrii: TelemetryEncoder -> TelemetryDecoder na syntetycznym
+// przebiegu z NaN w polach, odchyłkami czasu (jitter, przerwa, skok poza int32 ms)
+// i podziałem na ramki (pełna ramka, zbyt duża odchyłka). Każda zdekodowana wartość
+// musi być w pół kwantu od zapisanej; uszkodzony bajt ładunku musi odrzucić ramkę.
+// Kod wyjścia 0 = zgodne, 1 = rozbieżności.
+//
+//   g++ -O2 -std=c++17 -I.. telemetry_roundtrip.cpp -o telemetry_roundtrip
+//   ./telemetry_roundtrip [samples]
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "default_components.hpp"
+#include "telemetry_codec.hpp"
+
+using namespace rover_energy;
+
+namespace {
+
+struct Recorded {
+    uint64_t time_ms;
+    EnergyState state;
+    std::vector<float> grants;
+    uint32_t enable_mask;
+    bool transition;
+};
+
+bool sameQuantized(float decoded, float original, float scale) {
+    if (std::isnan(original)) {
+        return std::isnan(decoded);
+    }
+    return std::fabs(decoded - original) <= 0.51f / scale;
+}
+
+// Porównanie ramki z zapisanymi próbkami; zwraca liczbę rozbieżnych próbek.
+size_t checkFrame(const std::vector<uint8_t>& frame, const std::vector<Recorded>& expected) {
+    TelemetryDecoder decoder;
+    TelemetryColumns columns;
+    if (!decoder.decode(frame.data(), frame.size(), columns) || columns.time_ms.size() != expected.size()) {
+        std::fprintf(stderr, "frame of %zu samples failed to decode\n", expected.size());
+        return expected.size();
+    }
+    size_t mismatched = 0;
+    for (size_t s = 0; s < expected.size(); ++s) {
+        const Recorded& r = expected[s];
+        float values[kTelemetryStateFields] = {
+            r.state.battery_soc, r.state.voltage, r.state.current,
+            r.state.power_consumption, r.state.solar_generation, r.state.temperature};
+        bool same = columns.time_ms[s] == r.time_ms &&
+                    columns.mode[s] == static_cast<uint8_t>(r.state.mode) &&
+                    (columns.transition[s] != 0) == r.transition &&
+                    columns.enable_mask[s] == r.enable_mask;
+        for (size_t f = 0; f < kTelemetryStateFields; ++f) {
+            same = same && sameQuantized(columns.state[f][s], values[f], kTelemetryStateScale[f]);
+        }
+        for (size_t c = 0; c < r.grants.size(); ++c) {
+            same = same && sameQuantized(columns.grants[c][s], r.grants[c], kTelemetryGrantScale);
+        }
+        if (!same) {
+            if (mismatched == 0) {
+                std::fprintf(stderr, "sample at %llu ms differs\n", static_cast<unsigned long long>(r.time_ms));
+            }
+            ++mismatched;
+        }
+    }
+    return mismatched;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t samples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    const uint16_t tick_ms = 1000;
+
+    std::vector<PowerComponent> components = defaultComponents();
+    TelemetryEncoder encoder(tick_ms);
+    std::vector<Recorded> pending;
+    std::vector<uint8_t> frame;
+    std::vector<uint8_t> first_frame;
+    size_t frames = 0;
+    size_t mismatched = 0;
+
+    uint64_t time_ms = 1760000000000ull;
+    PowerMode previous_mode = PowerMode::NORMAL;
+    for (size_t i = 0; i < samples; ++i) {
+        time_ms += tick_ms;
+        if (i % 17 == 0) {
+            time_ms += static_cast<int64_t>(i % 5) * 13 - 26;      // jitter w obie strony
+        }
+        if (i == samples / 3) {
+            time_ms += 3ull * 3600 * 1000;                            // przerwa w odchyłce
+        }
+        if (i == samples / 2) {
+            time_ms += 30ull * 24 * 3600 * 1000;                      // poza int32 ms: nowa ramka
+        }
+
+        EnergyState state;
+        state.battery_soc = 60.0f + 30.0f * std::sin(static_cast<float>(i) * 0.01f);
+        state.voltage = 28.0f + 0.002f * static_cast<float>(i % 300);
+        state.current = -3.0f + 0.37f * static_cast<float>(i % 19);
+        state.power_consumption = 80.0f + 5.0f * std::cos(static_cast<float>(i) * 0.1f);
+        state.solar_generation = i % 400 < 200 ? 0.0f : 120.0f * std::sin(static_cast<float>(i % 200) * 0.0157f);
+        state.temperature = i % 50 >= 10 && i % 50 < 13 ? NAN : -40.0f + 0.05f * static_cast<float>(i % 800);
+        state.mode = static_cast<PowerMode>((i / 150) % kPowerModeCount);
+
+        uint32_t enable_mask = 0;
+        std::vector<float> grants(components.size());
+        for (size_t c = 0; c < components.size(); ++c) {
+            PowerComponent& comp = components[c];
+            comp.is_enabled = (i / 90 + c) % 4 != 0;
+            comp.current_power = !comp.is_enabled ? 0.0f
+                : (i + c) % 97 == 0 ? NAN : comp.nominal_power * (0.5f + 0.5f * std::sin(static_cast<float>(i + c)));
+            grants[c] = comp.current_power;
+            enable_mask |= comp.is_enabled ? 1u << c : 0u;
+        }
+
+        Recorded record{time_ms, state, grants, enable_mask, i > 0 && state.mode != previous_mode};
+        previous_mode = state.mode;
+        if (!encoder.append(state, components, time_ms)) {
+            encoder.finish(frame);
+            mismatched += checkFrame(frame, pending);
+            if (frames++ == 0) {
+                first_frame = frame;
+            }
+            pending.clear();
+            if (!encoder.append(state, components, time_ms)) {
+                std::fprintf(stderr, "append into an empty frame failed at sample %zu\n", i);
+                return 1;
+            }
+        }
+        pending.push_back(record);
+    }
+    if (!encoder.empty()) {
+        encoder.finish(frame);
+        mismatched += checkFrame(frame, pending);
+        if (frames++ == 0) {
+            first_frame = frame;
+        }
+    }
+
+    bool corrupt_rejected = true;
+    if (first_frame.size() > kTelemetryHeaderBytes) {
+        first_frame[kTelemetryHeaderBytes + (first_frame.size() - kTelemetryHeaderBytes) / 2] ^= 0x10;
+        TelemetryDecoder decoder;
+        TelemetryColumns columns;
+        corrupt_rejected = !decoder.decode(first_frame.data(), first_frame.size(), columns);
+    }
+
+    std::printf("samples %zu  frames %zu  mismatched %zu  corrupted frame %s\n", samples, frames, mismatched,
+                corrupt_rejected ? "rejected" : "ACCEPTED");
+    return mismatched == 0 && corrupt_rejected ? 0 : 1;
+}
@@ -0,0 +1,273 @@
+#ifndef WHAT_IF_HPP
+#define WHAT_IF_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "budget_curve.hpp"
+#include "energy_core.hpp"
+#include "mars_time.hpp"
+#include "thread_pool.hpp"
+
+namespace rover_energy {
+
+struct WhatIfConfig {
+    float step_s = 10.0f;
+    float drive_speed_mps = 0.05f;
+    float drive_power_w = 40.0f;        // pobór jazdy ponad spoczynkowy pobór silników
+    float max_horizon_hours = 50.0f;    // [h ziemskie]
+    std::chrono::milliseconds deadline{200};
+};
+
+// component == SIZE_MAX to jazda: value = dystans [m].
+struct Activity {
+    size_t component;
+    double start_s;
+    double end_s;
+    float value;
+};
+
+struct WhatIfCandidate {
+    std::vector<Activity> activities;
+};
+
+struct WhatIfResult {
+    float soc_at_sunrise = NAN;     // SOC o pierwszym wschodzie po ostatniej aktywności
+    float min_soc = NAN;
+    float min_soc_hours = 0.0f;     // czas minimum od teraz [h]
+    float emergency_hours = 0.0f;
+    float shed_hours = 0.0f;        // czas, w którym tryb nie pozwolił wykonać aktywności
+    uint32_t transitions = 0;
+    bool complete = false;          // false = przekroczony termin
+};
+
+// Wejście wspólne dla wszystkich kandydatów zapytania.
+struct WhatIfContext {
+    const Checkpoint* origin;
+    const float* solar_w;           // prognoza na krok, co najmniej horizonSteps()
+    double start_ltst_hours;
+    double sunrise_ltst_hours;
+};
+
+inline double secondsUntilLtst(double from_ltst_hours, double target_ltst_hours) {
+    return wrapHours(target_ltst_hours - from_ltst_hours) * kMarsHourHours * 3600.0;
+}
+
+// Każdy kandydat startuje z rozwidlenia tego samego punktu kontrolnego i idzie
+// stepCore() (ten sam model co węzeł) aż do wschodu po ostatniej aktywności.
+// Kandydaci liczą się równolegle; wspólny termin przerywa tych, którzy nie zdążyli.
+class WhatIfEvaluator {
+public:
+    WhatIfEvaluator(const WhatIfConfig& config, ThreadPool& pool)
+        : config_(config), pool_(pool) {}
+
+    const WhatIfConfig& config() const { return config_; }
+
+    size_t horizonSteps() const {
+        return static_cast<size_t>(config_.max_horizon_hours * 3600.0f / config_.step_s);
+    }
+
+    // Sekwencja: "komponent@start[/godziny][*wypełnienie]" rozdzielone ';'. start to "now"
+    // albo LTST "hh[:mm]"; godziny marsjańskie (domyślnie 1), przyrostki w dowolnej kolejności.
+    // "drive@start*metry" to jazda (dystans obowiązkowy, bez godzin).
+    bool parse(const std::string& text, const CoreMetadata& metadata, double start_ltst_hours,
+               WhatIfCandidate& candidate, std::string& error) const {
+        candidate.activities.clear();
+        size_t begin = 0;
+        while (begin < text.size()) {
+            size_t end = text.find(';', begin);
+            if (end == std::string::npos) {
+                end = text.size();
+            }
+            std::string item = text.substr(begin, end - begin);
+            begin = end + 1;
+            if (item.empty()) {
+                continue;
+            }
+            Activity activity;
+            if (!parseActivity(item, metadata, start_ltst_hours, activity, error)) {
+                return false;
+            }
+            candidate.activities.push_back(activity);
+        }
+        if (candidate.activities.empty()) {
+            error = "empty activity sequence";
+            return false;
+        }
+        return true;
+    }
+
+    const std::vector<WhatIfResult>& evaluate(const WhatIfContext& context,
+                                              const std::vector<WhatIfCandidate>& candidates) {
+        results_.assign(candidates.size(), WhatIfResult());
+        deadline_ = std::chrono::steady_clock::now() + config_.deadline;
+        expired_.store(false);
+        pool_.parallelFor(candidates.size(), [this, &context, &candidates](size_t i) {
+            results_[i] = simulate(context, candidates[i]);
+        });
+        return results_;
+    }
+
+private:
+    bool parseActivity(const std::string& item, const CoreMetadata& metadata, double start_ltst_hours,
+                       Activity& activity, std::string& error) const {
+        size_t at = item.find('@');
+        if (at == std::string::npos) {
+            error = "missing '@' in '" + item + "'";
+            return false;
+        }
+        std::string name = item.substr(0, at);
+        std::string timing = item.substr(at + 1);
+
+        // Przyrostki "/godziny" i "*wypełnienie" w dowolnej kolejności, każdy najwyżej raz.
+        size_t suffix = timing.find_first_of("/*");
+        std::string start = timing.substr(0, suffix);
+        double value = 1.0;
+        double duration_hours = 1.0;
+        bool has_value = false;
+        bool has_duration = false;
+        while (suffix != std::string::npos) {
+            char kind = timing[suffix];
+            size_t next = timing.find_first_of("/*", suffix + 1);
+            std::string field = timing.substr(suffix + 1, next == std::string::npos ? next : next - suffix - 1);
+            bool& seen = kind == '*' ? has_value : has_duration;
+            if (seen || !parseNumber(field, kind == '*' ? value : duration_hours)) {
+                error = std::string("bad '") + kind + "' field in '" + item + "'";
+                return false;
+            }
+            seen = true;
+            suffix = next;
+        }
+
+        if (start == "now") {
+            activity.start_s = 0.0;
+        } else {
+            size_t colon = start.find(':');
+            double hours = 0.0;
+            double minutes = 0.0;
+            bool valid = parseNumber(start.substr(0, colon), hours) && hours >= 0.0 && hours < 24.0;
+            if (valid && colon != std::string::npos) {
+                valid = parseNumber(start.substr(colon + 1), minutes) && minutes >= 0.0 && minutes < 60.0;
+            }
+            if (!valid) {
+                error = "bad start '" + start + "'";
+                return false;
+            }
+            activity.start_s = secondsUntilLtst(start_ltst_hours, hours + minutes / 60.0);
+        }
+
+        if (name == "drive") {
+            if (!has_value || !(value > 0.0) || has_duration) {
+                error = "drive needs a distance and no duration in '" + item + "'";
+                return false;
+            }
+            activity.component = SIZE_MAX;
+            activity.value = static_cast<float>(value);
+            activity.end_s = activity.start_s + value / config_.drive_speed_mps;
+            return true;
+        }
+        activity.component = metadata.find(name);
+        if (activity.component == SIZE_MAX) {
+            error = "unknown component '" + name + "'";
+            return false;
+        }
+        if (!(duration_hours > 0.0) || !(value >= 0.0 && value <= 1.0)) {
+            error = "bad duration or duty in '" + item + "'";
+            return false;
+        }
+        activity.value = static_cast<float>(value);
+        activity.end_s = activity.start_s + duration_hours * kMarsHourHours * 3600.0;
+        return true;
+    }
+
+    // Skończona liczba zajmująca całe pole ("", "2x" i "nan" są błędne).
+    static bool parseNumber(const std::string& field, double& out) {
+        char* rest = nullptr;
+        out = std::strtod(field.c_str(), &rest);
+        return !field.empty() && rest == field.c_str() + field.size() && std::isfinite(out);
+    }
+
+    WhatIfResult simulate(const WhatIfContext& context, const WhatIfCandidate& candidate) {
+        WhatIfResult result;
+        Checkpoint branch = context.origin->fork();
+        CoreState& s = branch.state;
+        std::array<CoreComponent, kMaxComponents> baseline = s.components;
+
+        double last_end = 0.0;
+        for (const auto& activity : candidate.activities) {
+            last_end = std::max(last_end, activity.end_s);
+        }
+        double end_ltst = wrapHours(context.start_ltst_hours + last_end / 3600.0 / kMarsHourHours);
+        double horizon_s = std::min<double>(last_end + secondsUntilLtst(end_ltst, context.sunrise_ltst_hours),
+                                            horizonSteps() * config_.step_s);
+        size_t steps = static_cast<size_t>(std::ceil(horizon_s / config_.step_s));
+
+        float dt = config_.step_s;
+        float hours_per_step = dt / 3600.0f;
+        result.min_soc = s.energy.battery_soc;
+        for (size_t k = 0; k < steps; ++k) {
+            if ((k & 255) == 255 && (expired_.load(std::memory_order_relaxed) ||
+                                     std::chrono::steady_clock::now() >= deadline_)) {
+                expired_.store(true, std::memory_order_relaxed);
+                return result;
+            }
+            double t = k * static_cast<double>(dt);
+            StepInputs inputs{context.solar_w[k], 0.0f};
+            bool requests_changed = false;
+            for (const auto& activity : candidate.activities) {
+                bool running = t >= activity.start_s && t < activity.end_s;
+                if (activity.component == SIZE_MAX) {
+                    inputs.extra_load_w += running ? config_.drive_power_w : 0.0f;
+                    continue;
+                }
+                CoreComponent& comp = s.components[activity.component];
+                if (running) {
+                    bool allowed = s.mode_masks.allows(s.mode.mode, activity.component);
+                    requests_changed |= comp.mode_enabled != allowed;
+                    comp.mode_enabled = allowed;
+                    comp.duty_cycle = activity.value;
+                    result.shed_hours += allowed ? 0.0f : hours_per_step;
+                } else if (t >= activity.end_s && t < activity.end_s + dt) {
+                    bool restored = baseline[activity.component].mode_enabled &&
+                                    s.mode_masks.allows(s.mode.mode, activity.component);
+                    requests_changed |= comp.mode_enabled != restored;
+                    comp.mode_enabled = restored;
+                    comp.duty_cycle = baseline[activity.component].duty_cycle;
+                }
+            }
+            // Aktywność to żądanie; włączenie efektywne nadal zależy od zależności
+            if (requests_changed) {
+                applyDependencyMasks(s.components.data(), s.component_count);
+            }
+
+            stepCore(s, inputs, dt);
+            if (s.energy.battery_soc < result.min_soc) {
+                result.min_soc = s.energy.battery_soc;
+                result.min_soc_hours = static_cast<float>((k + 1) * hours_per_step);
+            }
+            if (s.mode.mode == PowerMode::EMERGENCY) {
+                result.emergency_hours += hours_per_step;
+            }
+        }
+        result.soc_at_sunrise = s.energy.battery_soc;
+        result.transitions = s.mode.transitions;
+        result.complete = true;
+        return result;
+    }
+
+    WhatIfConfig config_;
+    ThreadPool& pool_;
+    std::vector<WhatIfResult> results_;
+    std::chrono::steady_clock::time_point deadline_;
+    std::atomic<bool> expired_{false};
+};
+
+}
+
+#endif // WHAT_IF_HPP